@@ -9,6 +9,7 @@
 #include "editor/Editor.h"
 #include "engine/RuntimeMode.h"
 #include "engine/Transform.h"
+#include "core/JobManager.h"
 #include "AL/al.h"
 #include "AL/alc.h"
 
@@ -23,6 +24,8 @@ namespace tri {
 		}
 
         env->runtimeMode->setActiveSystem<AudioSystem>({ RuntimeMode::EDIT, RuntimeMode::PAUSED, RuntimeMode::LOADING }, true);
+        //opening the audio device can take a while and does not depend on other systems, the context is not bound to a thread
+        env->jobManager->setConcurrentStartup<AudioSystem>();
 	}
 
 	void AudioSystem::startup() {
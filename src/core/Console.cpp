@@ -6,6 +6,8 @@
 #include "config.h"
 #include "Environment.h"
 #include "Profiler.h"
+#include "ThreadManager.h"
+#include "util/Clock.h"
 
 namespace tri {
 
@@ -32,6 +34,48 @@ namespace tri {
 		}
 	}
 
+	static std::vector<std::string>& getSourceNames() {
+		static std::vector<std::string> names;
+		return names;
+	}
+	static std::mutex sourceMutex;
+
+	void Console::startup() {
+		queue.resize(logQueueSize);
+		writerRunning = true;
+		writerFinished = false;
+		writerThreadId = env->threadManager->addThread("Log Writer", [this]() {
+			while (writerRunning) {
+				writeQueuedRecords();
+				std::unique_lock<std::mutex> lock(wakeMutex);
+				wakeCondition.wait_for(lock, std::chrono::milliseconds(5));
+			}
+			writerFinished = true;
+		});
+		queueOpen = true;
+	}
+
+	void Console::shutdown() {
+		queueOpen = false;
+		//a producer that saw the open queue finishes its push while the writer still makes space
+		while (activeProducers > 0) {
+			wakeCondition.notify_one();
+			std::this_thread::yield();
+		}
+		writerRunning = false;
+		wakeCondition.notify_one();
+		if (writerThreadId != -1) {
+			env->threadManager->joinThread(writerThreadId);
+			env->threadManager->terminateThread(writerThreadId);
+			writerThreadId = -1;
+		}
+		while (!writerFinished) {
+			std::this_thread::yield();
+		}
+		//messages logged after this point are written synchronously
+		writeQueuedRecords();
+	}
+
 	void Console::logMsg(const std::string& msg, LogLevel level, const std::string& source) {
 		if (this == nullptr) {
 			return;
@@ -39,26 +83,149 @@ namespace tri {
 
 		TRI_PROFILE_FUNC();
 
-		static std::mutex mutex;
-		std::unique_lock<std::mutex> lock(mutex);
+		LogRecord record;
+		record.msg = msg;
+		record.level = level;
+		record.sourceId = getSourceId(source);
+		record.timeNano = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::system_clock::now().time_since_epoch()).count();
 
-		char date[32] = "";
-		char time[32] = "";
-		auto now = std::chrono::system_clock::now().time_since_epoch();
-		auto sec = std::chrono::duration_cast<std::chrono::seconds>(now);
-		auto msec = std::chrono::duration_cast<std::chrono::milliseconds>(now - sec).count();
+		activeProducers++;
+		if (queueOpen) {
+			if (!queue.push(record)) {
+				if (level < LogLevel::WARNING) {
+					droppedCount++;
+					activeProducers--;
+					return;
+				}
+				//warnings and errors are never dropped, wait for the writer to make space
+				while (!queue.push(record)) {
+					wakeCondition.notify_one();
+					std::this_thread::yield();
+				}
+			}
+			pushedCount++;
+			activeProducers--;
+			if (level >= LogLevel::FATAL) {
+				flush();
+			}
+		}
+		else {
+			activeProducers--;
+			std::unique_lock<std::mutex> lock(writerMutex);
+			writeRecord(record);
+			flushTargets();
+		}
+	}
+
+	void Console::flush() {
+		if (this == nullptr) {
+			return;
+		}
+		if (writerRunning) {
+			uint64_t target = pushedCount;
+			Clock clock;
+			while (writtenCount < target && clock.elapsed() < 1.0) {
+				wakeCondition.notify_one();
+				std::this_thread::yield();
+			}
+			if (writtenCount >= target) {
+				return;
+			}
+		}
+		//the writer thread is not running or not responding (e.g. when crashing on the writer thread)
+		writeQueuedRecords(false);
+	}
 
-		time_t timeVal = sec.count();
-		struct tm timeInfo;
+	uint64_t Console::getDroppedMessageCount() {
+		return droppedCount;
+	}
+
+	int Console::getSourceId(const std::string& source) {
+		static thread_local std::unordered_map<std::string, int> cache;
+		auto entry = cache.find(source);
+		if (entry != cache.end()) {
+			return entry->second;
+		}
+
+		std::unique_lock<std::mutex> lock(sourceMutex);
+		auto& names = getSourceNames();
+		int id = -1;
+		for (int i = 0; i < names.size(); i++) {
+			if (names[i] == source) {
+				id = i;
+				break;
+			}
+		}
+		if (id == -1) {
+			id = (int)names.size();
+			names.push_back(source);
+		}
+		cache[source] = id;
+		return id;
+	}
+
+	void Console::writeQueuedRecords(bool wait) {
+		std::unique_lock<std::mutex> lock(writerMutex, std::defer_lock);
+		if (wait) {
+			lock.lock();
+		}
+		else if (!lock.try_lock()) {
+			return;
+		}
+
+		LogRecord record;
+		int count = 0;
+		while (queue.pop(record)) {
+			writeRecord(record);
+			count++;
+		}
+
+		uint64_t dropped = droppedCount;
+		if (dropped != reportedDroppedCount) {
+			LogRecord info;
+			info.msg = format("%i log messages dropped", (int)(dropped - reportedDroppedCount));
+			info.level = LogLevel::WARNING;
+			info.sourceId = getSourceId("System");
+			info.timeNano = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::system_clock::now().time_since_epoch()).count();
+			writeRecord(info);
+			reportedDroppedCount = dropped;
+		}
+
+		if (count > 0) {
+			flushTargets();
+			writtenCount += count;
+		}
+	}
+
+	void Console::writeRecord(const LogRecord& record) {
+		//date and time strings are only recreated once per second
+		uint64_t second = record.timeNano / 1000000000ull;
+		if (second != cachedSecond) {
+			cachedSecond = second;
+			time_t timeVal = (time_t)second;
+			struct tm timeInfo;
 #if TRI_WINDOWS
-		localtime_s(&timeInfo, &timeVal);
+			localtime_s(&timeInfo, &timeVal);
 #else
-		timeInfo = *localtime(&timeVal);
+			localtime_r(&timeVal, &timeInfo);
 #endif
-		int pos = (int)strftime(time, 32, "%H:%M:%S", &timeInfo);
-		snprintf(time + pos, 32 - pos, ".%03d", (int)msec);
-		strftime(date, 32, "%d.%m.%Y", &timeInfo);
+			strftime(cachedTime, 32, "%H:%M:%S", &timeInfo);
+			strftime(cachedDate, 32, "%d.%m.%Y", &timeInfo);
+		}
+		char time[32] = "";
+		snprintf(time, 32, "%s.%03d", cachedTime, (int)((record.timeNano / 1000000ull) % 1000ull));
+		const char* date = cachedDate;
+
+		std::string source;
+		{
+			std::unique_lock<std::mutex> lock(sourceMutex);
+			if (record.sourceId >= 0 && record.sourceId < getSourceNames().size()) {
+				source = getSourceNames()[record.sourceId];
+			}
+		}
 
+		LogLevel level = record.level;
+		const std::string& msg = record.msg;
 		for (auto& target : targets) {
 			if (target) {
 				if (level >= target->level) {
@@ -79,7 +246,7 @@ namespace tri {
 							if (target->includeLevel) {
 								(*target->stream) << "[" << getLevelName(level) << "] ";
 							}
-							(*target->stream) << msg.c_str() << std::endl;
+							(*target->stream) << msg.c_str() << "\n";
 						}
 					}
 				}
@@ -87,7 +254,16 @@ namespace tri {
 		}
 	}
 
+	void Console::flushTargets() {
+		for (auto& target : targets) {
+			if (target && target->stream) {
+				target->stream->flush();
+			}
+		}
+	}
+
 	void Console::addLogTarget(LogTarget target) {
+		std::unique_lock<std::mutex> lock(writerMutex);
 		if (!target.file.empty()) {
 			target.stream = new std::ofstream(target.file);
 		}
@@ -95,6 +271,7 @@ namespace tri {
 	}
 
 	void Console::removeLogTarget(const std::string& file) {
+		std::unique_lock<std::mutex> lock(writerMutex);
 		for (int i = 0; i < targets.size(); i++) {
 			if (targets[i]->file == file) {
 				targets.erase(targets.begin() + i);
@@ -8,6 +8,7 @@
 #include "Reflection.h"
 #include "Environment.h"
 #include "util/StrUtil.h"
+#include "util/MpscQueue.h"
 #include <stdarg.h>
 
 namespace tri {
@@ -104,14 +105,24 @@ namespace tri {
 			bool includeLevel = true;
 
 			std::string file = "";
+			//invoked on the log writer thread, or on the logging thread while the writer is not running
 			std::function<void(const std::string& msg, LogLevel level, const std::string& time, const std::string& date, const std::string& source)> callback = nullptr;
 			std::ostream* stream = nullptr;
 		};
 		
+		//number of messages that can be queued for the log thread, when the queue is full messages below warning level are dropped
+		int logQueueSize = 1 << 14;
+
+		void startup() override;
+		void shutdown() override;
+
 		void logMsg(const std::string& msg, LogLevel level = LogLevel::INFO, const std::string& source = "System");
 		void addLogTarget(LogTarget target);
 		void removeLogTarget(const std::string &file);
 		const char* getLevelName(LogLevel level);
+		//blocks until all queued messages are written
+		void flush();
+		uint64_t getDroppedMessageCount();
 
 		template<typename... Args>
 		std::string format(const char* fmt, Args... args) {
@@ -244,6 +255,37 @@ namespace tri {
 		std::string autoComplete(const std::string& command, bool printOptions = true);
 
 	private:
+		class LogRecord {
+		public:
+			std::string msg;
+			LogLevel level;
+			int sourceId;
+			uint64_t timeNano;
+		};
+
+		MpscQueue<LogRecord> queue;
+		std::atomic<bool> writerRunning = false;
+		std::atomic<bool> writerFinished = true;
+		//producers only push while the queue is open, shutdown waits for the active producers before the final drain
+		std::atomic<bool> queueOpen = false;
+		std::atomic<int> activeProducers = 0;
+		std::atomic<uint64_t> pushedCount = 0;
+		std::atomic<uint64_t> writtenCount = 0;
+		std::atomic<uint64_t> droppedCount = 0;
+		uint64_t reportedDroppedCount = 0;
+		int writerThreadId = -1;
+		std::mutex writerMutex;
+		std::mutex wakeMutex;
+		std::condition_variable wakeCondition;
+		uint64_t cachedSecond = -1;
+		char cachedDate[32] = "";
+		char cachedTime[32] = "";
+
+		int getSourceId(const std::string& source);
+		void writeQueuedRecords(bool wait = true);
+		void writeRecord(const LogRecord& record);
+		void flushTargets();
+
 		class Command {
 		public:
 			std::string name;
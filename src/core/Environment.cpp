@@ -17,6 +17,9 @@ namespace tri {
 		threadManager = nullptr;
 		fileWatcher = nullptr;
 		profiler = nullptr;
+		frameAllocator = nullptr;
+		memoryTracker = nullptr;
+		workScheduler = nullptr;
 		config = nullptr;
 		window = nullptr;
 		viewport = nullptr;
@@ -27,6 +30,7 @@ namespace tri {
 		assetManager = nullptr;
 		serializer = nullptr;
 		runtimeMode = nullptr;
+		spatialIndex = nullptr;
 		world = nullptr;
 		editor = nullptr;
 		renderPipeline = nullptr;
@@ -23,6 +23,9 @@ namespace tri {
 		class ThreadManager* threadManager;
 		class FileWatcher *fileWatcher;
 		class Profiler* profiler;
+		class FrameAllocator* frameAllocator;
+		class MemoryTracker* memoryTracker;
+		class WorkScheduler* workScheduler;
 		class Config* config;
 		
 		//window
@@ -37,6 +40,7 @@ namespace tri {
 		class AssetManager* assetManager;
 		class Serializer* serializer;
 		class RuntimeMode* runtimeMode;
+		class SpatialIndex* spatialIndex;
 
 		//entity
 		class World* world;
@@ -15,12 +15,35 @@ namespace tri {
 		return events;
 	}
 
+	//events with deferred invocations
+	static std::vector<EventBase*> &deferredEvents() {
+		static std::vector<EventBase*> events;
+		return events;
+	}
+
+	static std::mutex &deferredEventsMutex() {
+		static std::mutex mutex;
+		return mutex;
+	}
+
 
 	EventBase::EventBase() {
+		//constructed before the first event, so that they are destroyed after the last one
+		deferredEvents();
+		deferredEventsMutex();
 		allEvents().push_back(this);
 	}
 
 	EventBase::~EventBase() {
+		{
+			std::unique_lock<std::mutex> lock(deferredEventsMutex());
+			for (int i = 0; i < deferredEvents().size(); i++) {
+				if (deferredEvents()[i] == this) {
+					deferredEvents().erase(deferredEvents().begin() + i);
+					break;
+				}
+			}
+		}
 		for (int i = 0; i < allEvents().size(); i++) {
 			if (allEvents()[i] == this) {
 				allEvents().erase(allEvents().begin() + i);
@@ -31,12 +54,30 @@ namespace tri {
 
 	void EventBase::removeModuleListeners(const std::string& file) {}
 
+	void EventBase::dispatchDeferred() {}
+
+	void EventBase::queueDeferred() {
+		std::unique_lock<std::mutex> lock(deferredEventsMutex());
+		deferredEvents().push_back(this);
+	}
+
 	void EventManager::removeModuleListeners(const std::string& file) {
 		for (auto* e : allEvents()) {
 			e->removeModuleListeners(file);
 		}
 	}
 
+	void EventManager::dispatchDeferred() {
+		std::vector<EventBase*> events;
+		{
+			std::unique_lock<std::mutex> lock(deferredEventsMutex());
+			events.swap(deferredEvents());
+		}
+		for (auto* e : events) {
+			e->dispatchDeferred();
+		}
+	}
+
 }
 
 
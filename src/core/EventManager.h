@@ -10,6 +10,9 @@
 #include "Reflection.h"
 #include "ModuleManager.h"
 #include "Console.h"
+#include "util/InlineFunction.h"
+#include <atomic>
+#include <tuple>
 
 namespace tri {
 
@@ -18,45 +21,111 @@ namespace tri {
 		EventBase();
 		virtual ~EventBase();
 		virtual void removeModuleListeners(const std::string &file);
+		virtual void dispatchDeferred();
+
+	protected:
+		//the event is dispatched with the next EventManager::dispatchDeferred
+		void queueDeferred();
 	};
 
+	//listeners are stored in immutable arrays that are replaced on every change (copy on write)
+	//invoke only reads the current array, so events can be invoked from any thread while listeners are added or removed
+	//replaced arrays are freed once no invoke is running anymore
 	template<typename... Args>
 	class Event : public EventBase {
 	public:
+		typedef InlineFunction<void(Args...)> Callback;
+
+		Event() {}
+		Event(const Event&) = delete;
+
+		~Event() {
+			delete current.load();
+			for (auto* list : retired) {
+				delete list;
+			}
+		}
+
 		void invoke(Args... args) {
-			for (int i = 0; i < listeners.size(); i++) {
-				auto& listener = listeners[i];
-				if (listener.callback) {
-					listener.callback(args...);
+			readers.fetch_add(1);
+			if (ListenerList* list = current.load()) {
+				for (auto& listener : list->listeners) {
+					if (listener->callback) {
+						listener->callback(args...);
+					}
 				}
 			}
-			for (int i = 0; i < invokeOnceListeners.size(); i++) {
-				auto& listener = invokeOnceListeners[i];
-				if (listener.callback) {
-					listener.callback(args...);
+			readers.fetch_sub(1);
+
+			if (hasInvokeOnceListeners.load()) {
+				std::vector<std::shared_ptr<Listener>> once;
+				{
+					std::unique_lock<std::mutex> lock(writeMutex);
+					once.swap(invokeOnceListeners);
+					hasInvokeOnceListeners = false;
+				}
+				//listeners added while invoking are invoked on the next invoke
+				for (auto& listener : once) {
+					if (listener->callback) {
+						listener->callback(args...);
+					}
+				}
+			}
+
+			if (hasRetired.load()) {
+				//an invoke on this thread might be running further up the stack, then readers is not zero
+				if (writeMutex.try_lock()) {
+					freeRetired();
+					writeMutex.unlock();
 				}
 			}
-			invokeOnceListeners.clear();
 		}
 
-		int addListener(const std::function<void(Args...)> &callback, bool invokeOnlyOnce = false) {
-			Listener listener;
-			listener.callback = callback;
-			listener.id = nextId++;
+		//the listeners are invoked on the main thread before the next tick with a copy of the arguments
+		void invokeDeferred(Args... args) {
+			std::unique_lock<std::mutex> lock(deferredMutex);
+			deferredCalls.emplace_back(args...);
+			if (!deferredQueued) {
+				deferredQueued = true;
+				queueDeferred();
+			}
+		}
+
+		template<typename Func>
+		int addListener(Func&& callback, bool invokeOnlyOnce = false) {
+			auto listener = std::make_shared<Listener>();
+			listener->callback = Callback(std::forward<Func>(callback));
+			std::unique_lock<std::mutex> lock(writeMutex);
+			listener->id = nextId++;
 			if (invokeOnlyOnce) {
 				invokeOnceListeners.push_back(listener);
+				hasInvokeOnceListeners = true;
 			}
 			else {
-				listeners.push_back(listener);
+				ListenerList* list = copyList();
+				list->listeners.push_back(listener);
+				publish(list);
 			}
-			return listener.id;
+			return listener->id;
 		}
 
 		void removeListener(int id) {
-			for (int i = 0; i < listeners.size(); i++) {
-				if (listeners[i].id == id) {
-					listeners.erase(listeners.begin() + i);
-					break;
+			std::unique_lock<std::mutex> lock(writeMutex);
+			if (ListenerList* list = current.load()) {
+				for (int i = 0; i < list->listeners.size(); i++) {
+					if (list->listeners[i]->id == id) {
+						ListenerList* copy = copyList();
+						copy->listeners.erase(copy->listeners.begin() + i);
+						publish(copy);
+						return;
+					}
+				}
+			}
+			for (int i = 0; i < invokeOnceListeners.size(); i++) {
+				if (invokeOnceListeners[i]->id == id) {
+					invokeOnceListeners.erase(invokeOnceListeners.begin() + i);
+					hasInvokeOnceListeners = !invokeOnceListeners.empty();
+					return;
 				}
 			}
 		}
@@ -64,32 +133,92 @@ namespace tri {
 	private:
 		class Listener {
 		public:
-			std::function<void(Args...)> callback;
+			Callback callback;
 			int id;
 		};
+		class ListenerList {
+		public:
+			std::vector<std::shared_ptr<Listener>> listeners;
+		};
+
+		std::atomic<ListenerList*> current = nullptr;
+		std::atomic<int> readers = 0;
+		std::vector<ListenerList*> retired;
+		std::atomic<bool> hasRetired = false;
+		std::vector<std::shared_ptr<Listener>> invokeOnceListeners;
+		std::atomic<bool> hasInvokeOnceListeners = false;
+		std::mutex writeMutex;
 		int nextId = 0;
-		std::vector<Listener> listeners;
-		std::vector<Listener> invokeOnceListeners;
+
+		std::vector<std::tuple<std::decay_t<Args>...>> deferredCalls;
+		bool deferredQueued = false;
+		std::mutex deferredMutex;
+
+		//the following functions are called with the write mutex locked
+		ListenerList* copyList() {
+			ListenerList* list = new ListenerList();
+			if (ListenerList* old = current.load()) {
+				list->listeners = old->listeners;
+			}
+			return list;
+		}
+
+		void publish(ListenerList* list) {
+			if (ListenerList* old = current.exchange(list)) {
+				retired.push_back(old);
+				hasRetired = true;
+			}
+			freeRetired();
+		}
+
+		void freeRetired() {
+			//an invoke that started before the arrays were retired increments readers before loading the array
+			if (!retired.empty() && readers.load() == 0) {
+				for (auto* list : retired) {
+					delete list;
+				}
+				retired.clear();
+				hasRetired = false;
+			}
+		}
+
+		void dispatchDeferred() override {
+			std::vector<std::tuple<std::decay_t<Args>...>> calls;
+			{
+				std::unique_lock<std::mutex> lock(deferredMutex);
+				calls.swap(deferredCalls);
+				deferredQueued = false;
+			}
+			for (auto& call : calls) {
+				std::apply([&](auto&... args) {
+					invoke(args...);
+				}, call);
+			}
+		}
 
 		void removeModuleListeners(const std::string& file) override {
-			for (int i = 0; i < listeners.size(); i++) {
-				auto& listener = listeners[i];
-				auto ptr = *((void**)&listener.callback);
-				std::string f = ModuleManager::getModuleNameByAddress(ptr);
-				if (f == file) {
-					listeners.erase(listeners.begin() + i);
-					i--;
+			std::unique_lock<std::mutex> lock(writeMutex);
+			if (ListenerList* list = current.load()) {
+				ListenerList* copy = new ListenerList();
+				for (auto& listener : list->listeners) {
+					if (ModuleManager::getModuleNameByAddress((void*)listener->callback.getAddress()) != file) {
+						copy->listeners.push_back(listener);
+					}
+				}
+				if (copy->listeners.size() != list->listeners.size()) {
+					publish(copy);
+				}
+				else {
+					delete copy;
 				}
 			}
 			for (int i = 0; i < invokeOnceListeners.size(); i++) {
-				auto& listener = invokeOnceListeners[i];
-				auto ptr = *((void**)&listener.callback);
-				std::string f = ModuleManager::getModuleNameByAddress(ptr);
-				if (f == file) {
+				if (ModuleManager::getModuleNameByAddress((void*)invokeOnceListeners[i]->callback.getAddress()) == file) {
 					invokeOnceListeners.erase(invokeOnceListeners.begin() + i);
 					i--;
 				}
 			}
+			hasInvokeOnceListeners = !invokeOnceListeners.empty();
 		}
 	};
 
@@ -115,6 +244,8 @@ namespace tri {
 		Event<World*, std::string> onMapLoad;
 		Event<World*, std::string> onMapEnd;
 		Event<World*, std::string> onMapBegin;
+		//invoked in the destructor of the world
+		Event<World*> onWorldDestroy;
 
 		Event<int> onClassRegister;
 		Event<int> onClassUnregister;
@@ -160,6 +291,8 @@ namespace tri {
 		}
 
 		void removeModuleListeners(const std::string& file);
+		//invokes the events queued with invokeDeferred, called by the main loop before the tick
+		void dispatchDeferred();
 	private:
 		std::vector<std::shared_ptr<Event<World*, EntityId>>> onComponentAddEvents;
 		std::vector<std::shared_ptr<Event<World*, EntityId>>> onComponentRemoveEvents;
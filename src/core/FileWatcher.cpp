@@ -3,40 +3,146 @@
 //
 
 #include "FileWatcher.h"
+#include "config.h"
 #include "Environment.h"
 #include "ThreadManager.h"
+#include "JobManager.h"
+#include "EventManager.h"
+#include "Console.h"
 #include "Profiler.h"
+#include "util/Clock.h"
+
+#if !TRI_WINDOWS
+#include <sys/inotify.h>
+#include <poll.h>
+#include <unistd.h>
+#endif
 
 namespace tri {
 
 	TRI_SYSTEM_INSTANCE(FileWatcher, env->fileWatcher);
 
+	static std::string normalizePath(const std::string& path) {
+		std::string result = std::filesystem::absolute(path).lexically_normal().string();
+		while (result.size() > 1 && (result.back() == '/' || result.back() == '\\')) {
+			result.pop_back();
+		}
+		return result;
+	}
+
+	static bool isInside(const std::string& path, const std::string& directory) {
+		if (path.size() <= directory.size() || path.compare(0, directory.size(), directory) != 0) {
+			return false;
+		}
+		return path[directory.size()] == '/' || path[directory.size()] == '\\';
+	}
+
+	static uint64_t getTime(const std::string& path) {
+		try {
+			if (std::filesystem::exists(path)) {
+				return std::filesystem::last_write_time(path).time_since_epoch().count();
+			}
+		}
+		catch (...) {}
+		return 0;
+	}
+
+	void FileWatcher::init() {
+		env->console->addCVar<bool>("fileWatcherPolling", &usePolling);
+		//watching large directory trees can take a while and does not depend on other systems
+		env->jobManager->setConcurrentStartup<FileWatcher>();
+		env->eventManager->preTick.addListener([this]() {
+			deliverChanges();
+		});
+	}
+
 	void FileWatcher::startup() {
-		env->threadManager->addThread("File Watcher", [&]() {
-			while (true) {
-				std::this_thread::sleep_for(std::chrono::milliseconds((long long)(checkTimeInterval * 1000.0)));
-				TRI_PROFILE("FileWatcher");
+#if !TRI_WINDOWS
+		if (!usePolling) {
+			inotifyFd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+			if (inotifyFd < 0) {
+				env->console->warning("inotify not available, file watcher falls back to polling");
+			}
+		}
+#endif
+
+		{
+			std::unique_lock<std::mutex> lock(mutex);
+			if (inotifyFd >= 0) {
+				for (auto& dir : directories) {
+					dir.watched = watchDirectory(dir.absolutePath, dir.recursive);
+				}
 				for (auto& file : files) {
-					uint64_t time = 0;
-					try {
-						if (std::filesystem::exists(file.absolutePath)) {
-							time = std::filesystem::last_write_time(file.absolutePath).time_since_epoch().count();
-						}
-						if (time != file.time) {
-							file.time = time;
-							if (file.onChange) {
-								file.onChange(file.path);
-							}
-						}
+					file.watched = watchDirectory(std::filesystem::path(file.absolutePath).parent_path().string(), false);
+				}
+			}
+		}
+
+		running = true;
+		threadId = env->threadManager->addThread("File Watcher", [this]() {
+			Clock clock;
+			while (running) {
+				if (inotifyFd >= 0) {
+#if !TRI_WINDOWS
+					pollfd fd;
+					fd.fd = inotifyFd;
+					fd.events = POLLIN;
+					fd.revents = 0;
+					if (::poll(&fd, 1, 100) > 0) {
+						TRI_PROFILE("FileWatcher");
+						readEvents();
+					}
+#endif
+					//files in directories that did not exist when they where added
+					if (clock.elapsed() >= checkTimeInterval) {
+						clock.reset();
+						pollChanges(true);
 					}
-					catch (...) {}
+				}
+				else {
+					{
+						std::unique_lock<std::mutex> lock(wakeMutex);
+						wakeCondition.wait_for(lock, std::chrono::milliseconds((long long)(checkTimeInterval * 1000.0)));
+					}
+					if (!running) {
+						break;
+					}
+					TRI_PROFILE("FileWatcher");
+					pollChanges(false);
 				}
 			}
 		});
 	}
 
+	void FileWatcher::shutdown() {
+		running = false;
+		wakeCondition.notify_one();
+		if (threadId != -1) {
+			env->threadManager->joinThread(threadId);
+			env->threadManager->terminateThread(threadId);
+			threadId = -1;
+		}
+
+		std::unique_lock<std::mutex> lock(mutex);
+#if !TRI_WINDOWS
+		if (inotifyFd >= 0) {
+			close(inotifyFd);
+		}
+#endif
+		inotifyFd = -1;
+		watchDescriptors.clear();
+		watchedDirectories.clear();
+		for (auto& file : files) {
+			file.watched = false;
+		}
+		for (auto& dir : directories) {
+			dir.watched = false;
+		}
+	}
+
 	void FileWatcher::addFile(const std::string& path, const std::function<void(const std::string&)>& onChange) {
-		std::string absolutePath = std::filesystem::absolute(path).string();
+		std::string absolutePath = normalizePath(path);
+		std::unique_lock<std::mutex> lock(mutex);
 		for (auto& file : files) {
 			if (file.path == path || file.absolutePath == absolutePath) {
 				return;
@@ -44,16 +150,261 @@ namespace tri {
 		}
 		File file;
 		file.path = path;
+		file.absolutePath = absolutePath;
 		file.onChange = onChange;
-		if (std::filesystem::exists(file.path)) {
-			file.absolutePath = absolutePath;
-			try {
-				file.time = std::filesystem::last_write_time(file.absolutePath).time_since_epoch().count();
-			}catch(...){}
+		file.time = getTime(absolutePath);
+		if (inotifyFd >= 0) {
+			file.watched = watchDirectory(std::filesystem::path(absolutePath).parent_path().string(), false);
 		}
 		files.push_back(file);
 	}
 
-}
+	void FileWatcher::addDirectory(const std::string& path, const std::function<void(const std::string&)>& onChange, bool recursive) {
+		std::string absolutePath = normalizePath(path);
+		std::unique_lock<std::mutex> lock(mutex);
+		for (auto& dir : directories) {
+			if (dir.absolutePath == absolutePath && dir.recursive == recursive) {
+				return;
+			}
+		}
+		Directory dir;
+		dir.path = path;
+		dir.absolutePath = absolutePath;
+		dir.onChange = onChange;
+		dir.recursive = recursive;
+		if (inotifyFd >= 0) {
+			dir.watched = watchDirectory(absolutePath, recursive);
+		}
+		directories.push_back(dir);
+	}
+
+	bool FileWatcher::isEventBased() {
+		return inotifyFd >= 0;
+	}
+
+	bool FileWatcher::watchDirectory(const std::string& absolutePath, bool recursive) {
+#if !TRI_WINDOWS
+		if (!std::filesystem::is_directory(absolutePath)) {
+			return false;
+		}
+		if (!watchedDirectories.contains(absolutePath)) {
+			int wd = inotify_add_watch(inotifyFd, absolutePath.c_str(),
+				IN_CLOSE_WRITE | IN_MOVED_TO | IN_MOVED_FROM | IN_CREATE | IN_DELETE);
+			if (wd < 0) {
+				env->console->warning("failed to watch directory %s", absolutePath.c_str());
+				return false;
+			}
+			watchDescriptors[wd] = absolutePath;
+			watchedDirectories.insert(absolutePath);
+		}
+		if (recursive) {
+			try {
+				for (auto& entry : std::filesystem::directory_iterator(absolutePath, std::filesystem::directory_options::skip_permission_denied)) {
+					if (entry.is_directory()) {
+						watchDirectory(entry.path().lexically_normal().string(), true);
+					}
+				}
+			}
+			catch (...) {}
+		}
+		return true;
+#else
+		return false;
+#endif
+	}
+
+	void FileWatcher::readEvents() {
+#if !TRI_WINDOWS
+		alignas(inotify_event) char buffer[16 * 1024];
+		while (running) {
+			ssize_t bytes = read(inotifyFd, buffer, sizeof(buffer));
+			if (bytes <= 0) {
+				break;
+			}
+
+			for (char* ptr = buffer; ptr < buffer + bytes;) {
+				inotify_event* event = (inotify_event*)ptr;
+				ptr += sizeof(inotify_event) + event->len;
+
+				if (event->mask & IN_Q_OVERFLOW) {
+					//events where lost, fall back to comparing the timestamps
+					env->console->debug("file watcher event queue overflow");
+					pollChanges(false);
+					continue;
+				}
+
+				std::unique_lock<std::mutex> lock(mutex);
+				auto entry = watchDescriptors.find(event->wd);
+				if (entry == watchDescriptors.end()) {
+					continue;
+				}
+				if (event->mask & IN_IGNORED) {
+					//the directory was removed, its files are polled until it exists again
+					for (auto& file : files) {
+						if (std::filesystem::path(file.absolutePath).parent_path().string() == entry->second) {
+							file.watched = false;
+						}
+					}
+					for (auto& dir : directories) {
+						if (dir.absolutePath == entry->second) {
+							dir.watched = false;
+						}
+					}
+					watchedDirectories.erase(entry->second);
+					watchDescriptors.erase(entry);
+					continue;
+				}
+				std::string path = entry->second;
+				if (event->len > 0) {
+					path += "/";
+					path += event->name;
+				}
+
+				if (event->mask & IN_ISDIR) {
+					if (event->mask & (IN_CREATE | IN_MOVED_TO)) {
+						//new sub directories of recursive watches are watched as well
+						//files created before the watch was added are reported as changed
+						for (auto& dir : directories) {
+							if (dir.recursive && isInside(path, dir.absolutePath)) {
+								watchDirectory(path, true);
+								lock.unlock();
+								try {
+									for (auto& file : std::filesystem::recursive_directory_iterator(path, std::filesystem::directory_options::skip_permission_denied)) {
+										if (file.is_regular_file()) {
+											addPendingChange(file.path().lexically_normal().string());
+										}
+									}
+								}
+								catch (...) {}
+								break;
+							}
+						}
+					}
+				}
+				else {
+					lock.unlock();
+					addPendingChange(path);
+				}
+			}
+		}
+#endif
+	}
+
+	void FileWatcher::pollChanges(bool onlyUnwatched) {
+		std::unique_lock<std::mutex> lock(mutex);
+		for (auto& file : files) {
+			if (onlyUnwatched && file.watched) {
+				continue;
+			}
+			if (inotifyFd >= 0 && !file.watched) {
+				file.watched = watchDirectory(std::filesystem::path(file.absolutePath).parent_path().string(), false);
+			}
+			if (getTime(file.absolutePath) != file.time) {
+				addPendingChange(file.absolutePath);
+			}
+		}
+
+		for (auto& dir : directories) {
+			if (onlyUnwatched && dir.watched) {
+				continue;
+			}
+			if (inotifyFd >= 0 && !dir.watched) {
+				dir.watched = watchDirectory(dir.absolutePath, dir.recursive);
+			}
+
+			std::unordered_map<std::string, uint64_t> times;
+			auto check = [&](const std::filesystem::directory_entry& entry) {
+				if (entry.is_regular_file()) {
+					std::string path = entry.path().lexically_normal().string();
+					uint64_t time = entry.last_write_time().time_since_epoch().count();
+					times[path] = time;
+					auto previous = dir.times.find(path);
+					if (dir.scanned && (previous == dir.times.end() || previous->second != time)) {
+						addPendingChange(path);
+					}
+				}
+			};
+			try {
+				if (std::filesystem::is_directory(dir.absolutePath)) {
+					if (dir.recursive) {
+						for (auto& entry : std::filesystem::recursive_directory_iterator(dir.absolutePath, std::filesystem::directory_options::skip_permission_denied)) {
+							check(entry);
+						}
+					}
+					else {
+						for (auto& entry : std::filesystem::directory_iterator(dir.absolutePath, std::filesystem::directory_options::skip_permission_denied)) {
+							check(entry);
+						}
+					}
+				}
+			}
+			catch (...) {}
+			for (auto& previous : dir.times) {
+				if (!times.contains(previous.first)) {
+					addPendingChange(previous.first);
+				}
+			}
+			//the first scan only records the timestamps
+			dir.times.swap(times);
+			dir.scanned = true;
+		}
+	}
+
+	void FileWatcher::addPendingChange(const std::string& absolutePath) {
+		std::unique_lock<std::mutex> lock(pendingMutex);
+		pendingChanges[absolutePath] = Clock::now();
+	}
+
+	void FileWatcher::deliverChanges() {
+		std::vector<std::string> changes;
+		{
+			std::unique_lock<std::mutex> lock(pendingMutex);
+			if (pendingChanges.empty()) {
+				return;
+			}
+			double now = Clock::now();
+			for (auto i = pendingChanges.begin(); i != pendingChanges.end();) {
+				if (now - i->second >= coalesceTime) {
+					changes.push_back(i->first);
+					i = pendingChanges.erase(i);
+				}
+				else {
+					i++;
+				}
+			}
+		}
+		if (changes.empty()) {
+			return;
+		}
+
+		TRI_PROFILE("FileWatcher");
+		//the callbacks are invoked without holding the lock, so that they can add new files
+		std::vector<std::pair<std::function<void(const std::string&)>, std::string>> callbacks;
+		{
+			std::unique_lock<std::mutex> lock(mutex);
+			for (auto& path : changes) {
+				for (auto& file : files) {
+					if (file.absolutePath == path) {
+						uint64_t time = getTime(path);
+						if (time != file.time) {
+							file.time = time;
+							callbacks.push_back({ file.onChange, file.path });
+						}
+					}
+				}
+				for (auto& dir : directories) {
+					if (dir.recursive ? isInside(path, dir.absolutePath) : std::filesystem::path(path).parent_path().string() == dir.absolutePath) {
+						callbacks.push_back({ dir.onChange, path });
+					}
+				}
+			}
+		}
 
+		for (auto& callback : callbacks) {
+			if (callback.first) {
+				callback.first(callback.second);
+			}
+		}
+	}
 
+}
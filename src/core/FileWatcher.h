@@ -6,15 +6,28 @@
 
 #include "pch.h"
 #include "System.h"
+#include <atomic>
 
 namespace tri {
 
+	//watches files and directories for changes, uses inotify on linux and polls the timestamps otherwise
+	//change callbacks are invoked on the main thread before the tick
 	class FileWatcher : public System {
 	public:
+		//seconds between two checks when polling
 		double checkTimeInterval = 1;
+		//changes of the same file within this time in seconds are reported once
+		double coalesceTime = 0.05;
+		//use polling even if an event based backend is available
+		bool usePolling = false;
 
+		void init() override;
 		void startup() override;
+		void shutdown() override;
 		void addFile(const std::string& path, const std::function<void(const std::string &)>& onChange);
+		//invokes the callback with the path of every changed file in the directory
+		void addDirectory(const std::string& path, const std::function<void(const std::string&)>& onChange, bool recursive = true);
+		bool isEventBased();
 
 	private:
 		class File {
@@ -22,9 +35,42 @@ namespace tri {
 			std::string path;
 			std::string absolutePath;
 			std::function<void(const std::string&)> onChange;
-			uint64_t time;
+			uint64_t time = 0;
+			bool watched = false;
+		};
+		class Directory {
+		public:
+			std::string path;
+			std::string absolutePath;
+			std::function<void(const std::string&)> onChange;
+			bool recursive = true;
+			bool watched = false;
+			//timestamps of the contained files, only used when polling
+			std::unordered_map<std::string, uint64_t> times;
+			bool scanned = false;
 		};
 		std::vector<File> files;
+		std::vector<Directory> directories;
+		std::mutex mutex;
+
+		//absolute path and time of the last event
+		std::unordered_map<std::string, double> pendingChanges;
+		std::mutex pendingMutex;
+
+		int threadId = -1;
+		std::atomic<bool> running = false;
+		std::mutex wakeMutex;
+		std::condition_variable wakeCondition;
+
+		std::atomic<int> inotifyFd = -1;
+		std::unordered_map<int, std::string> watchDescriptors;
+		std::unordered_set<std::string> watchedDirectories;
+
+		void pollChanges(bool onlyUnwatched);
+		void readEvents();
+		bool watchDirectory(const std::string& absolutePath, bool recursive);
+		void addPendingChange(const std::string& absolutePath);
+		void deliverChanges();
 	};
 
 }
@@ -0,0 +1,63 @@
+//
+// Copyright (c) 2022 Julian Hinxlage. All rights reserved.
+//
+
+#include "FrameAllocator.h"
+#include "Environment.h"
+#include "Console.h"
+
+namespace tri {
+
+	TRI_SYSTEM_INSTANCE(FrameAllocator, env->frameAllocator);
+
+	thread_local FrameAllocator::ThreadArenas* FrameAllocator::currentArenas = nullptr;
+	thread_local int FrameAllocator::currentGeneration = 0;
+	static int nextGeneration = 1;
+
+	void FrameAllocator::init() {
+		generation = nextGeneration++;
+		env->console->addCVar<bool>("enableFrameAllocator", &enabled);
+		env->console->addCVar<int>("frameAllocatorBlockSize", &arenaBlockSize);
+		env->console->addCommand("frameAllocatorStats", [&](auto& args) {
+			env->console->info("frame allocator: %d allocations, %.1f KB allocated, %.1f KB capacity, %d threads",
+				(int)lastFrameStats.allocationCount, lastFrameStats.allocatedBytes / 1024.0, lastFrameStats.capacity / 1024.0, lastFrameStats.threadCount);
+		});
+	}
+
+	void FrameAllocator::bindThread() {
+		if (this == nullptr || currentGeneration == generation) {
+			return;
+		}
+		std::unique_lock<std::mutex> lock(mutex);
+		threadArenas.push_back(std::make_unique<ThreadArenas>(arenaBlockSize));
+		currentArenas = threadArenas.back().get();
+		currentGeneration = generation;
+	}
+
+	LinearArena* FrameAllocator::getArena() {
+		if (this == nullptr || !enabled || currentGeneration != generation) {
+			return nullptr;
+		}
+		return &currentArenas->arenas[frameIndex & 1];
+	}
+
+	void FrameAllocator::nextFrame() {
+		std::unique_lock<std::mutex> lock(mutex);
+		Stats stats;
+		for (auto& arenas : threadArenas) {
+			LinearArena& arena = arenas->arenas[frameIndex & 1];
+			stats.allocationCount += arena.getAllocationCount();
+			stats.allocatedBytes += arena.getAllocatedBytes();
+			stats.capacity += arenas->arenas[0].getCapacity() + arenas->arenas[1].getCapacity();
+		}
+		stats.threadCount = (int)threadArenas.size();
+		lastFrameStats = stats;
+
+		//the arena of the last frame is kept, the one of the frame before is reused
+		frameIndex++;
+		for (auto& arenas : threadArenas) {
+			arenas->arenas[frameIndex & 1].reset();
+		}
+	}
+
+}
@@ -0,0 +1,63 @@
+//
+// Copyright (c) 2022 Julian Hinxlage. All rights reserved.
+//
+
+#pragma once
+
+#include "System.h"
+#include "util/LinearArena.h"
+
+namespace tri {
+
+	//per thread linear arenas for transient allocations, memory of a frame stays valid until the end of the next frame
+	//only meant for plain data that is consumed within the frame, objects with a shared lifetime must not use it
+	class FrameAllocator : public System {
+	public:
+		bool enabled = true;
+		//size in bytes of the first block of each arena
+		int arenaBlockSize = 1024 * 256;
+
+		class Stats {
+		public:
+			size_t allocationCount = 0;
+			size_t allocatedBytes = 0;
+			size_t capacity = 0;
+			int threadCount = 0;
+		};
+
+		virtual void init() override;
+
+		//binds a double buffered arena to the calling thread, done by the jobs before ticking the systems
+		void bindThread();
+		//arena of the calling thread, nullptr if the thread is not bound (the allocators then use the heap)
+		LinearArena* getArena();
+		//swaps and resets the arenas of all threads, has to be called while no job is ticking
+		void nextFrame();
+		const Stats& getLastFrameStats() { return lastFrameStats; }
+
+		template<typename T>
+		ArenaAllocator<T> allocator() {
+			return ArenaAllocator<T>(getArena());
+		}
+
+	private:
+		class ThreadArenas {
+		public:
+			LinearArena arenas[2];
+			ThreadArenas(size_t blockSize) : arenas{ LinearArena(blockSize), LinearArena(blockSize) } {}
+		};
+
+		std::vector<std::unique_ptr<ThreadArenas>> threadArenas;
+		std::mutex mutex;
+		int frameIndex = 0;
+		int generation = 0;
+		Stats lastFrameStats;
+		static thread_local ThreadArenas* currentArenas;
+		static thread_local int currentGeneration;
+	};
+
+	//vector for memory that is only needed during the current frame
+	template<typename T>
+	using FrameVector = std::vector<T, ArenaAllocator<T>>;
+
+}
@@ -6,6 +6,8 @@
 #include "Environment.h"
 #include "ThreadManager.h"
 #include "Profiler.h"
+#include "FrameAllocator.h"
+#include "MemoryTracker.h"
 #include "Console.h"
 #include "CrashHandler.h"
 #include "EventManager.h"
@@ -45,6 +47,7 @@ namespace tri {
 		handle->job.name = name;
 		handle->job.enableMultithreading = true;
 		handle->job.systemNames = systems;
+		handle->job.updateNameHashes();
 		handle->isDefaultJob = false;
 		handle->pendingRemove = false;
 		jobs.push_back(handle);
@@ -113,6 +116,7 @@ namespace tri {
 		for (int i = 0; i < systemNames.size(); i++) {
 			if (systemNames[i] == name) {
 				systemNames.erase(systemNames.begin() + i);
+				updateNameHashes();
 				return;
 			}
 		}
@@ -169,6 +173,14 @@ namespace tri {
 				prevIndex = index;
 			}
 		}
+		updateNameHashes();
+	}
+
+	void JobManager::Job::updateNameHashes() {
+		systemNameHashes.resize(systemNames.size());
+		for (int i = 0; i < systemNames.size(); i++) {
+			systemNameHashes[i] = hashName(systemNames[i]);
+		}
 	}
 
 
@@ -207,6 +219,7 @@ namespace tri {
 					}
 				}
 			}
+			defualtJob->job.updateNameHashes();
 		}
 
 		if (!enableMultithreading) {
@@ -314,6 +327,7 @@ namespace tri {
 			}
 		}
 
+		joinConcurrentStartups();
 		startupSystems = false;
 	}
 
@@ -355,6 +369,93 @@ namespace tri {
 		}
 	}
 
+	void JobManager::setConcurrentStartup(const std::string& systemName, const std::vector<std::string>& dependencies) {
+		std::unique_lock<std::mutex> lock(concurrentStartupMutex);
+		auto& startup = concurrentStartups[systemName];
+		if (!startup) {
+			startup = std::make_shared<ConcurrentStartup>();
+		}
+		startup->dependencies = dependencies;
+	}
+
+	bool JobManager::launchConcurrentStartup(const ClassDescriptor* desc, System* sys) {
+		std::unique_lock<std::mutex> lock(concurrentStartupMutex);
+		auto entry = concurrentStartups.find(desc->name);
+		if (entry == concurrentStartups.end()) {
+			return false;
+		}
+		auto startup = entry->second;
+		if (startup->threadId != -1) {
+			return true;
+		}
+
+		startup->finished = false;
+		std::string name = desc->name;
+		int classId = desc->classId;
+		startup->threadId = env->threadManager->addThread("Startup " + name, [this, startup, name, classId, sys]() {
+			{
+				std::unique_lock<std::mutex> lock(concurrentStartupMutex);
+				for (auto& dependency : startup->dependencies) {
+					concurrentStartupCondition.wait(lock, [&]() {
+						auto entry = concurrentStartups.find(dependency);
+						if (entry != concurrentStartups.end() && entry->second->threadId != -1) {
+							return entry->second->finished;
+						}
+						return regularStartupsFinished;
+					});
+				}
+			}
+
+			int recovery = setjmp(*(jmp_buf*)env->systemManager->getSystem<CrashHandler>()->recoveryPoint);
+			if (recovery) {
+				env->memoryTracker->endSystem();
+				env->console->info("crash recovery performed");
+			}
+			else {
+				TRI_PROFILE_NAME(name.c_str(), name.size());
+				StartupTimer timer("startup", name);
+				env->memoryTracker->beginSystem(classId);
+				sys->startup();
+				env->memoryTracker->endSystem();
+			}
+
+			std::unique_lock<std::mutex> lock(concurrentStartupMutex);
+			startup->finished = true;
+			concurrentStartupCondition.notify_all();
+		});
+		return true;
+	}
+
+	void JobManager::joinConcurrentStartups() {
+		std::vector<std::pair<std::string, std::shared_ptr<ConcurrentStartup>>> launched;
+		{
+			std::unique_lock<std::mutex> lock(concurrentStartupMutex);
+			regularStartupsFinished = true;
+			for (auto& [name, startup] : concurrentStartups) {
+				if (startup->threadId != -1) {
+					launched.push_back({ name, startup });
+				}
+			}
+		}
+		concurrentStartupCondition.notify_all();
+
+		for (auto& [name, startup] : launched) {
+			env->threadManager->joinThread(startup->threadId);
+			env->threadManager->terminateThread(startup->threadId);
+			if (auto* desc = Reflection::getDescriptor(name)) {
+				if (auto* handle = env->systemManager->getSystemHandle(desc->classId)) {
+					handle->wasStartup = true;
+				}
+			}
+		}
+
+		std::unique_lock<std::mutex> lock(concurrentStartupMutex);
+		for (auto& [name, startup] : launched) {
+			startup->threadId = -1;
+		}
+		regularStartupsFinished = false;
+	}
+
 	void JobManager::syncBegin() {
 		if (syncBarrierBegin) {
 			syncBarrierBegin->arrive_and_wait();
@@ -425,6 +526,7 @@ namespace tri {
 
 		TRI_PROFILE_NAME(job.name.c_str(), job.name.size())
 		env->profiler->begin(job.name.c_str());
+		env->frameAllocator->bindThread();
 
 		int recoveryIndex = 0;
 
@@ -432,20 +534,23 @@ namespace tri {
 		//in that case the next system after the one, that caused the exception, should be continued with
 		int recovery = setjmp(*(jmp_buf*)env->systemManager->getSystem<CrashHandler>()->recoveryPoint);
 		if (recovery) {
+			env->memoryTracker->endSystem();
 			env->console->info("crash recovery performed");
 			recoveryIndex++;
 		}
 
 		int index = 0;
-		for (auto& name : job.systemNames) {
+		for (uint64_t nameHash : job.systemNameHashes) {
 			if (index >= recoveryIndex) {
-				if (auto* desc = Reflection::getDescriptor(name)) {
+				if (auto* desc = Reflection::getDescriptorByHash(nameHash)) {
 					if (auto* sys = env->systemManager->getSystem(desc->classId)) {
 						auto* handle = env->systemManager->getSystemHandle(desc->classId);
 						if (handle->active) {
 							TRI_PROFILE_NAME(desc->name.c_str(), desc->name.size());
 							env->profiler->begin(desc->name.c_str());
+							env->memoryTracker->beginSystem(desc->classId);
 							sys->tick();
+							env->memoryTracker->endSystem();
 							env->profiler->end();
 						}
 					}
@@ -498,19 +603,23 @@ namespace tri {
 		//in that case the next system after the one, that caused the exception, should be continued with
 		int recovery = setjmp(*(jmp_buf*)env->systemManager->getSystem<CrashHandler>()->recoveryPoint);
 		if (recovery) {
+			env->memoryTracker->endSystem();
 			env->console->info("crash recovery performed");
 			recoveryIndex++;
 		}
 
 		int index = 0;
-		for (auto& name : job.systemNames) {
+		for (uint64_t nameHash : job.systemNameHashes) {
 			if (index >= recoveryIndex) {
-				if (auto* desc = Reflection::getDescriptor(name)) {
+				if (auto* desc = Reflection::getDescriptorByHash(nameHash)) {
 					if (auto* sys = env->systemManager->getSystem(desc->classId)) {
 						auto* handle = env->systemManager->getSystemHandle(desc->classId);
-						if (!handle->wasStartup) {
+						if (!handle->wasStartup && !jobManager->launchConcurrentStartup(desc, sys)) {
 							TRI_PROFILE_NAME(desc->name.c_str(), desc->name.size());
+							StartupTimer timer("startup", desc->name);
+							env->memoryTracker->beginSystem(desc->classId);
 							sys->startup();
+							env->memoryTracker->endSystem();
 							handle->wasStartup = true;
 						}
 					}
@@ -553,9 +662,9 @@ namespace tri {
 		}
 
 		int index = 0;
-		for (auto& name : job.systemNames) {
+		for (uint64_t nameHash : job.systemNameHashes) {
 			if (index >= recoveryIndex) {
-				if (auto* desc = Reflection::getDescriptor(name)) {
+				if (auto* desc = Reflection::getDescriptorByHash(nameHash)) {
 					if (auto* sys = env->systemManager->getSystem(desc->classId)) {
 						auto* handle = env->systemManager->getSystemHandle(desc->classId);
 						if (!handle->wasShutdown && handle->pendingShutdown) {
@@ -46,11 +46,13 @@ namespace tri {
 		private:
 			friend class JobManager;
 			std::vector<std::string> systemNames;
-			std::vector<int> systemClassIds;
+			//hashes of the system names, used to lookup the systems while ticking
+			std::vector<uint64_t> systemNameHashes;
 			std::vector<std::string> jobExclusion;
 			std::vector<std::string> childJobs;
 			std::vector<std::vector<std::string>> orderConstraints;
 			void sort();
+			void updateNameHashes();
 		};
 
 		Job* addJob(const std::string& name, const std::vector<std::string>& systems = {});
@@ -63,6 +65,14 @@ namespace tri {
 		void shutdownPendingSystems(bool invokeEvent);
 		void shutdownJobs();
 
+		//the startup of the system runs on its own thread, concurrent to the startups of the other systems
+		//dependencies that are concurrent startups themselves are waited for, other dependencies are waited for until all regular startups are done
+		void setConcurrentStartup(const std::string& systemName, const std::vector<std::string>& dependencies = {});
+		template<typename T>
+		void setConcurrentStartup(const std::vector<std::string>& dependencies = {}) {
+			setConcurrentStartup(Reflection::getDescriptor<T>()->name, dependencies);
+		}
+
 	private:
 
 		class JobHandle {
@@ -94,6 +104,21 @@ namespace tri {
 		std::shared_ptr<std::barrier<>> syncBarrierUpdate;
 		int syncBarrierSize;
 
+		class ConcurrentStartup {
+		public:
+			std::vector<std::string> dependencies;
+			int threadId = -1;
+			bool finished = false;
+		};
+		std::unordered_map<std::string, std::shared_ptr<ConcurrentStartup>> concurrentStartups;
+		std::mutex concurrentStartupMutex;
+		std::condition_variable concurrentStartupCondition;
+		bool regularStartupsFinished = false;
+
+		//returns false if the system does not use a concurrent startup
+		bool launchConcurrentStartup(const ClassDescriptor* desc, System* sys);
+		void joinConcurrentStartups();
+
 		JobHandle* getJobHandle(const std::string& name);
 		JobHandle* getDefaultJob();
 		void syncBegin();
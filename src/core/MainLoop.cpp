@@ -9,6 +9,8 @@
 #include "CrashHandler.h"
 #include "ModuleManager.h"
 #include "Profiler.h"
+#include "FrameAllocator.h"
+#include "WorkScheduler.h"
 #include "JobManager.h"
 #include "CrashHandler.h"
 #include "SystemManager.h"
@@ -98,6 +100,9 @@ namespace tri {
 				env->jobManager->startupPendingSystems(false);
 			}
 
+			//events that where invoked deferred during the last frame
+			env->eventManager->dispatchDeferred();
+
 			//tick jobs which will tick systems
 			{
 				TRI_PROFILE("preTick");
@@ -113,6 +118,12 @@ namespace tri {
 				env->profiler->end();
 			}
 
+			//run background work while all jobs are waiting for the next frame
+			env->workScheduler->run();
+
+			//all jobs are waiting for the next frame, so the frame arenas can be reset
+			env->frameAllocator->nextFrame();
+
 			//performe shutdown on systems to be removed
 			if (env->systemManager->hasPendingShutdowns()) {
 				env->jobManager->shutdownPendingSystems(false);
@@ -0,0 +1,397 @@
+//
+// Copyright (c) 2022 Julian Hinxlage. All rights reserved.
+//
+
+#include "MemoryTracker.h"
+#include "config.h"
+#include "Environment.h"
+#include "Console.h"
+#include "EventManager.h"
+#include "ModuleManager.h"
+#include <atomic>
+#include <cstddef>
+#include <cstdlib>
+#include <new>
+
+#if !TRI_WINDOWS
+#include <dlfcn.h>
+#endif
+
+namespace tri {
+
+	TRI_SYSTEM_INSTANCE(MemoryTracker, env->memoryTracker);
+
+	namespace impl {
+
+		//counters of one thread, only written by the owning thread
+		class MemoryCounters {
+		public:
+			std::atomic<int64_t> allocBytes[MemoryTracker::maxTagCount];
+			std::atomic<int64_t> allocCount[MemoryTracker::maxTagCount];
+			std::atomic<int64_t> freeBytes[MemoryTracker::maxTagCount];
+			std::atomic<int64_t> freeCount[MemoryTracker::maxTagCount];
+			MemoryCounters* next = nullptr;
+			bool registered = false;
+
+			~MemoryCounters();
+		};
+
+		//counters of threads that already exited
+		static MemoryCounters retiredCounters;
+		static MemoryCounters* threadCounters = nullptr;
+		static std::mutex threadCountersMutex;
+		static std::atomic<bool> trackingEnabled = true;
+
+		static thread_local MemoryCounters counters;
+		static thread_local bool countersDestroyed = false;
+		static thread_local uint16_t currentSystemTag = 0;
+		static thread_local uint16_t currentModuleTag = 0;
+
+		//tag ids of the systems (low 16 bits) and the modules of the systems (high 16 bits) by class id, 0 = unknown
+		static const int maxSystemClassId = 4096;
+		static std::atomic<int32_t> systemTagCache[maxSystemClassId];
+
+		static void add(std::atomic<int64_t>& counter, int64_t value) {
+			counter.store(counter.load(std::memory_order_relaxed) + value, std::memory_order_relaxed);
+		}
+
+		MemoryCounters::~MemoryCounters() {
+			if (this == &retiredCounters) {
+				return;
+			}
+			countersDestroyed = true;
+			if (registered) {
+				std::unique_lock<std::mutex> lock(threadCountersMutex);
+				for (int i = 0; i < MemoryTracker::maxTagCount; i++) {
+					add(retiredCounters.allocBytes[i], allocBytes[i].load(std::memory_order_relaxed));
+					add(retiredCounters.allocCount[i], allocCount[i].load(std::memory_order_relaxed));
+					add(retiredCounters.freeBytes[i], freeBytes[i].load(std::memory_order_relaxed));
+					add(retiredCounters.freeCount[i], freeCount[i].load(std::memory_order_relaxed));
+				}
+				MemoryCounters** ptr = &threadCounters;
+				while (*ptr) {
+					if (*ptr == this) {
+						*ptr = next;
+						break;
+					}
+					ptr = &(*ptr)->next;
+				}
+			}
+		}
+
+		static MemoryCounters* getCounters() {
+			if (countersDestroyed) {
+				return nullptr;
+			}
+			MemoryCounters* c = &counters;
+			if (!c->registered) {
+				c->registered = true;
+				std::unique_lock<std::mutex> lock(threadCountersMutex);
+				c->next = threadCounters;
+				threadCounters = c;
+			}
+			return c;
+		}
+
+#if TRI_MEMORY_TRACKING
+		//stored in front of every allocation, so that the free can be attributed to the same tags
+		class AllocationHeader {
+		public:
+			uint64_t size;
+			uint16_t systemTag;
+			uint16_t moduleTag;
+			uint32_t offset;
+		};
+		static_assert(sizeof(AllocationHeader) == 16);
+
+		static void* trackedAllocate(size_t size, size_t alignment) {
+			if (alignment < sizeof(AllocationHeader)) {
+				alignment = sizeof(AllocationHeader);
+			}
+			uint8_t* base = (uint8_t*)std::malloc(size + alignment);
+			if (!base) {
+				return nullptr;
+			}
+			uint8_t* ptr = (uint8_t*)(((size_t)base + sizeof(AllocationHeader) + alignment - 1) & ~(alignment - 1));
+			AllocationHeader* header = (AllocationHeader*)ptr - 1;
+			header->size = size;
+			header->systemTag = currentSystemTag;
+			header->moduleTag = currentModuleTag;
+			header->offset = (uint32_t)(ptr - base);
+
+			if (trackingEnabled.load(std::memory_order_relaxed)) {
+				if (MemoryCounters* c = getCounters()) {
+					add(c->allocBytes[header->systemTag], size);
+					add(c->allocCount[header->systemTag], 1);
+					if (header->moduleTag != header->systemTag) {
+						add(c->allocBytes[header->moduleTag], size);
+						add(c->allocCount[header->moduleTag], 1);
+					}
+				}
+			}
+			return ptr;
+		}
+
+		static void trackedFree(void* ptr) {
+			if (!ptr) {
+				return;
+			}
+			AllocationHeader* header = (AllocationHeader*)ptr - 1;
+			if (trackingEnabled.load(std::memory_order_relaxed)) {
+				if (MemoryCounters* c = getCounters()) {
+					add(c->freeBytes[header->systemTag], header->size);
+					add(c->freeCount[header->systemTag], 1);
+					if (header->moduleTag != header->systemTag) {
+						add(c->freeBytes[header->moduleTag], header->size);
+						add(c->freeCount[header->moduleTag], 1);
+					}
+				}
+			}
+			std::free((uint8_t*)ptr - header->offset);
+		}
+#endif
+
+	}
+
+	void MemoryTracker::init() {
+		getTag("other", false);
+
+		env->eventManager->onClassUnregister.addListener([](int classId) {
+			if (classId >= 0 && classId < impl::maxSystemClassId) {
+				impl::systemTagCache[classId].store(0, std::memory_order_relaxed);
+			}
+		});
+		env->eventManager->postTick.addListener([this]() {
+			update();
+		});
+
+		env->console->addCVar<bool>("enableMemoryTracking", &enabled);
+		env->console->addCommand("memoryStats", [&](auto& args) {
+			dump(args.size() > 0 ? args[0] : "");
+		});
+	}
+
+	bool MemoryTracker::isAvailable() {
+#if TRI_MEMORY_TRACKING
+		return true;
+#else
+		return false;
+#endif
+	}
+
+	void MemoryTracker::beginSystem(int classId) {
+		if (this == nullptr || classId < 0 || classId >= impl::maxSystemClassId) {
+			return;
+		}
+		int32_t cached = impl::systemTagCache[classId].load(std::memory_order_relaxed);
+		if (cached == 0) {
+			if (auto* desc = Reflection::getDescriptor(classId)) {
+				std::string module = ModuleManager::getModuleNameByAddress(desc->registrationSourceAddress);
+#if !TRI_WINDOWS
+				Dl_info info;
+				if (module.empty() && dladdr(desc->registrationSourceAddress, &info) && info.dli_fname) {
+					module = info.dli_fname;
+				}
+#endif
+				int systemTag = getTag(desc->name, false);
+				int moduleTag = module.empty() ? 0 : getTag(std::filesystem::path(module).stem().string(), true);
+				cached = systemTag | (moduleTag << 16);
+				impl::systemTagCache[classId].store(cached, std::memory_order_relaxed);
+			}
+		}
+		impl::currentSystemTag = cached & 0xffff;
+		impl::currentModuleTag = (cached >> 16) & 0xffff;
+	}
+
+	void MemoryTracker::endSystem() {
+		impl::currentSystemTag = 0;
+		impl::currentModuleTag = 0;
+	}
+
+	int MemoryTracker::beginModule(const std::string& name) {
+		int previous = impl::currentModuleTag;
+		if (this != nullptr) {
+			impl::currentModuleTag = getTag(name, true);
+		}
+		return previous;
+	}
+
+	void MemoryTracker::endModule(int previousTag) {
+		impl::currentModuleTag = previousTag;
+	}
+
+	int MemoryTracker::getTag(const std::string& name, bool isModule) {
+		std::unique_lock<std::mutex> lock(mutex);
+		std::string key = (isModule ? "module:" : "system:") + name;
+		auto entry = tagIndices.find(key);
+		if (entry != tagIndices.end()) {
+			return entry->second;
+		}
+		if (tags.size() >= maxTagCount) {
+			return 0;
+		}
+		int tag = (int)tags.size();
+		TagStats& stats = tags.emplace_back();
+		stats.name = name;
+		stats.isModule = isModule;
+		tagIndices[key] = tag;
+		lastAllocBytes.push_back(0);
+		lastAllocCount.push_back(0);
+		return tag;
+	}
+
+	void MemoryTracker::update() {
+		impl::trackingEnabled.store(enabled, std::memory_order_relaxed);
+		if (!isAvailable()) {
+			return;
+		}
+
+		int64_t allocBytes[maxTagCount] = {};
+		int64_t allocCount[maxTagCount] = {};
+		int64_t freeBytes[maxTagCount] = {};
+		int64_t freeCount[maxTagCount] = {};
+		std::unique_lock<std::mutex> lock(mutex);
+		int tagCount = (int)tags.size();
+		{
+			auto sum = [&](impl::MemoryCounters* c) {
+				for (int i = 0; i < tagCount; i++) {
+					allocBytes[i] += c->allocBytes[i].load(std::memory_order_relaxed);
+					allocCount[i] += c->allocCount[i].load(std::memory_order_relaxed);
+					freeBytes[i] += c->freeBytes[i].load(std::memory_order_relaxed);
+					freeCount[i] += c->freeCount[i].load(std::memory_order_relaxed);
+				}
+			};
+			std::unique_lock<std::mutex> lock2(impl::threadCountersMutex);
+			sum(&impl::retiredCounters);
+			for (auto* c = impl::threadCounters; c; c = c->next) {
+				sum(c);
+			}
+		}
+
+		for (int i = 0; i < tagCount; i++) {
+			TagStats& stats = tags[i];
+			stats.liveBytes = allocBytes[i] - freeBytes[i];
+			stats.liveCount = allocCount[i] - freeCount[i];
+			stats.frameBytes = allocBytes[i] - lastAllocBytes[i];
+			stats.frameCount = allocCount[i] - lastAllocCount[i];
+			lastAllocBytes[i] = allocBytes[i];
+			lastAllocCount[i] = allocCount[i];
+		}
+	}
+
+	std::vector<MemoryTracker::TagStats> MemoryTracker::getStats() {
+		std::unique_lock<std::mutex> lock(mutex);
+		return tags;
+	}
+
+	void MemoryTracker::dump(const std::string& filter) {
+		if (!isAvailable()) {
+			env->console->info("memory tracking is not available, build with TRI_MEMORY_TRACKING");
+			return;
+		}
+		std::vector<TagStats> stats = getStats();
+		std::sort(stats.begin(), stats.end(), [](const TagStats& a, const TagStats& b) {
+			return a.liveBytes > b.liveBytes;
+		});
+		env->console->info("memory per module/system: live KB / live allocations / KB per frame / allocations per frame");
+		for (auto& tag : stats) {
+			if (filter.empty() || tag.name.find(filter) != std::string::npos) {
+				env->console->info("%s %s: %.1f / %lld / %.1f / %lld", tag.isModule ? "module" : "system", tag.name.c_str(),
+					tag.liveBytes / 1024.0, (long long)tag.liveCount, tag.frameBytes / 1024.0, (long long)tag.frameCount);
+			}
+		}
+	}
+
+	void MemoryTracker::reportModuleLeaks(const std::string& name) {
+		if (this == nullptr || !isAvailable()) {
+			return;
+		}
+		update();
+		std::unique_lock<std::mutex> lock(mutex);
+		auto entry = tagIndices.find("module:" + name);
+		if (entry != tagIndices.end()) {
+			TagStats& stats = tags[entry->second];
+			if (stats.liveCount > 0) {
+				env->console->warning("module \"%s\" unloaded with %lld allocations (%.1f KB) still alive",
+					name.c_str(), (long long)stats.liveCount, stats.liveBytes / 1024.0);
+			}
+		}
+	}
+
+}
+
+#if TRI_MEMORY_TRACKING
+
+//replacing the global allocation functions in the core library routes the allocations of all modules through the tracker
+//(with msvc every dll has its own operator new, there only the allocations of the core library are tracked)
+void* operator new(size_t size) {
+	if (void* ptr = tri::impl::trackedAllocate(size, alignof(std::max_align_t))) {
+		return ptr;
+	}
+	throw std::bad_alloc();
+}
+
+void* operator new[](size_t size) {
+	return operator new(size);
+}
+
+void* operator new(size_t size, const std::nothrow_t&) noexcept {
+	return tri::impl::trackedAllocate(size, alignof(std::max_align_t));
+}
+
+void* operator new[](size_t size, const std::nothrow_t&) noexcept {
+	return tri::impl::trackedAllocate(size, alignof(std::max_align_t));
+}
+
+void* operator new(size_t size, std::align_val_t alignment) {
+	if (void* ptr = tri::impl::trackedAllocate(size, (size_t)alignment)) {
+		return ptr;
+	}
+	throw std::bad_alloc();
+}
+
+void* operator new[](size_t size, std::align_val_t alignment) {
+	return operator new(size, alignment);
+}
+
+void operator delete(void* ptr) noexcept {
+	tri::impl::trackedFree(ptr);
+}
+
+void operator delete[](void* ptr) noexcept {
+	tri::impl::trackedFree(ptr);
+}
+
+void operator delete(void* ptr, size_t) noexcept {
+	tri::impl::trackedFree(ptr);
+}
+
+void operator delete[](void* ptr, size_t) noexcept {
+	tri::impl::trackedFree(ptr);
+}
+
+void operator delete(void* ptr, const std::nothrow_t&) noexcept {
+	tri::impl::trackedFree(ptr);
+}
+
+void operator delete[](void* ptr, const std::nothrow_t&) noexcept {
+	tri::impl::trackedFree(ptr);
+}
+
+void operator delete(void* ptr, std::align_val_t) noexcept {
+	tri::impl::trackedFree(ptr);
+}
+
+void operator delete[](void* ptr, std::align_val_t) noexcept {
+	tri::impl::trackedFree(ptr);
+}
+
+void operator delete(void* ptr, size_t, std::align_val_t) noexcept {
+	tri::impl::trackedFree(ptr);
+}
+
+void operator delete[](void* ptr, size_t, std::align_val_t) noexcept {
+	tri::impl::trackedFree(ptr);
+}
+
+#endif
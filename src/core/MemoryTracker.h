@@ -0,0 +1,58 @@
+//
+// Copyright (c) 2022 Julian Hinxlage. All rights reserved.
+//
+
+#pragma once
+
+#include "System.h"
+
+namespace tri {
+
+	//attributes heap allocations to the currently running system and module
+	//the allocation hooks are only compiled in when building with TRI_MEMORY_TRACKING
+	class MemoryTracker : public System {
+	public:
+		static const int maxTagCount = 256;
+		bool enabled = true;
+
+		class TagStats {
+		public:
+			std::string name;
+			bool isModule = false;
+			int64_t liveBytes = 0;
+			int64_t liveCount = 0;
+			//allocations during the last frame
+			int64_t frameBytes = 0;
+			int64_t frameCount = 0;
+		};
+
+		virtual void init() override;
+
+		//true if the global operator new and delete are replaced
+		static bool isAvailable();
+
+		//attributes allocations of the calling thread to the system and the module the system was registered from
+		void beginSystem(int classId);
+		void endSystem();
+		//attributes allocations of the calling thread to the module, returns the previous module tag
+		int beginModule(const std::string& name);
+		void endModule(int previousTag);
+
+		//sums up the counters of all threads, called once per frame
+		void update();
+		std::vector<TagStats> getStats();
+		void dump(const std::string& filter);
+		//logs the memory that is still allocated by the module
+		void reportModuleLeaks(const std::string& name);
+
+	private:
+		std::vector<TagStats> tags;
+		std::unordered_map<std::string, int> tagIndices;
+		std::vector<int64_t> lastAllocBytes;
+		std::vector<int64_t> lastAllocCount;
+		std::mutex mutex;
+
+		int getTag(const std::string& name, bool isModule);
+	};
+
+}
@@ -9,6 +9,8 @@
 #include "EventManager.h"
 #include "Profiler.h"
 #include "FileWatcher.h"
+#include "MemoryTracker.h"
+#include "ThreadManager.h"
 #include "engine/Asset.h"
 
 #if !TRI_WINDOWS
@@ -98,12 +100,7 @@ namespace tri {
 		return moduleDirectories;
 	}
 
-	Module* ModuleManager::loadModule(const std::string& name, bool pending, bool loadAsStub) {
-		if (pending) {
-			pendingLoads.push_back(name);
-			return nullptr;
-		}
-		
+	std::string ModuleManager::findModuleFile(const std::string& name) {
 		std::string filePath = name;
 		if (std::filesystem::path(filePath).extension() == "") {
 #if TRI_WINDOWS
@@ -121,6 +118,70 @@ namespace tri {
 				}
 			}
 		}
+		return filePath;
+	}
+
+	std::string ModuleManager::createRuntimeFile(const std::string& filePath) {
+		std::string runtimePath = filePath;
+		std::filesystem::path path(filePath);
+		for (int postfix = 0; postfix < 10; postfix++) {
+			runtimePath = (path.parent_path() / "runtime_dlls" / std::to_string(postfix) / path.filename()).string();
+			try {
+				if (!std::filesystem::exists(std::filesystem::path(runtimePath).parent_path())) {
+					std::filesystem::create_directories(std::filesystem::path(runtimePath).parent_path());
+				}
+				std::filesystem::copy(filePath, runtimePath, std::filesystem::copy_options::overwrite_existing);
+				break;
+			}
+			catch (...) {}
+		}
+		return runtimePath;
+	}
+
+	void ModuleManager::prepareModules(const std::vector<std::string>& names) {
+		for (auto& name : names) {
+			if (getModule(name) || preparedModules.contains(name)) {
+				continue;
+			}
+			auto prepared = std::make_shared<PreparedModule>();
+			prepared->filePath = findModuleFile(name);
+			if (!std::filesystem::exists(prepared->filePath)) {
+				continue;
+			}
+			bool copy = enableModuleHotReloading;
+			//the current path can change while the thread is running
+			std::string absolutePath = std::filesystem::absolute(prepared->filePath).string();
+			prepared->threadId = env->threadManager->addThread("Module Prepare", [this, prepared, name, copy, absolutePath]() {
+				StartupTimer timer("prepare", name);
+				if (copy) {
+					prepared->runtimePath = createRuntimeFile(absolutePath);
+				}
+				//reading the file once puts it into the page cache, dlopen then maps it without waiting for the disk
+				std::ifstream stream(prepared->runtimePath.empty() ? absolutePath : prepared->runtimePath, std::ios::binary);
+				std::vector<char> buffer(1024 * 1024);
+				while (stream.read(buffer.data(), buffer.size()) || stream.gcount() > 0) {}
+			});
+			preparedModules[name] = prepared;
+		}
+	}
+
+	Module* ModuleManager::loadModule(const std::string& name, bool pending, bool loadAsStub) {
+		if (pending) {
+			pendingLoads.push_back(name);
+			return nullptr;
+		}
+
+		StartupTimer timer("module", name);
+		std::shared_ptr<PreparedModule> prepared;
+		auto entry = preparedModules.find(name);
+		if (entry != preparedModules.end()) {
+			prepared = entry->second;
+			preparedModules.erase(entry);
+			env->threadManager->joinThread(prepared->threadId);
+			env->threadManager->terminateThread(prepared->threadId);
+		}
+
+		std::string filePath = prepared ? prepared->filePath : findModuleFile(name);
 
 		TRI_PROFILE_FUNC();
 		TRI_PROFILE_INFO(filePath.c_str(), filePath.size());
@@ -136,18 +197,11 @@ namespace tri {
 
 		std::string runtimePath = filePath;
 		if (enableModuleHotReloading) {
-			std::filesystem::path path(filePath);
-			int postfix = 0;
-			for (int postfix = 0; postfix < 10; postfix++) {
-				runtimePath = (path.parent_path() / "runtime_dlls" / std::to_string(postfix) / path.filename()).string();
-				if (!std::filesystem::exists(std::filesystem::path(runtimePath).parent_path())) {
-					std::filesystem::create_directories(std::filesystem::path(runtimePath).parent_path());
-				}
-				try {
-					std::filesystem::copy(filePath, runtimePath, std::filesystem::copy_options::overwrite_existing);
-					break;
-				}
-				catch (...) {}
+			if (prepared && !prepared->runtimePath.empty()) {
+				runtimePath = prepared->runtimePath;
+			}
+			else {
+				runtimePath = createRuntimeFile(filePath);
 			}
 		}
 
@@ -166,6 +220,7 @@ namespace tri {
 		module->handle = nullptr;
 		modules.push_back(module);
 		currentlyLoading = module.get();
+		int previousMemoryTag = env->memoryTracker->beginModule(module->name);
 
 
 		{
@@ -223,6 +278,7 @@ namespace tri {
 		//a short delay prevents the crash handler from crashing when this module is unloaded
 		std::this_thread::sleep_for(std::chrono::milliseconds(10));
 
+		env->memoryTracker->endModule(previousMemoryTag);
 		currentlyLoading = nullptr;
 		return module.get();
 	}
@@ -299,6 +355,7 @@ namespace tri {
 				unregister.clear();
 
 				env->eventManager->removeModuleListeners(module->runtimeFile);
+				env->memoryTracker->reportModuleLeaks(module->name);
 
 				{
 #ifdef TRI_WINDOWS
@@ -328,6 +385,23 @@ namespace tri {
 			loadModule(file, false);
 		}
 		pendingLoads.clear();
+		joinPreparedModules();
+	}
+
+	void ModuleManager::shutdown() {
+		joinPreparedModules();
+	}
+
+	void ModuleManager::joinPreparedModules() {
+		if (!env->threadManager) {
+			preparedModules.clear();
+			return;
+		}
+		for (auto& [name, prepared] : preparedModules) {
+			env->threadManager->joinThread(prepared->threadId);
+			env->threadManager->terminateThread(prepared->threadId);
+		}
+		preparedModules.clear();
 	}
 
 	std::string ModuleManager::getModuleNameByAddress(void* address) {
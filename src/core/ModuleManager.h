@@ -26,11 +26,14 @@ namespace tri {
 		bool enableModuleHotReloading = false;
 
 		void init() override;
+		void shutdown() override;
 		Module* loadModule(const std::string& name, bool pending = true, bool loadAsStub = false);
 		Module* getModule(const std::string& name);
 		void unloadModule(const std::string& name, bool pending = true);
 		void unloadModule(Module *module, bool pending = true);
 		void performePending();
+		//copies and reads the files of the modules in parallel, so that loading them later only has to open them
+		void prepareModules(const std::vector<std::string>& names);
 
 		void addModuleDirectory(const std::string& directory);
 		void removeModuleDirectory(const std::string &directory);
@@ -39,11 +42,24 @@ namespace tri {
 		const std::vector<std::shared_ptr<Module>> &getModules();
 		static std::string getModuleNameByAddress(void* address);
 	private:
+		class PreparedModule {
+		public:
+			std::string filePath;
+			std::string runtimePath;
+			int threadId = -1;
+		};
+		std::unordered_map<std::string, std::shared_ptr<PreparedModule>> preparedModules;
 		std::vector<std::shared_ptr<Module>> modules;
 		std::vector<std::string> pendingLoads;
 		std::vector<std::string> pendingUnloads;
 		Module* currentlyLoading;
 		std::vector<std::string> moduleDirectories;
+
+		std::string findModuleFile(const std::string& name);
+		//copy of the module that is loaded, so that the original file can be rebuild while the module is loaded
+		std::string createRuntimeFile(const std::string& filePath);
+		//joins the preparations of modules that where not loaded
+		void joinPreparedModules();
 	};
 
 }
@@ -6,14 +6,18 @@
 #include "Reflection.h"
 #include "Environment.h"
 #include "EventManager.h"
+#include "ThreadManager.h"
+#include "Console.h"
+#include <cmath>
 
 namespace tri {
 
 	TRI_SYSTEM_INSTANCE(Profiler, env->profiler);
 
-	thread_local Profiler::Node* Profiler::currentNode = nullptr;
-
-#if TRI_PROFILE_ENABLED
+	thread_local Profiler::ThreadBuffer* Profiler::currentBuffer = nullptr;
+	thread_local int Profiler::currentBufferGeneration = 0;
+	static thread_local std::string currentThreadName;
+	static std::atomic<int> nextGeneration = 1;
 
 	static uint64_t nowNano() {
 		return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::high_resolution_clock::now().time_since_epoch()).count();
@@ -30,82 +34,615 @@ namespace tri {
 		}
 	}
 
+	class StartupEvent {
+	public:
+		std::string category;
+		std::string name;
+		std::string threadName;
+		uint64_t beginTimeNano = 0;
+		uint64_t endTimeNano = 0;
+	};
+
+	//constant initialized, so that events can be recorded during the static initialization
+	static std::atomic<bool> startupFinished = false;
+	static std::mutex& getStartupMutex() {
+		static std::mutex mutex;
+		return mutex;
+	}
+	static std::vector<StartupEvent>& getStartupEvents() {
+		static std::vector<StartupEvent> events;
+		return events;
+	}
+
+	static std::string escapeJson(const std::string& str) {
+		std::string result;
+		result.reserve(str.size());
+		for (char c : str) {
+			if (c == '"' || c == '\\') {
+				result += '\\';
+				result += c;
+			}
+			else if ((unsigned char)c < 0x20) {
+				result += ' ';
+			}
+			else {
+				result += c;
+			}
+		}
+		return result;
+	}
+
 	Profiler::Node::~Node() {
 		nodes.clear();
 	}
 
 	void Profiler::init() {
+		generation = nextGeneration++;
+		recording = true;
+		root.name = "Frame";
+
 		env->eventManager->onClassUnregister.addListener([this](int classId) {
+			//process pending events while the names of the class are still valid
+			aggregate();
+			std::unique_lock<std::mutex> lock(treeMutex);
 			check(&root, Reflection::getDescriptor(classId)->name.c_str());
-			currentNode = &root;
+			eventNameIds.clear();
+			std::unique_lock<std::mutex> lock2(threadBufferMutex);
+			for (auto& buffer : threadBuffers) {
+				buffer->stack.clear();
+			}
+		});
+
+		env->console->addCVar<bool>("enableProfiler", &enabled);
+		env->console->addCVar<double>("profilerStatsWindow", &statsWindow);
+		env->console->addCVar<double>("profilerSpikeBudget", &spikeBudget);
+		env->console->addCVar<int>("profilerSpikeFrames", &spikeFrameCount);
+		env->console->addCVar<std::string>("profilerSpikeDirectory", &spikeDirectory);
+		env->console->addCVar<std::string>("startupTimelineFile", &startupTimelineFile);
+		env->eventManager->postStartup.addListener([this]() {
+			finishStartupTimeline();
+		});
+		env->console->addCommand("profilerStats", [&](auto& args) {
+			std::unique_lock<std::mutex> lock(treeMutex);
+			env->console->info("times in ms over the last %.1f seconds: p50 / p95 / p99 / max", statsWindow);
+			logStats(&root, args.size() > 0 ? args[0] : "", 0);
+		});
+		env->console->addCommand("profilerCapture", [&](auto& args) {
+			double seconds = 1;
+			std::string file = "profile.json";
+			try {
+				if (args.size() > 0) {
+					seconds = std::stod(args[0]);
+				}
+			}
+			catch (...) {
+				env->console->info("usage: profilerCapture <seconds> <file>");
+				return;
+			}
+			if (args.size() > 1) {
+				file = args[1];
+			}
+			capture(seconds, file);
+		});
+	}
+
+	void Profiler::startup() {
+		aggregationRunning = true;
+		aggregationFinished = false;
+		aggregationThreadId = env->threadManager->addThread("Profiler", [this]() {
+			while (aggregationRunning) {
+				std::this_thread::sleep_for(std::chrono::microseconds((long long)(aggregationInterval * 1000.0 * 1000.0)));
+				aggregate();
+			}
+			aggregationFinished = true;
 		});
-		currentNode = &root;
-		root.name = "Frame";
 	}
-	
+
 	void Profiler::shutdown() {
+		aggregationRunning = false;
+		if (aggregationThreadId != -1) {
+			env->threadManager->joinThread(aggregationThreadId);
+			env->threadManager->terminateThread(aggregationThreadId);
+			aggregationThreadId = -1;
+		}
+		while (!aggregationFinished) {
+			std::this_thread::yield();
+		}
+		if (capturing) {
+			writeCapture();
+		}
+
+		//threads still hold pointers to their buffers, later records must neither use them nor create new ones
+		recording = false;
+		generation = nextGeneration++;
+		std::unique_lock<std::mutex> lock(treeMutex);
 		root.nodes.clear();
-		root.times.clear();
+		std::unique_lock<std::mutex> lock2(threadBufferMutex);
+		threadBuffers.clear();
 	}
-	
+
 	void Profiler::nextFrame() {
-		end();
+		record(root.name, FRAME);
 	}
 
 	void Profiler::begin(const char* name) {
-		if (!currentNode) {
-			currentNode = &root;
+		record(name, BEGIN);
+	}
+
+	void Profiler::end() {
+		record(nullptr, END);
+	}
+
+	void Profiler::setThreadName(const std::string& name) {
+		currentThreadName = name;
+	}
+
+	void Profiler::capture(double seconds, const std::string& file) {
+		std::unique_lock<std::mutex> lock(treeMutex);
+		if (capturing) {
+			env->console->warning("profiler capture already in progress");
+			return;
 		}
-		std::unique_lock<std::mutex> lock(currentNode->mutex);
-		auto node = currentNode->nodes[name];
-		if (!node) {
-			node = std::make_shared<Node>();
-			node->parent = currentNode;
-			node->name = name;
-			currentNode->nodes[name] = node;
+		captureEvents.clear();
+		captureFile = file;
+		captureEndTimeNano = nowNano() + (uint64_t)(seconds * 1000.0 * 1000.0 * 1000.0);
+		capturing = true;
+		env->console->info("profiler capture started (%.2f seconds)", seconds);
+	}
+
+	bool Profiler::isCapturing() {
+		return capturing;
+	}
+
+	uint64_t Profiler::getDroppedEventCount() {
+		std::unique_lock<std::mutex> lock(threadBufferMutex);
+		uint64_t count = 0;
+		for (auto& buffer : threadBuffers) {
+			count += buffer->droppedCount;
 		}
-		node->beginTimeNano = nowNano();
-		currentNode = node.get();
+		return count;
 	}
 
-	void Profiler::end() {
-		uint64_t timeNano = nowNano();
+	Profiler::ThreadBuffer* Profiler::getThreadBuffer() {
+		if (currentBufferGeneration != generation) {
+			auto buffer = std::make_shared<ThreadBuffer>();
+			int size = 1;
+			while (size < eventBufferSize) {
+				size *= 2;
+			}
+			buffer->events.resize(size);
+			buffer->mask = size - 1;
+			buffer->threadName = currentThreadName.empty() ? "Main Thread" : currentThreadName;
 
-		if (currentNode->beginTimeNano != 0) {
-			double time = (double)(timeNano - currentNode->beginTimeNano) / 1000.0 / 1000.0 / 1000.0;
-			double total = currentNode->time * currentNode->times.size();
+			std::unique_lock<std::mutex> lock(threadBufferMutex);
+			buffer->threadIndex = (int)threadBuffers.size();
+			threadBuffers.push_back(buffer);
+			currentBuffer = buffer.get();
+			currentBufferGeneration = generation;
+		}
+		return currentBuffer;
+	}
 
-			while (total > keepTimeSeconds) {
-				total -= currentNode->times.front();
-				currentNode->times.erase(currentNode->times.begin());
+	void Profiler::record(const char* name, EventType type) {
+		if (this == nullptr || !enabled || !recording) {
+			return;
+		}
+		ThreadBuffer* buffer = getThreadBuffer();
+
+		//when the buffer is full, whole begin/end pairs are dropped to keep the nesting intact
+		if (buffer->droppedDepth > 0) {
+			if (type == BEGIN) {
+				buffer->droppedDepth++;
+				buffer->droppedCount.fetch_add(1, std::memory_order_relaxed);
+				return;
+			}
+			else if (type == END) {
+				buffer->droppedDepth--;
+				buffer->droppedCount.fetch_add(1, std::memory_order_relaxed);
+				return;
 			}
+		}
 
-			currentNode->times.push_back(time);
-			currentNode->time = (total + time) / (currentNode->times.size());
-			currentNode->beginTimeNano = 0;
+		uint64_t head = buffer->head.load(std::memory_order_relaxed);
+		if (head - buffer->tail.load(std::memory_order_acquire) > buffer->mask) {
+			if (type == BEGIN) {
+				buffer->droppedDepth++;
+			}
+			buffer->droppedCount.fetch_add(1, std::memory_order_relaxed);
+			return;
 		}
-		if (currentNode->parent) {
-			currentNode = currentNode->parent;
+
+		Event& event = buffer->events[head & buffer->mask];
+		event.name = name;
+		event.timeNano = nowNano();
+		event.type = type;
+		buffer->head.store(head + 1, std::memory_order_release);
+	}
+
+	void Profiler::aggregate() {
+		std::vector<std::shared_ptr<ThreadBuffer>> buffers;
+		{
+			std::unique_lock<std::mutex> lock(threadBufferMutex);
+			buffers = threadBuffers;
+		}
+
+		std::unique_lock<std::mutex> lock(treeMutex);
+		aggregationPass++;
+		for (auto& buffer : buffers) {
+			uint64_t head = buffer->head.load(std::memory_order_acquire);
+			uint64_t tail = buffer->tail.load(std::memory_order_relaxed);
+			for (; tail < head; tail++) {
+				processEvent(buffer.get(), buffer->events[tail & buffer->mask]);
+			}
+			buffer->tail.store(tail, std::memory_order_release);
 		}
-		else {
-			currentNode->beginTimeNano = timeNano;
+
+		uint64_t time = nowNano();
+		if (lastAverageTimeNano == 0) {
+			lastAverageTimeNano = time;
+		}
+		if ((double)(time - lastAverageTimeNano) / 1000.0 / 1000.0 / 1000.0 >= keepTimeSeconds) {
+			lastAverageTimeNano = time;
+			updateAverages(&root, time);
+		}
+
+		if (capturing && time >= captureEndTimeNano) {
+			writeCapture();
+		}
+
+		//events of other threads belonging to the spike frame are guaranteed to be drained one pass after detection
+		if (pendingSpikeEndNano != 0 && aggregationPass > pendingSpikePass) {
+			writeSpike();
+		}
+
+		bool unreferenced = captureEvents.empty() && frameHistory.empty();
+		if ((unreferenced && !eventNames.empty()) || eventNames.size() >= eventNameLimit) {
+			compactEventNames();
 		}
 	}
 
-#else
-	Profiler::Node::~Node() {
-		nodes.clear();
+	void Profiler::processEvent(ThreadBuffer* buffer, const Event& event) {
+		if (capturing) {
+			captureEvents.push_back(toCaptureEvent(buffer, event));
+		}
+		if (spikeBudget > 0) {
+			frameHistory.push_back(toCaptureEvent(buffer, event));
+		}
+
+		if (event.type == BEGIN) {
+			Node* parent = buffer->stack.empty() ? &root : buffer->stack.back().first;
+			auto& node = parent->nodes[event.name];
+			if (!node) {
+				node = std::make_shared<Node>();
+				node->name = event.name;
+			}
+			buffer->stack.push_back({ node.get(), event.timeNano });
+		}
+		else if (event.type == END) {
+			if (!buffer->stack.empty()) {
+				auto& entry = buffer->stack.back();
+				addTime(entry.first, event.timeNano - entry.second, event.timeNano);
+				buffer->stack.pop_back();
+			}
+		}
+		else if (event.type == FRAME) {
+			if (lastFrameTimeNano != 0) {
+				addTime(&root, event.timeNano - lastFrameTimeNano, event.timeNano);
+				onFrameEnd(event.timeNano, event.timeNano - lastFrameTimeNano);
+			}
+			lastFrameTimeNano = event.timeNano;
+		}
 	}
-	void Profiler::init() {
-		currentNode = &root;
-		root.name = "Frame";
+
+	void Profiler::addTime(Node* node, uint64_t durationNano, uint64_t endTimeNano) {
+		double seconds = (double)durationNano / 1000.0 / 1000.0 / 1000.0;
+		node->timeSum += seconds;
+		node->timeCount++;
+		node->totalTime += seconds;
+		node->totalCount++;
+		node->samples.push_back({ endTimeNano, (float)seconds });
 	}
-	void Profiler::shutdown() {}
-	void Profiler::nextFrame() {}
-	void Profiler::begin(const char* name) {}
-	void Profiler::end() {}
-#endif
-}
 
+	void Profiler::updateAverages(Node* node, uint64_t timeNano) {
+		if (node->timeCount > 0) {
+			node->time = node->timeSum / node->timeCount;
+		}
+		node->timeSum = 0;
+		node->timeCount = 0;
 
+		uint64_t windowNano = (uint64_t)(std::max(statsWindow, 0.0) * 1000.0 * 1000.0 * 1000.0);
+		int expired = 0;
+		while (expired < node->samples.size() && node->samples[expired].first + windowNano < timeNano) {
+			expired++;
+		}
+		node->samples.erase(node->samples.begin(), node->samples.begin() + expired);
 
+		percentileScratch.clear();
+		for (auto& sample : node->samples) {
+			percentileScratch.push_back(sample.second);
+		}
+		node->stats = Stats();
+		node->stats.count = (int)percentileScratch.size();
+		node->stats.totalTime = node->totalTime;
+		node->stats.totalCount = node->totalCount;
+		if (!percentileScratch.empty()) {
+			std::sort(percentileScratch.begin(), percentileScratch.end());
+			auto percentile = [&](double p) {
+				int index = (int)std::ceil(p * percentileScratch.size()) - 1;
+				return (double)percentileScratch[std::clamp(index, 0, (int)percentileScratch.size() - 1)];
+			};
+			node->stats.p50 = percentile(0.50);
+			node->stats.p95 = percentile(0.95);
+			node->stats.p99 = percentile(0.99);
+			node->stats.max = percentileScratch.back();
+		}
+
+		for (auto& n : node->nodes) {
+			if (n.second) {
+				updateAverages(n.second.get(), timeNano);
+			}
+		}
+	}
+
+	Profiler::CaptureEvent Profiler::toCaptureEvent(ThreadBuffer* buffer, const Event& event) {
+		CaptureEvent captureEvent;
+		captureEvent.nameIndex = -1;
+		captureEvent.threadIndex = buffer->threadIndex;
+		captureEvent.timeNano = event.timeNano;
+		captureEvent.type = event.type;
+		if (event.name) {
+			auto entry = eventNameIds.find(event.name);
+			if (entry != eventNameIds.end()) {
+				captureEvent.nameIndex = entry->second;
+			}
+			else {
+				captureEvent.nameIndex = (int)eventNames.size();
+				eventNames.push_back(event.name);
+				eventNameIds[event.name] = captureEvent.nameIndex;
+			}
+		}
+		return captureEvent;
+	}
+
+	void Profiler::onFrameEnd(uint64_t timeNano, uint64_t frameTimeNano) {
+		frameNumber++;
+		if (spikeBudget <= 0) {
+			frameHistory.clear();
+			frameStartTimes.clear();
+			return;
+		}
+
+		//the start times of the current and the preceding frames
+		frameStartTimes.push_back(timeNano - frameTimeNano);
+		while (frameStartTimes.size() > std::max(spikeFrameCount, 0) + 1) {
+			frameStartTimes.erase(frameStartTimes.begin());
+		}
+
+		if (pendingSpikeEndNano == 0) {
+			double frameTimeMs = (double)frameTimeNano / 1000.0 / 1000.0;
+			if (frameTimeMs > spikeBudget) {
+				pendingSpikeBeginNano = frameStartTimes.front();
+				pendingSpikeEndNano = timeNano;
+				pendingSpikeFrame = frameNumber;
+				pendingSpikePass = aggregationPass;
+			}
+			else {
+				uint64_t cutoff = frameStartTimes.front();
+				frameHistory.erase(std::remove_if(frameHistory.begin(), frameHistory.end(), [&](const CaptureEvent& event) {
+					return event.timeNano < cutoff;
+				}), frameHistory.end());
+			}
+		}
+	}
+
+	void Profiler::writeCapture() {
+		capturing = false;
+		if (writeChromeTrace(captureFile, captureEvents, 0, -1)) {
+			env->console->info("profiler capture written to \"%s\" (%i events)", captureFile.c_str(), (int)captureEvents.size());
+		}
+		captureEvents.clear();
+	}
+
+	void Profiler::compactEventNames() {
+		std::vector<int> remap(eventNames.size(), -1);
+		std::vector<std::string> names;
+		auto keep = [&](CaptureEvent& event) {
+			if (event.nameIndex >= 0) {
+				int& index = remap[event.nameIndex];
+				if (index == -1) {
+					index = (int)names.size();
+					names.push_back(std::move(eventNames[event.nameIndex]));
+				}
+				event.nameIndex = index;
+			}
+		};
+		for (auto& event : captureEvents) {
+			keep(event);
+		}
+		for (auto& event : frameHistory) {
+			keep(event);
+		}
+
+		std::unordered_map<const char*, int> ids;
+		for (auto& [name, index] : eventNameIds) {
+			if (remap[index] != -1) {
+				ids[name] = remap[index];
+			}
+		}
+		eventNames.swap(names);
+		eventNameIds.swap(ids);
+		eventNameLimit = std::max(4096, (int)eventNames.size() * 2);
+	}
+
+	void Profiler::writeSpike() {
+		std::string file = spikeDirectory + "/spike_" + std::to_string(pendingSpikeFrame) + ".json";
+		try {
+			std::filesystem::create_directories(spikeDirectory);
+		}
+		catch (...) {}
+		if (writeChromeTrace(file, frameHistory, pendingSpikeBeginNano, pendingSpikeEndNano)) {
+			env->console->warning("frame %i exceeded the budget of %.2f ms, timeline written to \"%s\"", (int)pendingSpikeFrame, spikeBudget, file.c_str());
+		}
+		pendingSpikeBeginNano = 0;
+		pendingSpikeEndNano = 0;
+		frameHistory.clear();
+	}
+
+	bool Profiler::writeChromeTrace(const std::string& file, const std::vector<CaptureEvent>& events, uint64_t beginTimeNano, uint64_t endTimeNano) {
+		std::ofstream stream(file);
+		if (!stream.is_open()) {
+			env->console->warning("could not write profiler trace to \"%s\"", file.c_str());
+			return false;
+		}
+
+		uint64_t startTimeNano = -1;
+		for (auto& event : events) {
+			if (event.timeNano >= beginTimeNano && event.timeNano <= endTimeNano) {
+				startTimeNano = std::min(startTimeNano, event.timeNano);
+			}
+		}
+
+		stream << "{\"traceEvents\":[\n";
+		bool first = true;
+		std::vector<int> depth;
+		{
+			std::unique_lock<std::mutex> lock(threadBufferMutex);
+			depth.resize(threadBuffers.size());
+			for (auto& buffer : threadBuffers) {
+				stream << (first ? "" : ",\n");
+				stream << "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":" << buffer->threadIndex;
+				stream << ",\"args\":{\"name\":\"" << escapeJson(buffer->threadName) << "\"}}";
+				first = false;
+			}
+		}
+
+		char timeBuffer[32];
+		for (auto& event : events) {
+			if (event.timeNano < beginTimeNano || event.timeNano > endTimeNano) {
+				continue;
+			}
+			if (event.threadIndex >= depth.size()) {
+				depth.resize(event.threadIndex + 1);
+			}
+			if (event.type == BEGIN) {
+				depth[event.threadIndex]++;
+			}
+			else if (event.type == END) {
+				//ignore ends of scopes that began before the recorded time range
+				if (depth[event.threadIndex] <= 0) {
+					continue;
+				}
+				depth[event.threadIndex]--;
+			}
+
+			snprintf(timeBuffer, sizeof(timeBuffer), "%.3f", (double)(event.timeNano - startTimeNano) / 1000.0);
+			stream << (first ? "" : ",\n");
+			first = false;
+			if (event.type == BEGIN) {
+				stream << "{\"name\":\"" << escapeJson(eventNames[event.nameIndex]) << "\",\"ph\":\"B\"";
+			}
+			else if (event.type == END) {
+				stream << "{\"ph\":\"E\"";
+			}
+			else {
+				stream << "{\"name\":\"" << root.name << "\",\"ph\":\"i\",\"s\":\"g\"";
+			}
+			stream << ",\"ts\":" << timeBuffer << ",\"pid\":1,\"tid\":" << event.threadIndex << "}";
+		}
+		stream << "\n]}\n";
+		return true;
+	}
+
+	void Profiler::addStartupEvent(const std::string& category, const std::string& name, uint64_t beginTimeNano, uint64_t endTimeNano) {
+		if (startupFinished) {
+			return;
+		}
+		std::unique_lock<std::mutex> lock(getStartupMutex());
+		StartupEvent event;
+		event.category = category;
+		event.name = name;
+		event.threadName = currentThreadName.empty() ? "Main" : currentThreadName;
+		event.beginTimeNano = beginTimeNano;
+		event.endTimeNano = endTimeNano;
+		getStartupEvents().push_back(event);
+	}
+
+	bool Profiler::isStartupFinished() {
+		return startupFinished;
+	}
+
+	uint64_t Profiler::getTimeNano() {
+		return nowNano();
+	}
+
+	void Profiler::finishStartupTimeline() {
+		if (startupFinished.exchange(true)) {
+			return;
+		}
+		std::vector<StartupEvent> events;
+		{
+			std::unique_lock<std::mutex> lock(getStartupMutex());
+			events.swap(getStartupEvents());
+		}
+		if (events.empty()) {
+			return;
+		}
+		std::sort(events.begin(), events.end(), [](auto& a, auto& b) {
+			return a.beginTimeNano < b.beginTimeNano;
+		});
+
+		uint64_t beginTimeNano = events.front().beginTimeNano;
+		uint64_t endTimeNano = beginTimeNano;
+		for (auto& event : events) {
+			endTimeNano = std::max(endTimeNano, event.endTimeNano);
+		}
+		env->console->info("startup timeline (%.1f ms):", (endTimeNano - beginTimeNano) / 1000000.0);
+		for (auto& event : events) {
+			env->console->info("  %8.1f ms %8.1f ms  %s %s (%s)", (event.beginTimeNano - beginTimeNano) / 1000000.0,
+				(event.endTimeNano - event.beginTimeNano) / 1000000.0, event.category.c_str(), event.name.c_str(), event.threadName.c_str());
+		}
+
+		if (startupTimelineFile.empty()) {
+			return;
+		}
+		std::ofstream stream(startupTimelineFile);
+		if (!stream.is_open()) {
+			env->console->warning("could not write startup timeline to \"%s\"", startupTimelineFile.c_str());
+			return;
+		}
+		std::unordered_map<std::string, int> threadIds;
+		stream << "{\"traceEvents\":[\n";
+		bool first = true;
+		char timeBuffer[64];
+		for (auto& event : events) {
+			auto thread = threadIds.find(event.threadName);
+			if (thread == threadIds.end()) {
+				thread = threadIds.insert({ event.threadName, (int)threadIds.size() }).first;
+				stream << (first ? "" : ",\n");
+				stream << "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":" << thread->second;
+				stream << ",\"args\":{\"name\":\"" << escapeJson(event.threadName) << "\"}}";
+				first = false;
+			}
+			snprintf(timeBuffer, sizeof(timeBuffer), "\"ts\":%.3f,\"dur\":%.3f", (event.beginTimeNano - beginTimeNano) / 1000.0, (event.endTimeNano - event.beginTimeNano) / 1000.0);
+			stream << (first ? "" : ",\n");
+			stream << "{\"name\":\"" << escapeJson(event.name) << "\",\"cat\":\"" << escapeJson(event.category) << "\",\"ph\":\"X\"," << timeBuffer;
+			stream << ",\"pid\":1,\"tid\":" << thread->second << "}";
+			first = false;
+		}
+		stream << "\n]}\n";
+		env->console->info("startup timeline written to \"%s\"", startupTimelineFile.c_str());
+	}
+
+	void Profiler::logStats(Node* node, const std::string& filter, int depth) {
+		if (filter.empty() || std::string(node->name).find(filter) != std::string::npos) {
+			env->console->info("%s%s: %.3f / %.3f / %.3f / %.3f (%i samples)", std::string(depth * 2, ' ').c_str(), node->name,
+				node->stats.p50 * 1000.0, node->stats.p95 * 1000.0, node->stats.p99 * 1000.0, node->stats.max * 1000.0, node->stats.count);
+		}
+		for (auto& n : node->nodes) {
+			if (n.second) {
+				logStats(n.second.get(), filter, depth + 1);
+			}
+		}
+	}
+
+}
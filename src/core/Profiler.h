@@ -6,38 +6,193 @@
 
 #include "System.h"
 #include "tracy/Tracy.hpp"
+#include <atomic>
 
 namespace tri {
 
 	class Profiler : public System {
 	public:
-		virtual void init();
-		virtual void shutdown();
+		bool enabled = true;
+		//number of events per thread that can be buffered until they are aggregated (power of two)
+		int eventBufferSize = 1 << 16;
+		//seconds between two aggregations of the thread buffers
+		double aggregationInterval = 0.01;
+		//time window in seconds for the percentile statistics
+		double statsWindow = 10;
+		//frames exceeding this time in milliseconds are written to disk together with the preceding frames (0 = disabled)
+		double spikeBudget = 0;
+		int spikeFrameCount = 10;
+		std::string spikeDirectory = "spikes";
+		//chrome trace file for the startup timeline, empty to only log the timeline
+		std::string startupTimelineFile = "";
+
+		virtual void init() override;
+		virtual void startup() override;
+		virtual void shutdown() override;
 		void nextFrame();
 		void begin(const char *name);
 		void end();
 
+		//name used for the event buffer of the calling thread
+		static void setThreadName(const std::string& name);
+
+		//records all events for the given duration and writes them as a chrome trace file (also readable by perfetto)
+		void capture(double seconds, const std::string& file);
+		bool isCapturing();
+		uint64_t getDroppedEventCount();
+
+		//records a time span of the startup (module loads, system init and startup), works before the profiler exists
+		//the timeline is logged and written after the startup and recording stops
+		static void addStartupEvent(const std::string& category, const std::string& name, uint64_t beginTimeNano, uint64_t endTimeNano);
+		static bool isStartupFinished();
+		static uint64_t getTimeNano();
+
+		class Stats {
+		public:
+			double p50 = 0;
+			double p95 = 0;
+			double p99 = 0;
+			double max = 0;
+			int count = 0;
+			//sum and count of all samples since the start, not only of the stats window
+			double totalTime = 0;
+			int64_t totalCount = 0;
+		};
+
 		class Node {
 		public:
 			double time = 0;
 			double displayTime = 0;
+			Stats stats;
+			Stats displayStats;
 			const char *name = nullptr;
 			std::unordered_map<const char *, std::shared_ptr<Node>> nodes;
-			std::mutex mutex;
 
 			~Node();
 		private:
 			friend class Profiler;
-			uint64_t beginTimeNano = 0;
-			std::vector<double> times;
-			Node* parent;
+			double timeSum = 0;
+			int timeCount = 0;
+			double totalTime = 0;
+			int64_t totalCount = 0;
+			//end time and duration of all samples in the stats window
+			std::vector<std::pair<uint64_t, float>> samples;
 		};
 		Node* getRoot() { return &root; }
+		//the node tree is written by the aggregation thread and has to be locked while reading
+		std::mutex& getTreeMutex() { return treeMutex; }
 
 	private:
+		enum EventType : uint8_t {
+			BEGIN,
+			END,
+			FRAME,
+		};
+
+		class Event {
+		public:
+			const char* name;
+			uint64_t timeNano;
+			EventType type;
+		};
+
+		//single producer (the owning thread) single consumer (the aggregation thread) ring buffer
+		class ThreadBuffer {
+		public:
+			std::vector<Event> events;
+			uint64_t mask = 0;
+			std::atomic<uint64_t> head = 0;
+			std::atomic<uint64_t> tail = 0;
+			std::atomic<uint64_t> droppedCount = 0;
+			int droppedDepth = 0;
+			int threadIndex = 0;
+			std::string threadName;
+
+			//aggregation state
+			std::vector<std::pair<Node*, uint64_t>> stack;
+		};
+
+		class CaptureEvent {
+		public:
+			int nameIndex;
+			int threadIndex;
+			uint64_t timeNano;
+			EventType type;
+		};
+
 		Node root;
 		double keepTimeSeconds = 1;
-		static thread_local Node* currentNode;
+		uint64_t lastFrameTimeNano = 0;
+		uint64_t lastAverageTimeNano = 0;
+		std::mutex treeMutex;
+
+		std::atomic<int> generation = 0;
+		//turned off at shutdown before the thread buffers are freed
+		std::atomic<bool> recording = false;
+		std::vector<std::shared_ptr<ThreadBuffer>> threadBuffers;
+		std::mutex threadBufferMutex;
+		static thread_local ThreadBuffer* currentBuffer;
+		static thread_local int currentBufferGeneration;
+
+		int aggregationThreadId = -1;
+		std::atomic<bool> aggregationRunning = false;
+		std::atomic<bool> aggregationFinished = true;
+
+		std::atomic<bool> capturing = false;
+		uint64_t captureEndTimeNano = 0;
+		std::string captureFile;
+		std::vector<CaptureEvent> captureEvents;
+		std::vector<std::string> eventNames;
+		std::unordered_map<const char*, int> eventNameIds;
+		//the names are compacted when they reach this size, names of unloaded modules would otherwise stay forever
+		int eventNameLimit = 4096;
+
+		//events of the last frames for the spike capture
+		std::vector<CaptureEvent> frameHistory;
+		std::vector<uint64_t> frameStartTimes;
+		uint64_t frameNumber = 0;
+		uint64_t pendingSpikeBeginNano = 0;
+		uint64_t pendingSpikeEndNano = 0;
+		uint64_t pendingSpikeFrame = 0;
+		uint64_t pendingSpikePass = 0;
+		uint64_t aggregationPass = 0;
+		std::vector<float> percentileScratch;
+
+		ThreadBuffer* getThreadBuffer();
+		void record(const char* name, EventType type);
+		void aggregate();
+		void processEvent(ThreadBuffer* buffer, const Event& event);
+		void addTime(Node* node, uint64_t durationNano, uint64_t endTimeNano);
+		void updateAverages(Node* node, uint64_t timeNano);
+		CaptureEvent toCaptureEvent(ThreadBuffer* buffer, const Event& event);
+		void onFrameEnd(uint64_t timeNano, uint64_t frameTimeNano);
+		void writeCapture();
+		void writeSpike();
+		bool writeChromeTrace(const std::string& file, const std::vector<CaptureEvent>& events, uint64_t beginTimeNano, uint64_t endTimeNano);
+		void logStats(Node* node, const std::string& filter, int depth);
+		//removes the names that are not referenced by the capture and the spike history anymore
+		void compactEventNames();
+		void finishStartupTimeline();
+	};
+
+	//adds the lifetime of the object to the startup timeline
+	class StartupTimer {
+	public:
+		StartupTimer(const char* category, const std::string& name) : category(category) {
+			if (!Profiler::isStartupFinished()) {
+				this->name = name;
+				beginTimeNano = Profiler::getTimeNano();
+			}
+		}
+		~StartupTimer() {
+			if (beginTimeNano != 0) {
+				Profiler::addStartupEvent(category, name, beginTimeNano, Profiler::getTimeNano());
+			}
+		}
+	private:
+		const char* category;
+		std::string name;
+		uint64_t beginTimeNano = 0;
 	};
 
 }
@@ -56,4 +211,4 @@ namespace tri {
 #define TRI_PROFILE_THREAD(name)
 #define TRI_PROFILE_INFO(text, size)
 #define TRI_PROFILE_FRAME
-#endif
\ No newline at end of file
+#endif
@@ -14,9 +14,29 @@ namespace tri {
 		return descriptors;
 	}
 
-	std::map<std::string, ClassDescriptor*>& Reflection::getDescriptorsByNameImpl() {
-		static std::map<std::string, ClassDescriptor*> descriptorsByName;
-		return descriptorsByName;
+	std::unordered_map<uint64_t, ClassDescriptor*>& Reflection::getDescriptorsByHashImpl() {
+		static std::unordered_map<uint64_t, ClassDescriptor*> descriptorsByHash;
+		return descriptorsByHash;
+	}
+
+	void Reflection::addNameHash(ClassDescriptor* desc) {
+		desc->nameHash = hashName(desc->name);
+		auto& descriptors = getDescriptorsByHashImpl();
+		auto entry = descriptors.find(desc->nameHash);
+		if (entry != descriptors.end() && entry->second != desc && entry->second->name != desc->name) {
+			if (env && env->console) {
+				env->console->error("name hash collision between the classes \"%s\" and \"%s\"", entry->second->name.c_str(), desc->name.c_str());
+			}
+		}
+		descriptors[desc->nameHash] = desc;
+	}
+
+	void Reflection::removeNameHash(ClassDescriptor* desc) {
+		auto& descriptors = getDescriptorsByHashImpl();
+		auto entry = descriptors.find(desc->nameHash);
+		if (entry != descriptors.end() && entry->second == desc) {
+			descriptors.erase(entry);
+		}
 	}
 
 	void Reflection::onClassRegister(int classId) {
@@ -29,6 +49,66 @@ namespace tri {
 		}
 	}
 
+	class FieldLayoutCache {
+	public:
+		std::unordered_map<uint64_t, std::unique_ptr<FieldLayout>> layouts;
+		//layouts that are currently build, used for vectors that contain their own class
+		std::unordered_set<uint64_t> building;
+		std::recursive_mutex mutex;
+	};
+
+	static FieldLayoutCache& getFieldLayoutCache() {
+		static FieldLayoutCache cache;
+		return cache;
+	}
+
+	static uint64_t getFieldLayoutKey(int classId, int fieldClassId) {
+		return ((uint64_t)(uint32_t)classId << 32) | (uint32_t)fieldClassId;
+	}
+
+	static void buildFieldLayout(const ClassDescriptor* desc, int fieldClassId, int offset, FieldLayout& layout) {
+		if (!desc) {
+			return;
+		}
+		if (desc->classId == fieldClassId) {
+			layout.offsets.push_back(offset);
+			return;
+		}
+		if ((desc->flags & ClassDescriptor::VECTOR) && desc->elementType) {
+			const FieldLayout& elementLayout = Reflection::getFieldLayout(desc->elementType->classId, fieldClassId);
+			if (!elementLayout.empty() || getFieldLayoutCache().building.contains(getFieldLayoutKey(desc->elementType->classId, fieldClassId))) {
+				layout.vectors.push_back({ offset, desc, &elementLayout });
+			}
+		}
+		for (auto& prop : desc->properties) {
+			buildFieldLayout(prop.type, fieldClassId, offset + prop.offset, layout);
+		}
+	}
+
+	const FieldLayout& Reflection::getFieldLayout(int classId, int fieldClassId) {
+		auto& cache = getFieldLayoutCache();
+		std::unique_lock<std::recursive_mutex> lock(cache.mutex);
+		uint64_t key = getFieldLayoutKey(classId, fieldClassId);
+		auto entry = cache.layouts.find(key);
+		if (entry != cache.layouts.end()) {
+			return *entry->second;
+		}
+
+		//the layout is added before it is build, so that recursive vectors can refer to it
+		FieldLayout* layout = new FieldLayout();
+		cache.layouts[key].reset(layout);
+		cache.building.insert(key);
+		buildFieldLayout(getDescriptor(classId), fieldClassId, 0, *layout);
+		cache.building.erase(key);
+		return *layout;
+	}
+
+	void Reflection::invalidateFieldLayouts() {
+		auto& cache = getFieldLayoutCache();
+		std::unique_lock<std::recursive_mutex> lock(cache.mutex);
+		cache.layouts.clear();
+	}
+
 	void Reflection::handleDuplicatedClass(ClassDescriptor* desc, void* address1, void* address2) {
 		std::string name1 = ModuleManager::getModuleNameByAddress(address1);
 		std::string name2 = ModuleManager::getModuleNameByAddress(address2);
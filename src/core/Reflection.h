@@ -9,6 +9,16 @@
 
 namespace tri {
 
+	//64 bit FNV-1a hash of a class or property name, stable across modules and builds
+	constexpr uint64_t hashName(std::string_view name) {
+		uint64_t hash = 14695981039346656037ull;
+		for (char c : name) {
+			hash ^= (uint8_t)c;
+			hash *= 1099511628211ull;
+		}
+		return hash;
+	}
+
 	class ClassDescriptor;
 
 	class PropertyDescriptor {
@@ -21,6 +31,7 @@ namespace tri {
 		};
 
 		std::string name;
+		uint64_t nameHash;
 		ClassDescriptor* type;
 		int offset;
 		void* min;
@@ -53,6 +64,7 @@ namespace tri {
 
 		int classId;
 		std::string name;
+		uint64_t nameHash;
 		std::string category;
 		int size;
 		size_t hashCode;
@@ -68,6 +80,16 @@ namespace tri {
 			return hashCode == typeid(T).hash_code();
 		}
 
+		//index of the property with the name hash, -1 if not found
+		int getPropertyIndex(uint64_t propertyNameHash) const {
+			for (int i = 0; i < properties.size(); i++) {
+				if (properties[i].nameHash == propertyNameHash) {
+					return i;
+				}
+			}
+			return -1;
+		}
+
 		virtual void construct(void* ptr) const = 0;
 		virtual void destruct(void* ptr) const = 0;
 		virtual void* alloc() const = 0;
@@ -94,6 +116,44 @@ namespace tri {
 		bool wasRegisterCallbackInvoked = false;
 	};
 
+	//flattened offsets of all fields of one type inside of a class
+	//fields of nested classes are resolved, vectors are listed with the layout of their elements
+	class FieldLayout {
+	public:
+		class Vector {
+		public:
+			int offset;
+			const ClassDescriptor* type;
+			const FieldLayout* elementLayout;
+		};
+		std::vector<int> offsets;
+		std::vector<Vector> vectors;
+
+		bool empty() const {
+			return offsets.empty() && vectors.empty();
+		}
+
+		//invokes the callback with a pointer to every field inside of the object
+		template<typename Func>
+		void each(void* object, Func callback) const {
+			for (int offset : offsets) {
+				callback((uint8_t*)object + offset);
+			}
+			for (auto& vector : vectors) {
+				void* ptr = (uint8_t*)object + vector.offset;
+				int size = vector.type->vectorSize(ptr);
+				if (size > 0) {
+					//the elements of a std::vector are stored contiguous
+					uint8_t* data = (uint8_t*)vector.type->vectorGet(ptr, 0);
+					int stride = vector.type->elementType->size;
+					for (int i = 0; i < size; i++) {
+						vector.elementLayout->each(data + i * stride, callback);
+					}
+				}
+			}
+		}
+	};
+
 	namespace impl {
 		template<class T, class U, class> struct has_equal_impl : std::false_type {};
 		template<class T, class U> struct has_equal_impl<T, U, decltype((bool)(std::declval<T>() == std::declval<U>()), void())> : std::true_type {};
@@ -117,8 +177,17 @@ namespace tri {
 		}
 		
 		static const ClassDescriptor* getDescriptor(const std::string &name) {
-			auto entry = getDescriptorsByNameImpl().find(name);
-			if (entry != getDescriptorsByNameImpl().end()) {
+			auto* desc = getDescriptorByHash(hashName(name));
+			if (desc && desc->name == name) {
+				return desc;
+			}
+			return nullptr;
+		}
+
+		//lookup by the hash of the class name, see hashName
+		static const ClassDescriptor* getDescriptorByHash(uint64_t nameHash) {
+			auto entry = getDescriptorsByHashImpl().find(nameHash);
+			if (entry != getDescriptorsByHashImpl().end()) {
 				return entry->second;
 			}
 			else {
@@ -137,6 +206,14 @@ namespace tri {
 			return classId;
 		}
 
+		//layout of the fields of the type inside of the class
+		//computed on first use and cached until classes or properties are registered or unregistered
+		static const FieldLayout& getFieldLayout(int classId, int fieldClassId);
+		template<typename FieldType>
+		static const FieldLayout& getFieldLayout(int classId) {
+			return getFieldLayout(classId, getClassId<FieldType>());
+		}
+
 		template<typename ClassType>
 		static void registerClass(const std::string &name, ClassDescriptor::Flags flags = ClassDescriptor::NONE, const std::string& category = "") {
 			registerClassImpl<ClassType>(name, flags, category);
@@ -160,12 +237,14 @@ namespace tri {
 
 			PropertyDescriptor prop;
 			prop.name = name;
+			prop.nameHash = hashName(name);
 			prop.type = getDescriptorsImpl()[getClassId<PropertyType>()];
 			prop.offset = offset;
 			prop.flags = flags;
 			prop.min = nullptr;
 			prop.max = nullptr;
 			desc->properties.push_back(prop);
+			invalidateFieldLayouts();
 
 			if (flags & PropertyDescriptor::REPLICATE) {
 				desc->flags = (ClassDescriptor::Flags)(desc->flags | ClassDescriptor::REPLICATE);
@@ -238,6 +317,7 @@ namespace tri {
 		}
 
 		static void unregisterClass(int classId, bool invokeEvent = true) {
+			invalidateFieldLayouts();
 			for (auto& desc : getDescriptorsImpl()) {
 				if (desc) {
 					if (desc->elementType && desc->elementType->classId == classId) {
@@ -253,7 +333,7 @@ namespace tri {
 			
 			auto *desc = getDescriptorsImpl()[classId];
 			if (desc) {
-				getDescriptorsByNameImpl().erase(desc->name);
+				removeNameHash(desc);
 				if (invokeEvent) {
 					onClassUnregister(desc->classId);
 				}
@@ -268,6 +348,7 @@ namespace tri {
 		template<typename ClassType>
 		static void convertToStubClass(int classId) {
 			ClassDescriptor* stub = new ClassDescriptorT<ClassType>();
+			invalidateFieldLayouts();
 
 			for (auto& desc : getDescriptorsImpl()) {
 				if (desc) {
@@ -285,6 +366,7 @@ namespace tri {
 			auto* desc = getDescriptorsImpl()[classId];
 			stub->classId = desc->classId;
 			stub->name = desc->name;
+			stub->nameHash = desc->nameHash;
 			stub->size = sizeof(ClassType);
 			stub->category = desc->category;
 			stub->hashCode = desc->hashCode;
@@ -292,6 +374,9 @@ namespace tri {
 			stub->registrationSourceAddress = desc->registrationSourceAddress;
 
 			getDescriptorsImpl()[classId] = stub;
+			if (getDescriptorByHash(stub->nameHash) == desc) {
+				getDescriptorsByHashImpl()[stub->nameHash] = stub;
+			}
 			delete desc;
 		}
 
@@ -443,19 +528,22 @@ namespace tri {
 		};
 
 		static std::vector<ClassDescriptor*>& getDescriptorsImpl();
-		static std::map<std::string, ClassDescriptor*>& getDescriptorsByNameImpl();
+		static std::unordered_map<uint64_t, ClassDescriptor*>& getDescriptorsByHashImpl();
 
 		static void handleDuplicatedClass(ClassDescriptor *desc, void *address1, void *address2);
+		static void addNameHash(ClassDescriptor* desc);
+		static void removeNameHash(ClassDescriptor* desc);
 		static void onClassRegister(int classId);
 		static void onClassUnregister(int classId);
+		static void invalidateFieldLayouts();
 
 		template<typename ClassType>
 		static void registerClassImpl(const std::string& name, ClassDescriptor::Flags flags = ClassDescriptor::NONE, const std::string& category = "") {
 			registerClassId<ClassType>(true);
 			auto* desc = getDescriptorsImpl()[getClassId<ClassType>()];
-			getDescriptorsByNameImpl().erase(desc->name);
+			removeNameHash(desc);
 			desc->name = name;
-			getDescriptorsByNameImpl()[desc->name] = desc;
+			addNameHash(desc);
 			desc->category = category;
 			desc->flags = (ClassDescriptor::Flags)((int)desc->flags | (int)flags);
 			if (!desc->wasRegisterCallbackInvoked) {
@@ -503,10 +591,11 @@ namespace tri {
 			desc->size = sizeof(T);
 			desc->classId = classId;
 			desc->name = typeid(T).name();
-			getDescriptorsByNameImpl()[desc->name] = desc;
+			addNameHash(desc);
 
 			desc->registrationSourceAddress = registrationSourceAddress;
 			desc->wasRegisteredExplicit = explicitRegistration;
+			invalidateFieldLayouts();
 
 			if (classId < descriptors.size()) {
 				descriptors[classId] = desc;
@@ -29,6 +29,7 @@ namespace tri {
 		if (handle.system == nullptr) {
 			handle.name = Reflection::getDescriptor(classId)->name;
 			TRI_PROFILE_NAME(handle.name.c_str(), handle.name.size());
+			StartupTimer timer("init", handle.name);
 			handle.system = (System*)Reflection::getDescriptor(classId)->alloc();
 			handle.system->init();
 			handle.wasInit = true;
@@ -6,23 +6,76 @@
 #include "Environment.h"
 #include "Reflection.h"
 #include "Profiler.h"
+#include "Console.h"
+#include "EventManager.h"
+#include "util/StrUtil.h"
+
+#if TRI_LINUX
+#include <sched.h>
+#include <unistd.h>
+#include <sys/resource.h>
+#include <sys/syscall.h>
+#elif TRI_WINDOWS
+#include <windows.h>
+#endif
 
 namespace tri {
 
 	TRI_SYSTEM_INSTANCE(ThreadManager, env->threadManager);
 
+	//id and node of the worker running on the calling thread
+	static thread_local int currentThreadId = -1;
+	static thread_local int currentWorkerNode = -1;
+
 	void ThreadManager::init() {
 		threadMutex = std::make_shared<std::mutex>();
 		taskMutex = std::make_shared<std::mutex>();
 		taskCondition = std::make_shared<std::condition_variable>();
+		detectTopology();
+
+		env->console->addCVar<bool>("numaAwareWorkers", &numaAwareWorkers);
+		env->console->addCommand("setThreadAffinity", [&](auto& args) {
+			if (args.size() > 0) {
+				setThreadAffinity(args[0], args.size() > 1 ? args[1] : "");
+			}
+		});
+		env->console->addCommand("setThreadPriority", [&](auto& args) {
+			if (args.size() > 1) {
+				static const char* names[] = { "lowest", "low", "normal", "high", "highest" };
+				std::string value = StrUtil::toLower(args[1]);
+				for (int i = 0; i < 5; i++) {
+					if (value == names[i]) {
+						setThreadPriority(args[0], i - 2);
+						return;
+					}
+				}
+				try {
+					setThreadPriority(args[0], std::stoi(value));
+				}
+				catch (...) {
+					env->console->warning("invalid thread priority \"%s\"", args[1].c_str());
+				}
+			}
+		});
+		env->console->addCommand("threadTopology", [&](auto& args) {
+			reportTopology();
+		});
+		env->eventManager->postStartup.addListener([&]() {
+			reportTopology();
+		});
 	}
 
 	void ThreadManager::startup() {
+		int nodeCount = (int)topology.nodes.size();
 		for (int i = 0; i < workerThreadCount; i++) {
 			auto worker = std::make_shared<Worker>();
 			workers.push_back(worker);
 			worker->workerId = i;
 			worker->threadManager = this;
+			//workers are distributed round robin so that every node gets its share
+			if (numaAwareWorkers && nodeCount > 1) {
+				worker->node = i % nodeCount;
+			}
 			worker->run();
 		}
 	}
@@ -49,8 +102,24 @@ namespace tri {
 		Thread thread;
 		thread.threadId = nextThreadId++;
 		thread.name = name;
-		thread.thread = std::make_shared<std::thread>([name, callback]() {
+		int threadId = thread.threadId;
+		thread.thread = std::make_shared<std::thread>([this, name, callback, threadId]() {
 			TRI_PROFILE_THREAD(name.c_str());
+			Profiler::setThreadName(name);
+			currentThreadId = threadId;
+			{
+				//waits until addThread has added the thread to the list
+				std::unique_lock<std::mutex> lock(*threadMutex);
+				for (auto& thread : threads) {
+					if (thread.threadId == threadId) {
+#if TRI_LINUX
+						thread.systemThreadId = (int)syscall(SYS_gettid);
+#endif
+						applyPolicy(thread);
+						break;
+					}
+				}
+			}
 			callback();
 		});
 		threads.push_back(thread);
@@ -88,23 +157,37 @@ namespace tri {
 
 	int ThreadManager::addTask(const std::function<void()>& callback) {
 		Task task;
-		task.taskId = nextTaskId++;
 		task.isWorkedOn = false;
 		task.callback = callback;
+		if (numaAwareWorkers && topology.nodes.size() > 1) {
+			task.node = getCurrentNode();
+		}
 
 		taskMutex->lock();
+		//tasks can be added from multiple job threads
+		task.taskId = nextTaskId++;
 		tasks.push_back(task);
 		taskMutex->unlock();
 
+		//prefer waking a worker on the node of the caller
+		std::shared_ptr<Worker> waitingWorker;
 		for (auto& worker : workers) {
 			if (worker) {
 				if (worker->isWaiting) {
-					worker->condition.notify_one();
-					worker->isWaiting = false;
-					break;
+					if (task.node == -1 || worker->node == task.node) {
+						waitingWorker = worker;
+						break;
+					}
+					else if (!waitingWorker) {
+						waitingWorker = worker;
+					}
 				}
 			}
 		}
+		if (waitingWorker) {
+			waitingWorker->condition.notify_one();
+			waitingWorker->isWaiting = false;
+		}
 
 		return task.taskId;
 	}
@@ -133,25 +216,82 @@ namespace tri {
 		return true;
 	}
 
+	void ThreadManager::parallelFor(int count, int batchSize, const std::function<void(int begin, int end)>& callback) {
+		if (count <= 0) {
+			return;
+		}
+		batchSize = std::max(batchSize, 1);
+		int batchCount = (count + batchSize - 1) / batchSize;
+		if (batchCount == 1 || workers.empty()) {
+			callback(0, count);
+			return;
+		}
+
+		std::atomic<int> nextBatch = 0;
+		auto process = [&]() {
+			for (int batch = nextBatch++; batch < batchCount; batch = nextBatch++) {
+				callback(batch * batchSize, std::min(count, (batch + 1) * batchSize));
+			}
+		};
+
+		int taskCount = std::min(batchCount - 1, (int)workers.size());
+		std::vector<int> taskIds;
+		taskIds.reserve(taskCount);
+		for (int i = 0; i < taskCount; i++) {
+			taskIds.push_back(addTask(process));
+		}
+		process();
+
+		//tasks that no worker picked up yet have nothing left to do
+		{
+			std::unique_lock<std::mutex> lock(*taskMutex);
+			for (int i = 0; i < tasks.size(); i++) {
+				if (!tasks[i].isWorkedOn && std::find(taskIds.begin(), taskIds.end(), tasks[i].taskId) != taskIds.end()) {
+					tasks.erase(tasks.begin() + i);
+					i--;
+				}
+			}
+		}
+		for (int taskId : taskIds) {
+			joinTask(taskId);
+		}
+	}
+
 	void ThreadManager::Worker::run() {
 		running = true;
 		taskId = -1;
 		threadId = threadManager->addThread(std::string("Worker Thread ") + std::to_string(workerId), [this]() {
+			if (node != -1) {
+				currentWorkerNode = node;
+				threadManager->bindToNode(node);
+			}
 			while (running) {
 				threadManager->taskMutex->lock();
 				if (!threadManager->tasks.empty()) {
 
-					std::function<void()> callback;
+					//tasks from the own node are taken first, tasks from other nodes only when there is nothing else to do
+					int index = -1;
 					for (int i = 0; i < threadManager->tasks.size(); i++) {
 						auto& task = threadManager->tasks[i];
 						if (!task.isWorkedOn) {
-							taskId = task.taskId;
-							callback = task.callback;
-							task.isWorkedOn = true;
-							break;
+							if (node == -1 || task.node == -1 || task.node == node) {
+								index = i;
+								break;
+							}
+							else if (index == -1) {
+								index = i;
+							}
 						}
 					}
 
+					std::function<void()> callback;
+					if (index != -1) {
+						auto& task = threadManager->tasks[index];
+						taskId = task.taskId;
+						callback = task.callback;
+						task.isWorkedOn = true;
+					}
+
 					threadManager->taskMutex->unlock();
 					if (callback) {
 						TRI_PROFILE("task");
@@ -165,7 +305,8 @@ namespace tri {
 						}
 					}
 					taskId = -1;
-					threadManager->taskCondition->notify_one();
+					//several threads may wait for different tasks
+					threadManager->taskCondition->notify_all();
 					threadManager->taskMutex->unlock();
 				}
 				else {
@@ -179,4 +320,248 @@ namespace tri {
 		});
 	}
 
+	void ThreadManager::setThreadAffinity(const std::string& namePrefix, const std::string& cpus) {
+		std::unique_lock<std::mutex> lock(*threadMutex);
+		auto& policy = policies[namePrefix];
+		policy.cpus = parseCpuList(cpus);
+		policy.hasCpus = !policy.cpus.empty();
+		for (auto& thread : threads) {
+			if (thread.name.starts_with(namePrefix)) {
+				applyPolicy(thread);
+			}
+		}
+	}
+
+	void ThreadManager::setThreadPriority(const std::string& namePrefix, int priority) {
+		std::unique_lock<std::mutex> lock(*threadMutex);
+		auto& policy = policies[namePrefix];
+		policy.priority = std::clamp(priority, -2, 2);
+		policy.hasPriority = true;
+		for (auto& thread : threads) {
+			if (thread.name.starts_with(namePrefix)) {
+				applyPolicy(thread);
+			}
+		}
+	}
+
+	const ThreadManager::Topology& ThreadManager::getTopology() {
+		return topology;
+	}
+
+	int ThreadManager::getCurrentNode() {
+		if (currentWorkerNode != -1) {
+			return currentWorkerNode;
+		}
+#if TRI_LINUX
+		int cpu = sched_getcpu();
+		if (cpu >= 0 && cpu < cpuToNode.size()) {
+			return cpuToNode[cpu];
+		}
+#endif
+		return -1;
+	}
+
+	void ThreadManager::reportTopology() {
+		env->console->info("cpu topology: %i cpus available on %i numa nodes", (int)topology.cpus.size(), (int)topology.nodes.size());
+		for (int i = 0; i < topology.nodes.size(); i++) {
+			int workerCount = 0;
+			for (auto& worker : workers) {
+				if (worker && worker->node == i) {
+					workerCount++;
+				}
+			}
+			env->console->info("  node %i: cpus %s, %i workers", i, formatCpuList(topology.nodes[i]).c_str(), workerCount);
+		}
+
+		std::unique_lock<std::mutex> lock(*threadMutex);
+		for (auto& thread : threads) {
+			if (!thread.cpus.empty() || thread.priority != 0) {
+				env->console->info("  thread %s: cpus %s, priority %i", thread.name.c_str(),
+					thread.cpus.empty() ? "all" : formatCpuList(thread.cpus).c_str(), thread.priority);
+			}
+		}
+	}
+
+	std::vector<int> ThreadManager::parseCpuList(const std::string& list) {
+		std::vector<int> cpus;
+		for (auto& part : StrUtil::split(list, ",", false)) {
+			try {
+				auto range = StrUtil::split(part, "-", false);
+				if (range.size() == 1) {
+					cpus.push_back(std::stoi(range[0]));
+				}
+				else if (range.size() == 2) {
+					for (int cpu = std::stoi(range[0]); cpu <= std::stoi(range[1]); cpu++) {
+						cpus.push_back(cpu);
+					}
+				}
+			}
+			catch (...) {}
+		}
+		std::sort(cpus.begin(), cpus.end());
+		cpus.erase(std::unique(cpus.begin(), cpus.end()), cpus.end());
+		return cpus;
+	}
+
+	std::string ThreadManager::formatCpuList(const std::vector<int>& cpus) {
+		std::string result;
+		for (int i = 0; i < cpus.size();) {
+			int end = i;
+			while (end + 1 < cpus.size() && cpus[end + 1] == cpus[end] + 1) {
+				end++;
+			}
+			if (!result.empty()) {
+				result += ",";
+			}
+			result += std::to_string(cpus[i]);
+			if (end > i) {
+				result += "-" + std::to_string(cpus[end]);
+			}
+			i = end + 1;
+		}
+		return result;
+	}
+
+	void ThreadManager::detectTopology() {
+		topology.cpus.clear();
+		topology.nodes.clear();
+#if TRI_LINUX
+		//only the cpus of the process affinity mask are used, so that several processes can share a machine
+		cpu_set_t set;
+		CPU_ZERO(&set);
+		if (sched_getaffinity(0, sizeof(set), &set) == 0) {
+			for (int cpu = 0; cpu < CPU_SETSIZE; cpu++) {
+				if (CPU_ISSET(cpu, &set)) {
+					topology.cpus.push_back(cpu);
+				}
+			}
+		}
+		try {
+			for (int node = 0; std::filesystem::exists("/sys/devices/system/node/node" + std::to_string(node)); node++) {
+				std::string list = StrUtil::readFile("/sys/devices/system/node/node" + std::to_string(node) + "/cpulist");
+				std::vector<int> cpus;
+				for (int cpu : parseCpuList(StrUtil::replace(list, "\n", ""))) {
+					if (std::binary_search(topology.cpus.begin(), topology.cpus.end(), cpu)) {
+						cpus.push_back(cpu);
+					}
+				}
+				if (!cpus.empty()) {
+					topology.nodes.push_back(cpus);
+				}
+			}
+		}
+		catch (...) {}
+#endif
+		if (topology.cpus.empty()) {
+			for (int cpu = 0; cpu < std::thread::hardware_concurrency(); cpu++) {
+				topology.cpus.push_back(cpu);
+			}
+		}
+		if (topology.nodes.empty()) {
+			topology.nodes.push_back(topology.cpus);
+		}
+
+		cpuToNode.clear();
+		for (int i = 0; i < topology.nodes.size(); i++) {
+			for (int cpu : topology.nodes[i]) {
+				if (cpu >= cpuToNode.size()) {
+					cpuToNode.resize(cpu + 1, -1);
+				}
+				cpuToNode[cpu] = i;
+			}
+		}
+	}
+
+	void ThreadManager::applyPolicy(Thread& thread) {
+		Policy* cpuPolicy = nullptr;
+		Policy* priorityPolicy = nullptr;
+		int cpuPrefixSize = -1;
+		int priorityPrefixSize = -1;
+		for (auto& [prefix, policy] : policies) {
+			if (thread.name.starts_with(prefix)) {
+				if (policy.hasCpus && (int)prefix.size() > cpuPrefixSize) {
+					cpuPolicy = &policy;
+					cpuPrefixSize = prefix.size();
+				}
+				if (policy.hasPriority && (int)prefix.size() > priorityPrefixSize) {
+					priorityPolicy = &policy;
+					priorityPrefixSize = prefix.size();
+				}
+			}
+		}
+
+		std::vector<int> cpus;
+		if (cpuPolicy) {
+			cpus = cpuPolicy->cpus;
+		}
+		if (thread.node >= 0 && thread.node < topology.nodes.size()) {
+			//keep the thread on its node, unless the explicit cpus do not contain any cpu of that node
+			std::vector<int> nodeCpus;
+			for (int cpu : topology.nodes[thread.node]) {
+				if (cpus.empty() || std::binary_search(cpus.begin(), cpus.end(), cpu)) {
+					nodeCpus.push_back(cpu);
+				}
+			}
+			if (!nodeCpus.empty()) {
+				cpus = nodeCpus;
+			}
+		}
+		int priority = priorityPolicy ? priorityPolicy->priority : 0;
+
+		bool changed = cpus != thread.cpus || priority != thread.priority;
+		if (!changed || !thread.thread) {
+			return;
+		}
+#if TRI_LINUX
+		if (thread.systemThreadId == 0) {
+			//the policy is applied when the thread has published its id
+			return;
+		}
+#endif
+		//only policies that where applied are recorded, so that the next call applies a pending one
+		thread.cpus = cpus;
+		thread.priority = priority;
+
+#if TRI_LINUX
+		cpu_set_t set;
+		CPU_ZERO(&set);
+		for (int cpu : cpus.empty() ? topology.cpus : cpus) {
+			if (cpu >= 0 && cpu < CPU_SETSIZE) {
+				CPU_SET(cpu, &set);
+			}
+		}
+		if (sched_setaffinity(thread.systemThreadId, sizeof(set), &set) != 0) {
+			env->console->warning("failed to set the affinity of thread %s", thread.name.c_str());
+		}
+		//the nice value is per thread on linux, raising the priority needs CAP_SYS_NICE
+		if (setpriority(PRIO_PROCESS, thread.systemThreadId, -priority * 5) != 0 && !priorityWarningShown) {
+			priorityWarningShown = true;
+			env->console->warning("failed to set the priority of thread %s, raising thread priorities requires CAP_SYS_NICE", thread.name.c_str());
+		}
+#elif TRI_WINDOWS
+		HANDLE handle = (HANDLE)thread.thread->native_handle();
+		DWORD_PTR mask = 0;
+		for (int cpu : cpus.empty() ? topology.cpus : cpus) {
+			if (cpu >= 0 && cpu < sizeof(DWORD_PTR) * 8) {
+				mask |= (DWORD_PTR)1 << cpu;
+			}
+		}
+		if (mask != 0) {
+			SetThreadAffinityMask(handle, mask);
+		}
+		SetThreadPriority(handle, priority);
+#endif
+	}
+
+	void ThreadManager::bindToNode(int node) {
+		std::unique_lock<std::mutex> lock(*threadMutex);
+		for (auto& thread : threads) {
+			if (thread.threadId == currentThreadId) {
+				thread.node = node;
+				applyPolicy(thread);
+				break;
+			}
+		}
+	}
+
 }
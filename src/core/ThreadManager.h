@@ -11,6 +11,16 @@ namespace tri {
 	class ThreadManager : public System {
 	public:
 		int workerThreadCount = std::thread::hardware_concurrency();
+		//distribute the workers over the numa nodes and prefer tasks that where added from the same node
+		bool numaAwareWorkers = true;
+
+		class Topology {
+		public:
+			//cpus the process is allowed to run on
+			std::vector<int> cpus;
+			//allowed cpus of each numa node
+			std::vector<std::vector<int>> nodes;
+		};
 
 		void init() override;
 		void startup() override;
@@ -23,6 +33,21 @@ namespace tri {
 		int addTask(const std::function<void()>& callback);
 		void joinTask(int taskId);
 		bool isTaskFinished(int taskId);
+		//splits [0, count) into batches that are processed by the workers and the calling thread, returns when all are done
+		void parallelFor(int count, int batchSize, const std::function<void(int begin, int end)>& callback);
+
+		//applies to all threads whose name starts with the prefix, the longest matching prefix is used
+		//cpus are given as a list like "0-3,8,10-11", an empty list allows all cpus
+		void setThreadAffinity(const std::string& namePrefix, const std::string& cpus);
+		//priority from -2 (lowest) to 2 (highest), 0 is the default
+		void setThreadPriority(const std::string& namePrefix, int priority);
+		const Topology& getTopology();
+		//numa node of the cpu the calling thread is running on
+		int getCurrentNode();
+		void reportTopology();
+
+		static std::vector<int> parseCpuList(const std::string& list);
+		static std::string formatCpuList(const std::vector<int>& cpus);
 
 	private:
 		int nextThreadId = 0;
@@ -33,15 +58,41 @@ namespace tri {
 			std::shared_ptr<std::thread> thread;
 			std::string name;
 			int threadId;
+			//id used by the os scheduler, set when the thread started
+			int systemThreadId = 0;
+			//numa node the thread is bound to, -1 if not bound
+			int node = -1;
+			std::vector<int> cpus;
+			int priority = 0;
 		};
 		std::vector<Thread> threads;
 		std::shared_ptr<std::mutex> threadMutex;
 
+		class Policy {
+		public:
+			std::vector<int> cpus;
+			bool hasCpus = false;
+			int priority = 0;
+			bool hasPriority = false;
+		};
+		std::unordered_map<std::string, Policy> policies;
+		Topology topology;
+		std::vector<int> cpuToNode;
+		bool priorityWarningShown = false;
+
+		void detectTopology();
+		//assumes the thread mutex is locked
+		void applyPolicy(Thread& thread);
+		//binds the calling thread to the node
+		void bindToNode(int node);
+
 		class Task {
 		public:
 			std::function<void()> callback;
 			int taskId;
 			bool isWorkedOn;
+			//node of the thread that added the task, -1 if unknown
+			int node = -1;
 		};
 		std::vector<Task> tasks;
 		std::shared_ptr<std::mutex> taskMutex;
@@ -51,6 +102,7 @@ namespace tri {
 		public:
 			int workerId;
 			int threadId;
+			int node = -1;
 			int taskId;
 			bool running;
 			ThreadManager* threadManager;
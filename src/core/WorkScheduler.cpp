@@ -0,0 +1,159 @@
+//
+// Copyright (c) 2022 Julian Hinxlage. All rights reserved.
+//
+
+#include "WorkScheduler.h"
+#include "Environment.h"
+#include "Console.h"
+#include "Profiler.h"
+#include "util/Clock.h"
+
+namespace tri {
+
+	TRI_SYSTEM_INSTANCE(WorkScheduler, env->workScheduler);
+
+	void WorkScheduler::init() {
+		env->console->addCVar<float>("backgroundWorkBudget", &frameBudget);
+		env->console->addCVar<bool>("backgroundWorkUseIdleTime", &useIdleTime);
+		env->console->addCommand("backgroundWorkStats", [&](auto& args) {
+			std::unique_lock<std::mutex> lock(mutex);
+			env->console->info("background work: %d pending, oldest %.2f s, %d steps and %d finished last frame in %.3f ms (budget %.3f ms), %lld finished in total",
+				(int)queue.size(), stats.oldestAge, stats.stepCount, stats.finishedCount, stats.workTime * 1000.0, stats.budget * 1000.0, (long long)stats.totalFinishedCount);
+			for (auto& work : queue) {
+				env->console->info("  %s", work.name.c_str());
+			}
+		});
+	}
+
+	void WorkScheduler::shutdown() {
+		std::unique_lock<std::mutex> lock(mutex);
+		if (!queue.empty()) {
+			env->console->debug("%d background work items where canceled at shutdown", (int)queue.size());
+		}
+		queue.clear();
+	}
+
+	int WorkScheduler::addWork(const std::string& name, const std::function<bool()>& step) {
+		std::unique_lock<std::mutex> lock(mutex);
+		Work work;
+		work.workId = nextWorkId++;
+		work.name = name;
+		work.step = step;
+		work.addTime = Clock::now();
+		queue.push_back(work);
+		return work.workId;
+	}
+
+	void WorkScheduler::cancelWork(int workId) {
+		std::unique_lock<std::mutex> lock(mutex);
+		for (auto i = queue.begin(); i != queue.end(); i++) {
+			if (i->workId == workId) {
+				queue.erase(i);
+				break;
+			}
+		}
+	}
+
+	bool WorkScheduler::isWorkFinished(int workId) {
+		std::unique_lock<std::mutex> lock(mutex);
+		for (auto& work : queue) {
+			if (work.workId == workId) {
+				return false;
+			}
+		}
+		return true;
+	}
+
+	void WorkScheduler::finishWork(int workId) {
+		Work work;
+		{
+			std::unique_lock<std::mutex> lock(mutex);
+			for (auto i = queue.begin(); i != queue.end(); i++) {
+				if (i->workId == workId) {
+					work = *i;
+					queue.erase(i);
+					break;
+				}
+			}
+		}
+		if (work.step) {
+			TRI_PROFILE("finishWork");
+			TRI_PROFILE_INFO(work.name.c_str(), work.name.size());
+			while (!work.step()) {}
+		}
+	}
+
+	void WorkScheduler::setFrameDeadline(double time) {
+		frameDeadline = time;
+	}
+
+	double WorkScheduler::getBudget() {
+		double budget = frameBudget / 1000.0;
+		double deadline = frameDeadline;
+		if (useIdleTime && deadline > 0) {
+			//keep some time for the frame limiter to wake up in time
+			double idle = deadline - Clock::now() - 0.001;
+			budget = std::max(budget, idle);
+		}
+		return budget;
+	}
+
+	void WorkScheduler::run() {
+		Stats frameStats;
+		frameStats.totalFinishedCount = stats.totalFinishedCount;
+		{
+			std::unique_lock<std::mutex> lock(mutex);
+			if (queue.empty()) {
+				stats = frameStats;
+				return;
+			}
+		}
+
+		TRI_PROFILE("backgroundWork");
+		env->profiler->begin("backgroundWork");
+		frameStats.budget = getBudget();
+		Clock clock;
+		//round robin, every step is followed by the next work item
+		while (clock.elapsed() < frameStats.budget) {
+			Work work;
+			{
+				std::unique_lock<std::mutex> lock(mutex);
+				if (queue.empty()) {
+					break;
+				}
+				work = queue.front();
+				queue.pop_front();
+			}
+
+			bool finished = true;
+			{
+				TRI_PROFILE("step");
+				TRI_PROFILE_INFO(work.name.c_str(), work.name.size());
+				if (work.step) {
+					finished = work.step();
+				}
+			}
+			frameStats.stepCount++;
+
+			if (finished) {
+				frameStats.finishedCount++;
+				frameStats.totalFinishedCount++;
+			}
+			else {
+				std::unique_lock<std::mutex> lock(mutex);
+				queue.push_back(work);
+			}
+		}
+		frameStats.workTime = clock.elapsed();
+		env->profiler->end();
+
+		std::unique_lock<std::mutex> lock(mutex);
+		frameStats.pendingCount = (int)queue.size();
+		double now = Clock::now();
+		for (auto& work : queue) {
+			frameStats.oldestAge = std::max(frameStats.oldestAge, now - work.addTime);
+		}
+		stats = frameStats;
+	}
+
+}
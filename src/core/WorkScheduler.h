@@ -0,0 +1,67 @@
+//
+// Copyright (c) 2022 Julian Hinxlage. All rights reserved.
+//
+
+#pragma once
+
+#include "System.h"
+#include <deque>
+#include <atomic>
+
+namespace tri {
+
+	//runs resumable background work on the main thread between two frames, limited by a time budget per frame
+	class WorkScheduler : public System {
+	public:
+		//milliseconds per frame that are spent on background work
+		float frameBudget = 2;
+		//also use the time that is left until the next frame when the frame rate is limited
+		bool useIdleTime = true;
+
+		class Stats {
+		public:
+			int pendingCount = 0;
+			//steps and finished work items during the last frame
+			int stepCount = 0;
+			int finishedCount = 0;
+			double workTime = 0;
+			double budget = 0;
+			//seconds since the oldest pending work item was added
+			double oldestAge = 0;
+			int64_t totalFinishedCount = 0;
+		};
+
+		virtual void init() override;
+		virtual void shutdown() override;
+
+		//the step is called repeatedly until it returns true, a single step should only take a fraction of the budget
+		int addWork(const std::string& name, const std::function<bool()>& step);
+		void cancelWork(int workId);
+		bool isWorkFinished(int workId);
+		//runs the remaining steps of the work item on the calling thread
+		void finishWork(int workId);
+
+		//time (Clock::now) at which the next frame should begin, 0 if the frame rate is not limited
+		void setFrameDeadline(double time);
+		//seconds that can be spent on background work in the current frame
+		double getBudget();
+		//runs work until the budget is used up, has to be called while no job is ticking
+		void run();
+		const Stats& getStats() { return stats; }
+
+	private:
+		class Work {
+		public:
+			int workId = -1;
+			std::string name;
+			std::function<bool()> step;
+			double addTime = 0;
+		};
+		std::deque<Work> queue;
+		std::mutex mutex;
+		int nextWorkId = 0;
+		std::atomic<double> frameDeadline = 0;
+		Stats stats;
+	};
+
+}
@@ -108,9 +108,26 @@ namespace tri {
 			originalPath = currentPath.string();
 		}
 
-		for (auto line : StrUtil::split(config, "\n", false)) {
+		auto lines = StrUtil::split(config, "\n", false);
+		bool modulesPrepared = false;
+		for (int i = 0; i < lines.size(); i++) {
+			auto line = lines[i];
 			if (line.size() > 0 && line[0] != '#') {
 				line = StrUtil::replace(line, "$", originalPath);
+
+				//the files of all modules of this config are prepared in parallel when the first module is loaded
+				if (!modulesPrepared && !isPostStartup && line.starts_with("loadModule")) {
+					modulesPrepared = true;
+					std::vector<std::string> names;
+					for (int j = i; j < lines.size(); j++) {
+						auto parts = StrUtil::split(StrUtil::replace(lines[j], "$", originalPath), " ", false);
+						if (parts.size() > 1 && (parts[0] == "loadModule" || parts[0] == "loadModuleStub")) {
+							names.push_back(parts[1]);
+						}
+					}
+					env->moduleManager->prepareModules(names);
+				}
+
 				env->console->executeCommand(line);
 			}
 		}
@@ -9,6 +9,8 @@
 
 typedef uint32_t EntityId;
 typedef uint64_t EntitySignature;
+//mapping of entity ids, e.g. from the ids of a prefab or a packet to the created entities
+typedef std::unordered_map<EntityId, EntityId> EntityIdMap;
 
 namespace tri {
 
@@ -14,6 +14,9 @@
 #include "Console.h"
 #include "ModuleManager.h"
 #include "Profiler.h"
+#include "FrameAllocator.h"
+#include "WorkScheduler.h"
+#include "MemoryTracker.h"
 #include "JobManager.h"
 #include "MainLoop.h"
 #include "ThreadManager.h"
@@ -0,0 +1,131 @@
+//
+// Copyright (c) 2022 Julian Hinxlage. All rights reserved.
+//
+
+#include "FramePacer.h"
+#include "config.h"
+#include <cmath>
+
+#if TRI_LINUX
+#include <time.h>
+#include <errno.h>
+#endif
+
+namespace tri {
+
+    //nanoseconds of the monotonic clock, the same clock is used by clock_nanosleep
+    static int64_t monotonicNano() {
+        return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+    }
+
+    static void sleepUntil(int64_t time) {
+#if TRI_LINUX
+        timespec ts;
+        ts.tv_sec = time / 1000000000;
+        ts.tv_nsec = time % 1000000000;
+        while (clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &ts, nullptr) == EINTR) {}
+#else
+        //coarse sleeps of a millisecond, the remaining time is spinned
+        while (time - monotonicNano() > 2000000) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+#endif
+    }
+
+    FramePacer::FramePacer() {
+        period = 0;
+        deadline = 0;
+        errorSum = 0;
+        frameStart = 0;
+        frameTime = -1;
+    }
+
+    void FramePacer::setPeriod(double seconds) {
+        int64_t newPeriod = (int64_t)(seconds * 1e9);
+        if (newPeriod != period) {
+            period = newPeriod;
+            deadline = 0;
+        }
+    }
+
+    double FramePacer::getPeriod() {
+        return (double)period / 1e9;
+    }
+
+    double FramePacer::wait() {
+        if (period <= 0) {
+            return 0;
+        }
+        int64_t now = monotonicNano();
+        if (deadline == 0) {
+            nextDeadline(now);
+        }
+
+        if (now >= deadline) {
+            //the frame took longer than the period, the next frame starts right away
+            //if more than a period was lost the next boundary is used instead of catching up
+            stats.lateCount++;
+            beginFrame(now);
+            if (now - deadline >= period) {
+                nextDeadline(now);
+            }
+            else {
+                deadline += period;
+            }
+            return 0;
+        }
+
+        int64_t spin = (int64_t)(spinTime * 1e9);
+        if (deadline - now > spin) {
+            sleepUntil(deadline - spin);
+        }
+        while (monotonicNano() < deadline) {}
+
+        now = monotonicNano();
+        double error = (double)(now - deadline) / 1e9;
+        stats.lastError = error;
+        stats.maxError = std::max(stats.maxError, error);
+        stats.count++;
+        errorSum += error;
+        stats.avgError = errorSum / stats.count;
+        beginFrame(deadline);
+        deadline += period;
+        return error;
+    }
+
+    double FramePacer::getTimeUntilDeadline() {
+        if (period <= 0 || deadline == 0) {
+            return 0;
+        }
+        return (double)(deadline - monotonicNano()) / 1e9;
+    }
+
+    void FramePacer::resetStats() {
+        stats = Stats();
+        errorSum = 0;
+    }
+
+    double FramePacer::getFrameTime() {
+        if (frameTime < 0) {
+            return -1;
+        }
+        return (double)frameTime / 1e9;
+    }
+
+    void FramePacer::restart() {
+        deadline = 0;
+        frameStart = 0;
+        frameTime = -1;
+    }
+
+    void FramePacer::beginFrame(int64_t time) {
+        frameTime = frameStart == 0 ? -1 : time - frameStart;
+        frameStart = time;
+    }
+
+    void FramePacer::nextDeadline(int64_t time) {
+        //deadlines are multiples of the period, so that processes with the same rate tick in phase
+        deadline = (time / period + 1) * period;
+    }
+
+}
@@ -0,0 +1,57 @@
+//
+// Copyright (c) 2022 Julian Hinxlage. All rights reserved.
+//
+
+#pragma once
+#include "pch.h"
+
+namespace tri {
+
+    //waits for absolute deadlines on multiples of a fixed period
+    //sleeps until shortly before the deadline and spins for the rest to keep the error low
+    class FramePacer {
+    public:
+        //seconds before the deadline at which sleeping stops and spinning begins
+        double spinTime = 0.0005;
+
+        class Stats {
+        public:
+            //wake up time minus deadline in seconds
+            double lastError = 0;
+            double avgError = 0;
+            double maxError = 0;
+            //number of waits
+            int64_t count = 0;
+            //frames that ended after their deadline, so there was nothing to wait for
+            int64_t lateCount = 0;
+        };
+
+        FramePacer();
+        void setPeriod(double seconds);
+        double getPeriod();
+        //waits until the next deadline, returns the pacing error in seconds
+        double wait();
+        //seconds until the next deadline, negative if it already passed
+        double getTimeUntilDeadline();
+        //seconds between the start of the last two frames, a frame starts at its deadline or when it was late
+        //the sum of the frame times follows the clock, late frames are made up by shorter following frames
+        //negative if there was no previous frame
+        double getFrameTime();
+        void resetStats();
+        //forgets the current deadline, the next wait starts at the next period boundary
+        void restart();
+        const Stats& getStats() { return stats; }
+
+    private:
+        int64_t period;
+        int64_t deadline;
+        Stats stats;
+        double errorSum;
+        int64_t frameStart;
+        int64_t frameTime;
+
+        void nextDeadline(int64_t time);
+        void beginFrame(int64_t time);
+    };
+
+}
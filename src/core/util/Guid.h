@@ -18,3 +18,18 @@ namespace tri {
 
 }
 
+namespace std {
+
+    template<>
+    struct hash<tri::Guid> {
+        size_t operator()(const tri::Guid& guid) const {
+            //guids are random, folding the words is enough
+            size_t result = 0;
+            for (int i = 0; i < tri::Guid::wordCount; i++) {
+                result = (result ^ (size_t)guid.words[i]) * 0x9E3779B97F4A7C15ull;
+            }
+            return result;
+        }
+    };
+
+}
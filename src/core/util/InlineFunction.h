@@ -0,0 +1,188 @@
+//
+// Copyright (c) 2022 Julian Hinxlage. All rights reserved.
+//
+
+#pragma once
+
+#include "pch.h"
+#include <type_traits>
+#include <cstddef>
+#include <new>
+
+namespace tri {
+
+    template<typename Signature, int bufferSize = 48>
+    class InlineFunction;
+
+    //callable wrapper like std::function, small callables are stored in place without a heap allocation
+    template<typename Return, typename... Args, int bufferSize>
+    class InlineFunction<Return(Args...), bufferSize> {
+    public:
+        InlineFunction() {}
+
+        template<typename Func, typename = std::enable_if_t<!std::is_same_v<std::decay_t<Func>, InlineFunction>>>
+        InlineFunction(Func&& func) {
+            set(std::forward<Func>(func));
+        }
+
+        InlineFunction(const InlineFunction& other) {
+            copyFrom(other);
+        }
+
+        InlineFunction(InlineFunction&& other) noexcept {
+            moveFrom(other);
+        }
+
+        ~InlineFunction() {
+            reset();
+        }
+
+        InlineFunction& operator=(const InlineFunction& other) {
+            if (this != &other) {
+                reset();
+                copyFrom(other);
+            }
+            return *this;
+        }
+
+        InlineFunction& operator=(InlineFunction&& other) noexcept {
+            if (this != &other) {
+                reset();
+                moveFrom(other);
+            }
+            return *this;
+        }
+
+        template<typename Func>
+        void set(Func&& func) {
+            typedef std::decay_t<Func> Type;
+            reset();
+            if constexpr (std::is_pointer_v<Type>) {
+                if (!func) {
+                    return;
+                }
+            }
+            if constexpr (isInline<Type>()) {
+                new (storage) Type(std::forward<Func>(func));
+                invoker = [](void* data, Args... args) -> Return {
+                    return (*(Type*)data)(std::forward<Args>(args)...);
+                };
+            }
+            else {
+                *(Type**)storage = new Type(std::forward<Func>(func));
+                invoker = [](void* data, Args... args) -> Return {
+                    return (**(Type**)data)(std::forward<Args>(args)...);
+                };
+            }
+            manager = &manage<Type>;
+
+            //the code that is called lives in the module that created the callable
+            if constexpr (std::is_pointer_v<Type>) {
+                address = (const void*)func;
+            }
+            else {
+                address = (const void*)invoker;
+            }
+        }
+
+        void reset() {
+            if (manager) {
+                manager(DESTROY, storage, nullptr);
+            }
+            invoker = nullptr;
+            manager = nullptr;
+            address = nullptr;
+        }
+
+        Return operator()(Args... args) const {
+            return invoker((void*)storage, std::forward<Args>(args)...);
+        }
+
+        explicit operator bool() const {
+            return invoker != nullptr;
+        }
+
+        //address of the invoked code, used to find the module a callable comes from
+        const void* getAddress() const {
+            return address;
+        }
+
+    private:
+        enum Operation {
+            COPY,
+            MOVE,
+            DESTROY,
+        };
+
+        alignas(std::max_align_t) uint8_t storage[bufferSize];
+        Return(*invoker)(void* data, Args... args) = nullptr;
+        //returns false if the operation is not supported by the callable
+        bool(*manager)(Operation operation, void* data, void* other) = nullptr;
+        const void* address = nullptr;
+
+        template<typename Type>
+        static constexpr bool isInline() {
+            return sizeof(Type) <= bufferSize && alignof(Type) <= alignof(std::max_align_t) && std::is_nothrow_move_constructible_v<Type>;
+        }
+
+        template<typename Type>
+        static bool manage(Operation operation, void* data, void* other) {
+            if constexpr (isInline<Type>()) {
+                if (operation == COPY) {
+                    if constexpr (std::is_copy_constructible_v<Type>) {
+                        new (data) Type(*(const Type*)other);
+                    }
+                    else {
+                        return false;
+                    }
+                }
+                else if (operation == MOVE) {
+                    new (data) Type(std::move(*(Type*)other));
+                    ((Type*)other)->~Type();
+                }
+                else if (operation == DESTROY) {
+                    ((Type*)data)->~Type();
+                }
+            }
+            else {
+                if (operation == COPY) {
+                    if constexpr (std::is_copy_constructible_v<Type>) {
+                        *(Type**)data = new Type(**(const Type**)other);
+                    }
+                    else {
+                        return false;
+                    }
+                }
+                else if (operation == MOVE) {
+                    *(Type**)data = *(Type**)other;
+                }
+                else if (operation == DESTROY) {
+                    delete *(Type**)data;
+                }
+            }
+            return true;
+        }
+
+        void copyFrom(const InlineFunction& other) {
+            //move only callables can not be copied, the copy stays empty
+            if (other.manager && other.manager(COPY, storage, (void*)other.storage)) {
+                invoker = other.invoker;
+                manager = other.manager;
+                address = other.address;
+            }
+        }
+
+        void moveFrom(InlineFunction& other) {
+            if (other.manager) {
+                other.manager(MOVE, storage, other.storage);
+                invoker = other.invoker;
+                manager = other.manager;
+                address = other.address;
+                other.invoker = nullptr;
+                other.manager = nullptr;
+                other.address = nullptr;
+            }
+        }
+    };
+
+}
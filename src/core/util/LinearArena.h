@@ -0,0 +1,115 @@
+//
+// Copyright (c) 2022 Julian Hinxlage. All rights reserved.
+//
+
+#pragma once
+
+#include "pch.h"
+#include <cstddef>
+
+namespace tri {
+
+    //bump allocator for short lived memory, single allocations are never freed, all memory is released at once with reset
+    class LinearArena {
+    public:
+        LinearArena(size_t blockSize = 1024 * 64) {
+            this->blockSize = blockSize;
+        }
+
+        void* allocate(size_t bytes, size_t alignment = alignof(std::max_align_t)) {
+            if (blocks.size() > 0) {
+                Block& block = blocks.back();
+                size_t begin = alignUp((size_t)block.data.get() + offset, alignment) - (size_t)block.data.get();
+                if (begin + bytes <= block.size) {
+                    offset = begin + bytes;
+                    allocationCount++;
+                    allocatedBytes += bytes;
+                    return block.data.get() + begin;
+                }
+            }
+
+            //new block, at least as large as the previous one
+            size_t size = blockSize;
+            if (blocks.size() > 0) {
+                size = std::max(size, blocks.back().size * 2);
+            }
+            size = std::max(size, bytes + alignment);
+            Block& block = blocks.emplace_back();
+            block.data = std::make_unique<uint8_t[]>(size);
+            block.size = size;
+            capacity += size;
+
+            size_t begin = alignUp((size_t)block.data.get(), alignment) - (size_t)block.data.get();
+            offset = begin + bytes;
+            allocationCount++;
+            allocatedBytes += bytes;
+            return block.data.get() + begin;
+        }
+
+        //invalidates all allocations, if multiple blocks where used they are merged into one block to fit the next frame
+        void reset() {
+            if (blocks.size() > 1) {
+                size_t size = capacity;
+                blocks.clear();
+                Block& block = blocks.emplace_back();
+                block.data = std::make_unique<uint8_t[]>(size);
+                block.size = size;
+            }
+            offset = 0;
+            allocationCount = 0;
+            allocatedBytes = 0;
+        }
+
+        size_t getAllocationCount() { return allocationCount; }
+        size_t getAllocatedBytes() { return allocatedBytes; }
+        size_t getCapacity() { return capacity; }
+
+    private:
+        class Block {
+        public:
+            std::unique_ptr<uint8_t[]> data;
+            size_t size = 0;
+        };
+        std::vector<Block> blocks;
+        size_t blockSize = 0;
+        size_t offset = 0;
+        size_t capacity = 0;
+        size_t allocationCount = 0;
+        size_t allocatedBytes = 0;
+
+        static size_t alignUp(size_t value, size_t alignment) {
+            return (value + alignment - 1) & ~(alignment - 1);
+        }
+    };
+
+    //stl allocator using a linear arena, falls back to the heap when no arena is set
+    template<typename T>
+    class ArenaAllocator {
+    public:
+        typedef T value_type;
+        LinearArena* arena;
+
+        ArenaAllocator(LinearArena* arena = nullptr) noexcept : arena(arena) {}
+        template<typename U>
+        ArenaAllocator(const ArenaAllocator<U>& allocator) noexcept : arena(allocator.arena) {}
+
+        T* allocate(size_t count) {
+            if (arena) {
+                return (T*)arena->allocate(count * sizeof(T), alignof(T));
+            }
+            return std::allocator<T>().allocate(count);
+        }
+
+        void deallocate(T* ptr, size_t count) {
+            if (!arena) {
+                std::allocator<T>().deallocate(ptr, count);
+            }
+        }
+
+        template<typename U>
+        bool operator==(const ArenaAllocator<U>& allocator) const { return arena == allocator.arena; }
+        template<typename U>
+        bool operator!=(const ArenaAllocator<U>& allocator) const { return arena != allocator.arena; }
+    };
+
+}
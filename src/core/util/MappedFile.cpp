@@ -0,0 +1,134 @@
+//
+// Copyright (c) 2022 Julian Hinxlage. All rights reserved.
+//
+
+#include "MappedFile.h"
+#include <utility>
+
+#if TRI_WINDOWS
+#include <windows.h>
+#else
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+namespace tri {
+
+    MappedFile::MappedFile() {
+        data = nullptr;
+        size = 0;
+        opened = false;
+#if TRI_WINDOWS
+        fileHandle = nullptr;
+        mappingHandle = nullptr;
+#endif
+    }
+
+    MappedFile::MappedFile(MappedFile&& file) noexcept : MappedFile() {
+        *this = std::move(file);
+    }
+
+    MappedFile::~MappedFile() {
+        close();
+    }
+
+    MappedFile& MappedFile::operator=(MappedFile&& file) noexcept {
+        if (this != &file) {
+            close();
+            std::swap(data, file.data);
+            std::swap(size, file.size);
+            std::swap(opened, file.opened);
+#if TRI_WINDOWS
+            std::swap(fileHandle, file.fileHandle);
+            std::swap(mappingHandle, file.mappingHandle);
+#endif
+        }
+        return *this;
+    }
+
+    bool MappedFile::open(const std::string& file) {
+        close();
+#if TRI_WINDOWS
+        HANDLE handle = CreateFileA(file.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+        if (handle == INVALID_HANDLE_VALUE) {
+            return false;
+        }
+        LARGE_INTEGER fileSize;
+        if (!GetFileSizeEx(handle, &fileSize)) {
+            CloseHandle(handle);
+            return false;
+        }
+        fileHandle = handle;
+        size = fileSize.QuadPart;
+        opened = true;
+        //empty files can not be mapped
+        if (size == 0) {
+            return true;
+        }
+        mappingHandle = CreateFileMappingA(handle, nullptr, PAGE_READONLY, 0, 0, nullptr);
+        if (!mappingHandle) {
+            close();
+            return false;
+        }
+        data = (const uint8_t*)MapViewOfFile(mappingHandle, FILE_MAP_READ, 0, 0, 0);
+        if (!data) {
+            close();
+            return false;
+        }
+        return true;
+#else
+        int fd = ::open(file.c_str(), O_RDONLY | O_CLOEXEC);
+        if (fd < 0) {
+            return false;
+        }
+        struct stat info;
+        if (fstat(fd, &info) != 0) {
+            ::close(fd);
+            return false;
+        }
+        size = info.st_size;
+        opened = true;
+        if (size == 0) {
+            ::close(fd);
+            return true;
+        }
+        void* ptr = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+        //the mapping stays valid after the descriptor is closed
+        ::close(fd);
+        if (ptr == MAP_FAILED) {
+            size = 0;
+            opened = false;
+            return false;
+        }
+        madvise(ptr, size, MADV_SEQUENTIAL);
+        data = (const uint8_t*)ptr;
+        return true;
+#endif
+    }
+
+    void MappedFile::close() {
+#if TRI_WINDOWS
+        if (data) {
+            UnmapViewOfFile(data);
+        }
+        if (mappingHandle) {
+            CloseHandle(mappingHandle);
+        }
+        if (fileHandle) {
+            CloseHandle(fileHandle);
+        }
+        fileHandle = nullptr;
+        mappingHandle = nullptr;
+#else
+        if (data) {
+            munmap((void*)data, size);
+        }
+#endif
+        data = nullptr;
+        size = 0;
+        opened = false;
+    }
+
+}
@@ -0,0 +1,40 @@
+//
+// Copyright (c) 2022 Julian Hinxlage. All rights reserved.
+//
+
+#pragma once
+
+#include "core/config.h"
+#include <string>
+#include <cstdint>
+
+namespace tri {
+
+    //read only memory mapping of a whole file
+    class MappedFile {
+    public:
+        MappedFile();
+        MappedFile(const MappedFile& file) = delete;
+        MappedFile(MappedFile&& file) noexcept;
+        ~MappedFile();
+        MappedFile& operator=(const MappedFile& file) = delete;
+        MappedFile& operator=(MappedFile&& file) noexcept;
+
+        bool open(const std::string& file);
+        void close();
+        bool isOpen() const { return data != nullptr || (opened && size == 0); }
+
+        const uint8_t* getData() const { return data; }
+        uint64_t getSize() const { return size; }
+
+    private:
+        const uint8_t* data;
+        uint64_t size;
+        bool opened;
+#if TRI_WINDOWS
+        void* fileHandle;
+        void* mappingHandle;
+#endif
+    };
+
+}
@@ -0,0 +1,89 @@
+//
+// Copyright (c) 2022 Julian Hinxlage. All rights reserved.
+//
+
+#pragma once
+
+#include "pch.h"
+#include <atomic>
+
+namespace tri {
+
+    //bounded lock free queue for multiple producers and a single consumer
+    template<typename T>
+    class MpscQueue {
+    public:
+        MpscQueue(int capacity = 1024) {
+            resize(capacity);
+        }
+
+        //not thread safe, the queue has to be unused while resizing
+        void resize(int capacity) {
+            int size = 1;
+            while (size < capacity) {
+                size *= 2;
+            }
+            slots = std::make_unique<Slot[]>(size);
+            mask = size - 1;
+            for (int i = 0; i < size; i++) {
+                slots[i].sequence.store(i, std::memory_order_relaxed);
+            }
+            enqueuePosition.store(0, std::memory_order_relaxed);
+            dequeuePosition = 0;
+        }
+
+        //the value is only moved from when the push succeeds, returns false if the queue is full
+        bool push(T& value) {
+            uint64_t position = enqueuePosition.load(std::memory_order_relaxed);
+            Slot* slot;
+            while (true) {
+                slot = &slots[position & mask];
+                uint64_t sequence = slot->sequence.load(std::memory_order_acquire);
+                int64_t diff = (int64_t)sequence - (int64_t)position;
+                if (diff == 0) {
+                    if (enqueuePosition.compare_exchange_weak(position, position + 1, std::memory_order_relaxed)) {
+                        break;
+                    }
+                }
+                else if (diff < 0) {
+                    return false;
+                }
+                else {
+                    position = enqueuePosition.load(std::memory_order_relaxed);
+                }
+            }
+            slot->value = std::move(value);
+            slot->sequence.store(position + 1, std::memory_order_release);
+            return true;
+        }
+
+        //has to be called only by one consumer at a time
+        bool pop(T& value) {
+            Slot* slot = &slots[dequeuePosition & mask];
+            uint64_t sequence = slot->sequence.load(std::memory_order_acquire);
+            if ((int64_t)sequence - (int64_t)(dequeuePosition + 1) < 0) {
+                return false;
+            }
+            value = std::move(slot->value);
+            slot->sequence.store(dequeuePosition + mask + 1, std::memory_order_release);
+            dequeuePosition++;
+            return true;
+        }
+
+        int capacity() {
+            return (int)(mask + 1);
+        }
+
+    private:
+        class Slot {
+        public:
+            std::atomic<uint64_t> sequence;
+            T value;
+        };
+        std::unique_ptr<Slot[]> slots;
+        uint64_t mask = 0;
+        alignas(64) std::atomic<uint64_t> enqueuePosition;
+        alignas(64) uint64_t dequeuePosition = 0;
+    };
+
+}
@@ -23,6 +23,9 @@ namespace tri {
 			std::string source;
 		};
 		std::vector<LogEntry> entries;
+		//entries logged on the writer thread, moved to the entries in tick
+		std::vector<LogEntry> pendingEntries;
+		std::mutex pendingEntriesMutex;
 		std::vector<std::string> history;
 		int historyIndex = -1;
 		std::string command;
@@ -39,12 +42,18 @@ namespace tri {
 				entry.time = time;
 				entry.date = date;
 				entry.source = source;
-				entries.push_back(entry);
+				std::unique_lock<std::mutex> lock(pendingEntriesMutex);
+				pendingEntries.push_back(entry);
 			};
 			env->console->addLogTarget(target);
 		}
 
 		void tick() override {
+			{
+				std::unique_lock<std::mutex> lock(pendingEntriesMutex);
+				entries.insert(entries.end(), std::make_move_iterator(pendingEntries.begin()), std::make_move_iterator(pendingEntries.end()));
+				pendingEntries.clear();
+			}
 			if (env->window && env->window->inFrame()) {
 				if (ImGui::Begin("Console", &active)) {
 
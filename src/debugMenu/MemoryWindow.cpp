@@ -0,0 +1,82 @@
+//
+// Copyright (c) 2022 Julian Hinxlage. All rights reserved.
+//
+
+#include "window/UIManager.h"
+#include "core/Reflection.h"
+#include "core/Environment.h"
+#include "core/MemoryTracker.h"
+#include "window/Window.h"
+#include "engine/Time.h"
+
+#include <imgui/imgui.h>
+
+namespace tri {
+
+	class MemoryWindow : public UIWindow {
+	public:
+		float updateInterval = 1.0f;
+		bool showModules = true;
+		bool showSystems = true;
+		std::vector<MemoryTracker::TagStats> stats;
+
+		void init() override {
+			env->uiManager->addWindow<MemoryWindow>("Memory", "Debug");
+		}
+
+		void tick() override {
+			if (env->window && env->window->inFrame()) {
+				if (ImGui::Begin("Memory", &active)) {
+					if (!MemoryTracker::isAvailable()) {
+						ImGui::Text("memory tracking is not available, build with TRI_MEMORY_TRACKING");
+					}
+					else {
+						if (env->time->frameTicks(updateInterval) || stats.empty()) {
+							stats = env->memoryTracker->getStats();
+							std::sort(stats.begin(), stats.end(), [](auto& a, auto& b) {
+								return a.liveBytes > b.liveBytes;
+							});
+						}
+
+						ImGui::Checkbox("Enabled", &env->memoryTracker->enabled);
+						ImGui::SameLine();
+						ImGui::Checkbox("Modules", &showModules);
+						ImGui::SameLine();
+						ImGui::Checkbox("Systems", &showSystems);
+						ImGui::Separator();
+
+						if (ImGui::BeginTable("memory", 5, ImGuiTableFlags_Borders | ImGuiTableFlags_RowBg)) {
+							ImGui::TableSetupColumn("Name");
+							ImGui::TableSetupColumn("Live KB");
+							ImGui::TableSetupColumn("Live Count");
+							ImGui::TableSetupColumn("KB / Frame");
+							ImGui::TableSetupColumn("Count / Frame");
+							ImGui::TableHeadersRow();
+							for (auto& tag : stats) {
+								if ((tag.isModule && !showModules) || (!tag.isModule && !showSystems)) {
+									continue;
+								}
+								ImGui::TableNextRow();
+								ImGui::TableNextColumn();
+								ImGui::Text("%s%s", tag.isModule ? "[module] " : "", tag.name.c_str());
+								ImGui::TableNextColumn();
+								ImGui::Text("%.1f", tag.liveBytes / 1024.0f);
+								ImGui::TableNextColumn();
+								ImGui::Text("%lld", (long long)tag.liveCount);
+								ImGui::TableNextColumn();
+								ImGui::Text("%.1f", tag.frameBytes / 1024.0f);
+								ImGui::TableNextColumn();
+								ImGui::Text("%lld", (long long)tag.frameCount);
+							}
+							ImGui::EndTable();
+						}
+					}
+				}
+				ImGui::End();
+			}
+		}
+	};
+
+	TRI_SYSTEM(MemoryWindow);
+
+}
@@ -6,6 +6,8 @@
 #include "core/Reflection.h"
 #include "core/Environment.h"
 #include "core/Profiler.h"
+#include "core/FrameAllocator.h"
+#include "core/WorkScheduler.h"
 #include "window/Window.h"
 #include "engine/Time.h"
 
@@ -21,6 +23,10 @@ namespace tri {
 		float avg = 0;
 		float min = 0;
 		float max = 0;
+		bool showPercentiles = false;
+		FrameAllocator::Stats frameAllocatorStats;
+		WorkScheduler::Stats workSchedulerStats;
+		FramePacer::Stats framePacingStats;
 
 		void init() override {
 			env->uiManager->addWindow<ProfilerWindow>("Profiler", "Debug");
@@ -35,16 +41,34 @@ namespace tri {
 						avg = env->time->avgFrameTime * 1000.0f;
 						min = env->time->minFrameTime * 1000.0f;
 						max = env->time->maxFrameTime * 1000.0f;
+						frameAllocatorStats = env->frameAllocator->getLastFrameStats();
+						workSchedulerStats = env->workScheduler->getStats();
+						framePacingStats = env->time->getFramePacingStats();
 					}
 					ImGui::Text("FPS: %f", fps);
 					ImGui::Text("Avg: %f ms", avg);
 					ImGui::Text("Max: %f ms", max);
 					ImGui::Text("Min: %f ms", min);
-#if TRI_PROFILE_ENABLED
+					ImGui::Text("Frame Allocations: %d (%.1f KB)", (int)frameAllocatorStats.allocationCount, frameAllocatorStats.allocatedBytes / 1024.0f);
+					if (env->time->frameRateLimit > 0 && env->time->framePacing) {
+						ImGui::Text("Pacing Error: avg %.1f us, max %.1f us, %lld late", framePacingStats.avgError * 1e6, framePacingStats.maxError * 1e6, (long long)framePacingStats.lateCount);
+					}
+					ImGui::Text("Background Work: %d pending (%.2f / %.2f ms)", workSchedulerStats.pendingCount, workSchedulerStats.workTime * 1000.0, workSchedulerStats.budget * 1000.0);
 					ImGui::Separator();
+					if (env->profiler->isCapturing()) {
+						ImGui::Text("capturing...");
+					}
+					else if (ImGui::Button("Capture")) {
+						env->profiler->capture(5, "profile.json");
+					}
+					std::unique_lock<std::mutex> lock(env->profiler->getTreeMutex());
 					Profiler::Node* node = env->profiler->getRoot();
+					ImGui::Text("P50: %f ms", node->displayStats.p50 * 1000.0f);
+					ImGui::Text("P95: %f ms", node->displayStats.p95 * 1000.0f);
+					ImGui::Text("P99: %f ms", node->displayStats.p99 * 1000.0f);
+					ImGui::Checkbox("Percentiles", &showPercentiles);
+					ImGui::Separator();
 					profilerNode(node, updateDisplayTime);
-#endif
 				}
 				ImGui::End();
 			}
@@ -58,11 +82,11 @@ namespace tri {
 
 			if (updateDisplayTime) {
 				node->displayTime = node->time;
+				node->displayStats = node->stats;
 			}
 
 			if (ImGui::TreeNodeEx(node->name, flags)) {
-				ImGui::SameLine();
-				ImGui::Text("%.3f", node->displayTime * 1000);
+				nodeTime(node);
 
 				std::vector<Profiler::Node*> nodes;
 				for (auto& n : node->nodes) {
@@ -80,7 +104,17 @@ namespace tri {
 				ImGui::TreePop();
 			}
 			else {
-				ImGui::SameLine();
+				nodeTime(node);
+			}
+		}
+
+		void nodeTime(Profiler::Node* node) {
+			ImGui::SameLine();
+			if (showPercentiles) {
+				ImGui::Text("%.3f (p50 %.3f, p95 %.3f, p99 %.3f, max %.3f)", node->displayTime * 1000,
+					node->displayStats.p50 * 1000, node->displayStats.p95 * 1000, node->displayStats.p99 * 1000, node->displayStats.max * 1000);
+			}
+			else {
 				ImGui::Text("%.3f", node->displayTime * 1000);
 			}
 		}
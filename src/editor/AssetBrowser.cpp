@@ -148,7 +148,7 @@ namespace tri {
 							if (ImGui::MenuItem("Add Entity")) {
 								auto prefab = env->assetManager->get<Prefab>(path, AssetManager::Options::SYNCHRONOUS);
 								if (prefab) {
-									std::map<EntityId, EntityId> idMap;
+									EntityIdMap idMap;
 									EntityId id = prefab->createEntity(env->world, -1, &idMap);
 									env->editor->undo->beginAction();
 									for (auto &i : idMap) {
@@ -164,7 +164,7 @@ namespace tri {
 					else {
 						if (ImGui::BeginPopupContextItem()) {
 							if (ImGui::MenuItem("Load")) {
-								env->assetManager->get(id, path);
+								env->assetManager->get(id, path, AssetManager::Options::NO_CANCEL);
 							}
 							bool isLoaded = env->assetManager->getStatus(path) & AssetManager::Status::LOADED;
 							if (ImGui::MenuItem("Unload", nullptr, nullptr, isLoaded)) {
@@ -28,7 +28,7 @@ namespace tri {
 
 	void EntityOperations::duplicateSelection() {
 		if (env->editor->selectionContext->isMultiSelection()) {
-			std::map<EntityId, EntityId> idMap;
+			EntityIdMap idMap;
 
 			env->editor->undo->beginAction();
 			auto selected = env->editor->selectionContext->getSelected();
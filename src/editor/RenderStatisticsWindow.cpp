@@ -67,6 +67,8 @@ namespace tri {
 					ImGui::Checkbox("VSync", env->console->getCVar("vsync")->getPtr<bool>());
 					ImGui::Checkbox("enableTransparency", &env->renderSettings->enableTransparency);
 					ImGui::Checkbox("enableFrustumCulling", &env->renderSettings->enableFrustumCulling);
+					ImGui::Checkbox("enableLod", &env->renderSettings->enableLod);
+					ImGui::SliderFloat("lodErrorThreshold", &env->renderSettings->lodErrorThreshold, 0, 0.05f);
 					ImGui::Checkbox("enablePointLights", &env->renderSettings->enablePointLights);
 					ImGui::Checkbox("enableSpotLights", &env->renderSettings->enableSpotLights);
 
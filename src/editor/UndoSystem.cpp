@@ -167,6 +167,8 @@ namespace tri {
     }
 
     void UndoSystem::componentChanged(int classId, EntityId id, void *preEditValue) {
+        //edits are done in place, so the indexes of the world need to be told
+        env->world->componentChanged(id, classId);
         Ref<Action> action = Ref<Action>::make();
         action->id = id;
         action->classId = classId;
@@ -0,0 +1,326 @@
+//
+// Copyright (c) 2022 Julian Hinxlage. All rights reserved.
+//
+
+#include "AABBTree.h"
+
+namespace tri {
+
+	bool AABB::overlapsSphere(const glm::vec3& center, float radius) const {
+		glm::vec3 closest = glm::clamp(center, min, max);
+		glm::vec3 delta = closest - center;
+		return glm::dot(delta, delta) <= radius * radius;
+	}
+
+	float AABB::rayDistance(const glm::vec3& origin, const glm::vec3& inverseDirection, float maxDistance) const {
+		//slab test, components of the direction that are zero give infinite inverse values
+		glm::vec3 t1 = (min - origin) * inverseDirection;
+		glm::vec3 t2 = (max - origin) * inverseDirection;
+		glm::vec3 tMin = glm::min(t1, t2);
+		glm::vec3 tMax = glm::max(t1, t2);
+		float enter = std::max(std::max(tMin.x, tMin.y), std::max(tMin.z, 0.0f));
+		float exit = std::min(std::min(tMax.x, tMax.y), std::min(tMax.z, maxDistance));
+		if (enter > exit) {
+			return -1;
+		}
+		return enter;
+	}
+
+	AABB AABB::transform(const glm::mat4& matrix) const {
+		//the extent of the transformed box is the sum of the absolute axis contributions
+		glm::vec3 center = glm::vec3(matrix * glm::vec4(this->center(), 1));
+		glm::vec3 extent = (max - min) * 0.5f;
+		glm::vec3 worldExtent =
+			glm::abs(glm::vec3(matrix[0])) * extent.x +
+			glm::abs(glm::vec3(matrix[1])) * extent.y +
+			glm::abs(glm::vec3(matrix[2])) * extent.z;
+		return AABB(center - worldExtent, center + worldExtent);
+	}
+
+	Frustum::Frustum(const glm::mat4& viewProjection) {
+		glm::vec4 row0(viewProjection[0][0], viewProjection[1][0], viewProjection[2][0], viewProjection[3][0]);
+		glm::vec4 row1(viewProjection[0][1], viewProjection[1][1], viewProjection[2][1], viewProjection[3][1]);
+		glm::vec4 row2(viewProjection[0][2], viewProjection[1][2], viewProjection[2][2], viewProjection[3][2]);
+		glm::vec4 row3(viewProjection[0][3], viewProjection[1][3], viewProjection[2][3], viewProjection[3][3]);
+		planes[0] = row3 + row0;
+		planes[1] = row3 - row0;
+		planes[2] = row3 + row1;
+		planes[3] = row3 - row1;
+		planes[4] = row3 + row2;
+		planes[5] = row3 - row2;
+	}
+
+	bool Frustum::overlaps(const AABB& box) const {
+		for (int i = 0; i < 6; i++) {
+			const glm::vec4& plane = planes[i];
+			//the corner of the box that is the furthest in the direction of the plane normal
+			glm::vec3 corner(
+				plane.x >= 0 ? box.max.x : box.min.x,
+				plane.y >= 0 ? box.max.y : box.min.y,
+				plane.z >= 0 ? box.max.z : box.min.z
+			);
+			if (glm::dot(glm::vec3(plane), corner) + plane.w < 0) {
+				return false;
+			}
+		}
+		return true;
+	}
+
+	int AABBTree::insert(const AABB& box, EntityId id) {
+		int leaf = allocateNode();
+		nodes[leaf].box = box;
+		nodes[leaf].id = id;
+		nodes[leaf].height = 0;
+		insertLeaf(leaf);
+		leafCount++;
+		return leaf;
+	}
+
+	void AABBTree::remove(int leaf) {
+		removeLeaf(leaf);
+		freeNode(leaf);
+		leafCount--;
+	}
+
+	void AABBTree::clear() {
+		nodes.clear();
+		root = -1;
+		freeList = -1;
+		leafCount = 0;
+	}
+
+	void AABBTree::rebuild() {
+		std::vector<int> leaves;
+		leaves.reserve(leafCount);
+		for (int i = 0; i < nodes.size(); i++) {
+			if (nodes[i].height == -1) {
+				continue;
+			}
+			if (nodes[i].isLeaf()) {
+				nodes[i].parent = -1;
+				leaves.push_back(i);
+			}
+			else {
+				freeNode(i);
+			}
+		}
+		root = leaves.empty() ? -1 : build(leaves.data(), leaves.size());
+		if (root != -1) {
+			nodes[root].parent = -1;
+		}
+	}
+
+	int AABBTree::build(int* leaves, int count) {
+		if (count == 1) {
+			return leaves[0];
+		}
+
+		//split at the median of the box centers along the longest axis
+		AABB centers(nodes[leaves[0]].box.center(), nodes[leaves[0]].box.center());
+		for (int i = 1; i < count; i++) {
+			glm::vec3 center = nodes[leaves[i]].box.center();
+			centers.min = glm::min(centers.min, center);
+			centers.max = glm::max(centers.max, center);
+		}
+		glm::vec3 size = centers.max - centers.min;
+		int axis = size.x > size.y ? (size.x > size.z ? 0 : 2) : (size.y > size.z ? 1 : 2);
+		int half = count / 2;
+		std::nth_element(leaves, leaves + half, leaves + count, [&](int a, int b) {
+			return nodes[a].box.center()[axis] < nodes[b].box.center()[axis];
+		});
+
+		int child1 = build(leaves, half);
+		int child2 = build(leaves + half, count - half);
+		int node = allocateNode();
+		nodes[node].child1 = child1;
+		nodes[node].child2 = child2;
+		nodes[node].box = nodes[child1].box.merge(nodes[child2].box);
+		nodes[node].height = 1 + std::max(nodes[child1].height, nodes[child2].height);
+		nodes[node].parent = -1;
+		nodes[child1].parent = node;
+		nodes[child2].parent = node;
+		return node;
+	}
+
+	int AABBTree::allocateNode() {
+		if (freeList == -1) {
+			nodes.emplace_back();
+			return nodes.size() - 1;
+		}
+		int node = freeList;
+		freeList = nodes[node].parent;
+		nodes[node] = Node();
+		return node;
+	}
+
+	void AABBTree::freeNode(int node) {
+		nodes[node] = Node();
+		nodes[node].parent = freeList;
+		freeList = node;
+	}
+
+	void AABBTree::insertLeaf(int leaf) {
+		if (root == -1) {
+			root = leaf;
+			nodes[leaf].parent = -1;
+			return;
+		}
+
+		//find the sibling that increases the surface area of the tree the least
+		AABB box = nodes[leaf].box;
+		int index = root;
+		while (!nodes[index].isLeaf()) {
+			const Node& node = nodes[index];
+			float area = node.box.surfaceArea();
+			float combinedArea = node.box.merge(box).surfaceArea();
+
+			//cost of a new parent for this node and the leaf
+			float cost = 2.0f * combinedArea;
+			//cost of pushing the leaf further down the tree
+			float inheritanceCost = 2.0f * (combinedArea - area);
+
+			auto childCost = [&](int child) {
+				const Node& c = nodes[child];
+				float merged = c.box.merge(box).surfaceArea();
+				if (c.isLeaf()) {
+					return merged + inheritanceCost;
+				}
+				return merged - c.box.surfaceArea() + inheritanceCost;
+			};
+			float cost1 = childCost(node.child1);
+			float cost2 = childCost(node.child2);
+
+			if (cost < cost1 && cost < cost2) {
+				break;
+			}
+			index = cost1 < cost2 ? node.child1 : node.child2;
+		}
+
+		int sibling = index;
+		int oldParent = nodes[sibling].parent;
+		int newParent = allocateNode();
+		nodes[newParent].parent = oldParent;
+		nodes[newParent].box = nodes[sibling].box.merge(box);
+		nodes[newParent].height = nodes[sibling].height + 1;
+		nodes[newParent].child1 = sibling;
+		nodes[newParent].child2 = leaf;
+		nodes[sibling].parent = newParent;
+		nodes[leaf].parent = newParent;
+
+		if (oldParent != -1) {
+			if (nodes[oldParent].child1 == sibling) {
+				nodes[oldParent].child1 = newParent;
+			}
+			else {
+				nodes[oldParent].child2 = newParent;
+			}
+		}
+		else {
+			root = newParent;
+		}
+
+		refit(nodes[leaf].parent);
+	}
+
+	void AABBTree::removeLeaf(int leaf) {
+		if (leaf == root) {
+			root = -1;
+			return;
+		}
+
+		int parent = nodes[leaf].parent;
+		int grandParent = nodes[parent].parent;
+		int sibling = nodes[parent].child1 == leaf ? nodes[parent].child2 : nodes[parent].child1;
+
+		if (grandParent != -1) {
+			if (nodes[grandParent].child1 == parent) {
+				nodes[grandParent].child1 = sibling;
+			}
+			else {
+				nodes[grandParent].child2 = sibling;
+			}
+			nodes[sibling].parent = grandParent;
+			freeNode(parent);
+			refit(grandParent);
+		}
+		else {
+			root = sibling;
+			nodes[sibling].parent = -1;
+			freeNode(parent);
+		}
+		nodes[leaf].parent = -1;
+	}
+
+	void AABBTree::refit(int index) {
+		while (index != -1) {
+			index = balance(index);
+			Node& node = nodes[index];
+			node.height = 1 + std::max(nodes[node.child1].height, nodes[node.child2].height);
+			node.box = nodes[node.child1].box.merge(nodes[node.child2].box);
+			index = node.parent;
+		}
+	}
+
+	int AABBTree::balance(int indexA) {
+		Node& a = nodes[indexA];
+		if (a.isLeaf() || a.height < 2) {
+			return indexA;
+		}
+
+		int indexB = a.child1;
+		int indexC = a.child2;
+		Node& b = nodes[indexB];
+		Node& c = nodes[indexC];
+		int difference = c.height - b.height;
+
+		//the higher child is rotated up and takes the place of a
+		auto rotate = [&](int indexUp, Node& up, int indexOther, Node& other, bool upIsChild2) {
+			int indexF = up.child1;
+			int indexG = up.child2;
+			Node& f = nodes[indexF];
+			Node& g = nodes[indexG];
+
+			up.child1 = indexA;
+			up.parent = a.parent;
+			a.parent = indexUp;
+			if (up.parent != -1) {
+				if (nodes[up.parent].child1 == indexA) {
+					nodes[up.parent].child1 = indexUp;
+				}
+				else {
+					nodes[up.parent].child2 = indexUp;
+				}
+			}
+			else {
+				root = indexUp;
+			}
+
+			//the higher grandchild stays below the rotated node, the other one replaces it below a
+			int indexKeep = f.height > g.height ? indexF : indexG;
+			int indexMove = f.height > g.height ? indexG : indexF;
+			up.child2 = indexKeep;
+			if (upIsChild2) {
+				a.child2 = indexMove;
+			}
+			else {
+				a.child1 = indexMove;
+			}
+			nodes[indexMove].parent = indexA;
+
+			a.box = other.box.merge(nodes[indexMove].box);
+			up.box = a.box.merge(nodes[indexKeep].box);
+			a.height = 1 + std::max(other.height, nodes[indexMove].height);
+			up.height = 1 + std::max(a.height, nodes[indexKeep].height);
+			return indexUp;
+		};
+
+		if (difference > 1) {
+			return rotate(indexC, c, indexB, b, true);
+		}
+		if (difference < -1) {
+			return rotate(indexB, b, indexC, c, false);
+		}
+		return indexA;
+	}
+
+}
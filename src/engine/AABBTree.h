@@ -0,0 +1,147 @@
+//
+// Copyright (c) 2022 Julian Hinxlage. All rights reserved.
+//
+
+#pragma once
+
+#include "pch.h"
+#include "core/config.h"
+#include <glm/glm.hpp>
+
+namespace tri {
+
+	class AABB {
+	public:
+		glm::vec3 min;
+		glm::vec3 max;
+
+		AABB(const glm::vec3& min = glm::vec3(0), const glm::vec3& max = glm::vec3(0)) : min(min), max(max) {}
+
+		bool overlaps(const AABB& other) const {
+			return min.x <= other.max.x && max.x >= other.min.x
+				&& min.y <= other.max.y && max.y >= other.min.y
+				&& min.z <= other.max.z && max.z >= other.min.z;
+		}
+		bool contains(const AABB& other) const {
+			return min.x <= other.min.x && max.x >= other.max.x
+				&& min.y <= other.min.y && max.y >= other.max.y
+				&& min.z <= other.min.z && max.z >= other.max.z;
+		}
+		AABB merge(const AABB& other) const {
+			return AABB(glm::min(min, other.min), glm::max(max, other.max));
+		}
+		glm::vec3 center() const {
+			return (min + max) * 0.5f;
+		}
+		float surfaceArea() const {
+			glm::vec3 size = max - min;
+			return 2.0f * (size.x * size.y + size.y * size.z + size.z * size.x);
+		}
+
+		bool overlapsSphere(const glm::vec3& center, float radius) const;
+		//distance along the ray to the box or -1 if the ray misses it within the max distance
+		float rayDistance(const glm::vec3& origin, const glm::vec3& inverseDirection, float maxDistance) const;
+		//bounds of the box after it was transformed by the matrix
+		AABB transform(const glm::mat4& matrix) const;
+	};
+
+	//the six planes of a view projection matrix
+	class Frustum {
+	public:
+		glm::vec4 planes[6];
+
+		Frustum(const glm::mat4& viewProjection);
+		bool overlaps(const AABB& box) const;
+	};
+
+	//dynamic bounding volume hierarchy
+	//leaves are inserted at the cheapest position by surface area and the tree is kept balanced with rotations
+	class AABBTree {
+	public:
+		//returns the leaf node
+		int insert(const AABB& box, EntityId id);
+		void remove(int leaf);
+		void clear();
+		//builds the tree again top down from the current leaves, gives a better tree than incremental inserts
+		void rebuild();
+
+		const AABB& getBox(int node) const {
+			return nodes[node].box;
+		}
+		int size() const {
+			return leafCount;
+		}
+		int getHeight() const {
+			return root == -1 ? 0 : nodes[root].height;
+		}
+
+		//invokes the callback with the id of every leaf whose box passes the overlap test
+		//inner nodes that fail the test are skipped with their subtree
+		template<typename Overlap, typename Func>
+		void query(Overlap overlap, Func callback) const {
+			if (root == -1) {
+				return;
+			}
+			int stack[64];
+			std::vector<int> largeStack;
+			int stackSize = 0;
+			stack[stackSize++] = root;
+			while (stackSize > 0 || !largeStack.empty()) {
+				int index;
+				if (!largeStack.empty()) {
+					index = largeStack.back();
+					largeStack.pop_back();
+				}
+				else {
+					index = stack[--stackSize];
+				}
+				const Node& node = nodes[index];
+				if (!overlap(node.box)) {
+					continue;
+				}
+				if (node.isLeaf()) {
+					callback(node.id);
+				}
+				else if (stackSize + 2 <= 64) {
+					stack[stackSize++] = node.child1;
+					stack[stackSize++] = node.child2;
+				}
+				else {
+					largeStack.push_back(node.child1);
+					largeStack.push_back(node.child2);
+				}
+			}
+		}
+
+	private:
+		class Node {
+		public:
+			AABB box;
+			//next free node for unused nodes
+			int parent = -1;
+			int child1 = -1;
+			int child2 = -1;
+			//0 for leaves, -1 for unused nodes
+			int height = -1;
+			EntityId id = -1;
+
+			bool isLeaf() const {
+				return child1 == -1;
+			}
+		};
+		std::vector<Node> nodes;
+		int root = -1;
+		int freeList = -1;
+		int leafCount = 0;
+
+		int allocateNode();
+		void freeNode(int node);
+		void insertLeaf(int leaf);
+		void removeLeaf(int leaf);
+		//refits the boxes and heights from the node up to the root
+		void refit(int node);
+		int balance(int node);
+		int build(int* leaves, int count);
+	};
+
+}
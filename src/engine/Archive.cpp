@@ -224,7 +224,7 @@ namespace tri {
 	}
 
 	void MemoryArchive::reserve(int bytes) {
-		if (buffer.data() == dataPtr) {
+		if (buffer.data() == dataPtr || dataPtr == nullptr) {
 			buffer.resize(bytes);
 			dataSize = (int)buffer.size();
 			dataPtr = buffer.data();
@@ -8,11 +8,16 @@
 #include "core/util/StrUtil.h"
 #include "core/FileWatcher.h"
 #include "Map.h"
+#include "core/util/Clock.h"
+#include <climits>
 
 namespace tri {
 
     TRI_SYSTEM_INSTANCE(AssetManager, env->assetManager);
 
+    //priority of the asset that is currently loaded by this thread, inherited by the assets it requests
+    static thread_local int loadingPriority = INT_MIN;
+
     uint64_t getTimeStamp(const std::string &file){
         if(!std::filesystem::exists(file)){
             return 0;
@@ -93,8 +98,7 @@ namespace tri {
     Ref<Asset> AssetManager::get(int typeId, const std::string &file, Options options,
         const std::function<bool(Ref<Asset>)> &preLoad, const std::function<bool(Ref<Asset>)> &postLoad) {
 
-        static std::mutex mutex;
-        std::unique_lock<std::mutex> lock(mutex);
+        std::unique_lock<std::mutex> lock(getMutex);
 
         //special case for Map: Map is only loaded if EXPLICIT_LOAD is set
         if (typeId == Reflection::getClassId<Map>()) {
@@ -135,10 +139,18 @@ namespace tri {
                            loadActivate(record);
                        }
                        else {
-                           wakeCondition.notify_one();
+                           enqueueLoad(record, getRequestPriority(options));
                        }
                     }
                 }
+                else if ((record.status & UNLOADED) && !(record.status & FAILED_TO_LOAD) && !(record.options & DO_NOT_LOAD) && asynchronousEnabled) {
+                    //cancelled loads are requested again and queued requests may get a higher priority
+                    int priority = getRequestPriority(options);
+                    if ((record.status & CANCELLED) || priority > record.priority) {
+                        record.options = (Options)(record.options | (options & NO_CANCEL));
+                        enqueueLoad(record, priority);
+                    }
+                }
 
                 return record.asset;
             }else{
@@ -183,8 +195,8 @@ namespace tri {
             lock.unlock();
             load(record);
             loadActivate(record);
-        }else{
-            wakeCondition.notify_one();
+        }else if(!(record.options & DO_NOT_LOAD)){
+            enqueueLoad(record, getRequestPriority(options));
         }
 
         return record.asset;
@@ -215,12 +227,31 @@ namespace tri {
         }
     }
 
+    void AssetManager::setPriority(const std::string &file, int priority) {
+        auto x = assets.find(minimalFilePath(file));
+        if(x != assets.end()){
+            AssetRecord &record = x->second;
+            std::unique_lock<std::mutex> lock(queueMutex);
+            record.priority = priority;
+            if (record.queued) {
+                //the previous entry becomes stale and is skipped
+                record.sequence = nextSequence++;
+                loadQueue.push_back({ record.priority, record.sequence, &record });
+                std::push_heap(loadQueue.begin(), loadQueue.end());
+            }
+        }
+    }
+
     void AssetManager::unload(const std::string &file) {
         std::unique_lock<std::mutex> lock(dataMutex);
         std::string minimalPath = minimalFilePath(file);
         for (auto &iter : assets) {
             auto &record = iter.second;
             if(record.file == minimalPath){
+                //wait for an asset thread that is currently loading the asset
+                while (!removeFromQueues(record)) {
+                    std::this_thread::yield();
+                }
                 assets.erase(record.file);
                 env->console->debug("unloaded asset: %s", minimalPath.c_str());
                 break;
@@ -241,7 +272,7 @@ namespace tri {
             for (auto &iter : assets) {
                 auto &record = iter.second;
                 if (record.status & LOADED) {
-                    if (record.asset.use_count() <= 1) {
+                    if (record.asset.use_count() <= 1 && removeFromQueues(record)) {
                         std::string file = iter.first;
                         assets.erase(iter.first);
                         env->console->debug("unloaded asset: %s", file.c_str());
@@ -267,6 +298,12 @@ namespace tri {
         job->orderSystems({"Window", "AssetManager"});
 
         env->console->addCVar("enableAssetHotReloading", &hotReloadEnabled);
+        env->console->addCVar("assetActivationBudget", &activationBudget);
+        env->console->addCommand("assetQueueInfo", [](auto& args) {
+            env->console->info("asset queue depth: %i, loading: %i, latency avg: %.1f ms, max: %.1f ms",
+                env->assetManager->getQueueDepth(), env->assetManager->getLoadingCount(),
+                env->assetManager->getAverageLatency() * 1000.0, env->assetManager->getMaxLatency() * 1000.0);
+        });
         env->console->addCommand("addAssetDirectory", [](auto& args) {
             if (args.size() > 0) {
                 env->assetManager->addSearchDirectory(args[0]);
@@ -291,33 +328,117 @@ namespace tri {
         running = true;
         for (int i = 0; i < 16; i++) {
             threadIds.push_back(env->threadManager->addThread(std::string("Asset Thread ") + std::to_string(i), [&]() {
-                while (running) {
-                    bool processed = false;
-                    for (auto &iter : assets) {
-                        auto &record = iter.second;
-                        if(!record.locked.exchange(true)) {
-                            if (load(record)) {
-                                processed = true;
-                                record.locked.store(false);
-                                break;
-                            }
-                            record.locked.store(false);
+                while (true) {
+                    AssetRecord* record = nullptr;
+                    {
+                        std::unique_lock<std::mutex> lock(queueMutex);
+                        wakeCondition.wait(lock, [&]() { return !running || !loadQueue.empty(); });
+                        if (!running) {
+                            break;
+                        }
+                        std::pop_heap(loadQueue.begin(), loadQueue.end());
+                        Request request = loadQueue.back();
+                        loadQueue.pop_back();
+                        //entries of records that were requested again with a different priority are stale
+                        if (!request.record->queued || request.record->sequence != request.sequence) {
+                            continue;
                         }
+                        record = request.record;
+                        record->queued = false;
+                        record->locked.store(true);
                     }
 
-                    if (!running) {
-                        break;
+                    if (shouldCancel(*record)) {
+                        record->status = (Status)(record->status | CANCELLED);
+                        env->console->trace("cancelled loading of unused asset: %s", record->file.c_str());
+                    }
+                    else {
+                        loadingPriority = record->priority;
+                        load(*record);
+                        loadingPriority = INT_MIN;
                     }
 
-                    if (!processed) {
-                        std::unique_lock<std::mutex> lock(wakeMutex);
-                        wakeCondition.wait(lock);
+                    bool loaded = (record->status & STATE_LOADED) && !(record->status & FAILED_TO_LOAD);
+                    std::unique_lock<std::mutex> lock(queueMutex);
+                    record->locked.store(false);
+                    if (record->requeue) {
+                        record->requeue = false;
+                        lock.unlock();
+                        enqueueLoad(*record, record->priority);
+                    }
+                    else if (loaded) {
+                        lock.unlock();
+                        enqueueActivate(*record);
                     }
                 }
             }));
         }
     }
 
+    void AssetManager::enqueueLoad(AssetRecord& record, int priority) {
+        std::unique_lock<std::mutex> lock(queueMutex);
+        record.status = (Status)(record.status & ~(int)CANCELLED);
+        if (record.locked) {
+            record.requeue = true;
+            record.priority = std::max(record.priority, priority);
+            return;
+        }
+        if (record.queued) {
+            if (priority <= record.priority) {
+                return;
+            }
+        }
+        else {
+            record.requestTime = Clock::now();
+        }
+        record.priority = priority;
+        record.queued = true;
+        record.sequence = nextSequence++;
+        loadQueue.push_back({ record.priority, record.sequence, &record });
+        std::push_heap(loadQueue.begin(), loadQueue.end());
+        wakeCondition.notify_one();
+    }
+
+    void AssetManager::enqueueActivate(AssetRecord& record) {
+        std::unique_lock<std::mutex> lock(queueMutex);
+        activateQueue.push_back({ record.priority, nextSequence++, &record });
+        std::push_heap(activateQueue.begin(), activateQueue.end());
+    }
+
+    bool AssetManager::removeFromQueues(AssetRecord& record) {
+        std::unique_lock<std::mutex> lock(queueMutex);
+        if (record.locked) {
+            return false;
+        }
+        auto matches = [&](const Request& request) { return request.record == &record; };
+        loadQueue.erase(std::remove_if(loadQueue.begin(), loadQueue.end(), matches), loadQueue.end());
+        std::make_heap(loadQueue.begin(), loadQueue.end());
+        activateQueue.erase(std::remove_if(activateQueue.begin(), activateQueue.end(), matches), activateQueue.end());
+        std::make_heap(activateQueue.begin(), activateQueue.end());
+        record.queued = false;
+        record.requeue = false;
+        return true;
+    }
+
+    bool AssetManager::shouldCancel(AssetRecord& record) {
+        if (record.options & (NO_CANCEL | EXPLICIT_LOAD)) {
+            return false;
+        }
+        //the record itself holds one reference
+        return record.asset.use_count() <= 1;
+    }
+
+    int AssetManager::getRequestPriority(Options options) {
+        int priority = 0;
+        if (options & HIGH_PRIORITY) {
+            priority = 1;
+        }
+        else if (options & LOW_PRIORITY) {
+            priority = -1;
+        }
+        return std::max(priority, loadingPriority);
+    }
+
     void AssetManager::reloadAsset(AssetRecord& record) {
         if (record.options & NO_RELOAD) {
             return;
@@ -333,17 +454,28 @@ namespace tri {
             loadActivate(record);
         }
         else {
-            wakeCondition.notify_one();
+            enqueueLoad(record, record.priority);
         }
     }
 
     void AssetManager::tick() {
         std::unique_lock<std::mutex> lock(dataMutex);
         Clock clock;
-        for(auto &iter : assets) {
-            auto &record = iter.second;
-            if(loadActivate(record)){
-                if(clock.elapsed() > 0.010){
+        //activation needs the render thread, so it can not be moved to the work scheduler
+        double budget = (activationBudget >= 0 ? activationBudget : env->workScheduler->frameBudget) / 1000.0;
+        while (true) {
+            AssetRecord* record = nullptr;
+            {
+                std::unique_lock<std::mutex> queueLock(queueMutex);
+                if (activateQueue.empty()) {
+                    break;
+                }
+                std::pop_heap(activateQueue.begin(), activateQueue.end());
+                record = activateQueue.back().record;
+                activateQueue.pop_back();
+            }
+            if (loadActivate(*record)) {
+                if (clock.elapsed() > budget) {
                     break;
                 }
             }
@@ -351,13 +483,21 @@ namespace tri {
     }
 
     void AssetManager::shutdown() {
-        running = false;
+        {
+            std::unique_lock<std::mutex> lock(queueMutex);
+            running = false;
+        }
         wakeCondition.notify_all();
         for(int threadId : threadIds){
             env->threadManager->joinThread(threadId);
             env->threadManager->terminateThread(threadId);
         }
         threadIds.clear();
+        {
+            std::unique_lock<std::mutex> lock(queueMutex);
+            loadQueue.clear();
+            activateQueue.clear();
+        }
         assets.clear();
     }
 
@@ -428,6 +568,14 @@ namespace tri {
                             record.status = (Status) (record.status | STATE_POST_LOADED);
                             record.status = (Status) (record.status | LOADED);
                             record.status = (Status) (record.status & ~(int) UNLOADED);
+                            if (record.requestTime > 0) {
+                                std::unique_lock<std::mutex> lock(queueMutex);
+                                double latency = Clock::now() - record.requestTime;
+                                latencySum += latency;
+                                latencyMax = std::max(latencyMax, latency);
+                                latencyCount++;
+                                record.requestTime = 0;
+                            }
                             if(record.previousTimeStamp != 0){
                                 env->console->debug("reloaded asset: %s", file.c_str());
                             }else{
@@ -461,7 +609,7 @@ namespace tri {
         for (auto& iter : assets) {
             auto& record = iter.second;
             if (typeId == -1 || record.typeId == typeId) {
-                if (!((record.status & LOADED) || (record.status & FAILED_TO_LOAD) || (record.options & DO_NOT_LOAD))) {
+                if (!((record.status & LOADED) || (record.status & FAILED_TO_LOAD) || (record.status & CANCELLED) || (record.options & DO_NOT_LOAD))) {
                     return true;
                 }
             }
@@ -469,4 +617,33 @@ namespace tri {
         return false;
     }
 
+    int AssetManager::getLoadingCount() {
+        //records are erased under the data mutex and inserted by get, the order is the same as in tick
+        std::unique_lock<std::mutex> lock(dataMutex);
+        std::unique_lock<std::mutex> getLock(getMutex);
+        int count = 0;
+        for (auto& iter : assets) {
+            auto& record = iter.second;
+            if (!((record.status & LOADED) || (record.status & FAILED_TO_LOAD) || (record.status & CANCELLED) || (record.options & DO_NOT_LOAD))) {
+                count++;
+            }
+        }
+        return count;
+    }
+
+    int AssetManager::getQueueDepth() {
+        std::unique_lock<std::mutex> lock(queueMutex);
+        return loadQueue.size() + activateQueue.size();
+    }
+
+    double AssetManager::getAverageLatency() {
+        std::unique_lock<std::mutex> lock(queueMutex);
+        return latencyCount > 0 ? latencySum / latencyCount : 0;
+    }
+
+    double AssetManager::getMaxLatency() {
+        std::unique_lock<std::mutex> lock(queueMutex);
+        return latencyMax;
+    }
+
 }
@@ -28,6 +28,8 @@ namespace tri {
             STATE_ACTIVATED = 64,
             STATE_POST_LOADED = 128,
             SHOULD_NOT_LOAD = 256,
+            //the load was dropped because the asset was not referenced anymore, it is requested again on the next get
+            CANCELLED = 512,
         };
 
         enum Options {
@@ -37,8 +39,16 @@ namespace tri {
             NO_RELOAD_ONCE = 1 << 2,
             DO_NOT_LOAD = 1 << 3,
             EXPLICIT_LOAD = 1 << 4,
+            //keep loading even if no reference to the asset is left, explicit loads are never cancelled
+            NO_CANCEL = 1 << 5,
+            HIGH_PRIORITY = 1 << 6,
+            LOW_PRIORITY = 1 << 7,
         };
 
+        //milliseconds per frame for activating loaded assets on the main thread
+        //a negative value uses the frame budget of the work scheduler
+        float activationBudget = 10;
+
         AssetManager();
         void addSearchDirectory(const std::string &directory);
         void removeSearchDirectory(const std::string &directory);
@@ -69,6 +79,8 @@ namespace tri {
         std::string getFile(Ref<Asset> asset);
         Status getStatus(const std::string &file);
         void setOptions(const std::string &file, Options options);
+        //requests with a higher priority are loaded first, dependencies loaded by an asset inherit its priority
+        void setPriority(const std::string &file, int priority);
         void unload(const std::string& file);
         void reload(const std::string &file);
         std::vector<std::string> getAssetList(int typeId = -1);
@@ -77,6 +89,13 @@ namespace tri {
         //if they get used again, they get loaded again
         void unloadAllUnused();
         bool isLoadingInProcess(int typeId = -1);
+        //number of assets that are waiting to be loaded or activated
+        int getLoadingCount();
+        //number of requests waiting for an asset thread or for activation
+        int getQueueDepth();
+        //seconds from the request of an asset until it is activated
+        double getAverageLatency();
+        double getMaxLatency();
         bool isUsed(const std::string& file);
 
         void init() override;
@@ -97,7 +116,31 @@ namespace tri {
             uint64_t previousTimeStamp;
             std::function<bool(Ref<Asset>)> preLoad;
             std::function<bool(Ref<Asset>)> postLoad;
+            //set while an asset thread loads the record
             std::atomic_bool locked;
+
+            //queue state, guarded by the queue mutex
+            int priority = 0;
+            bool queued = false;
+            //requested again while being loaded
+            bool requeue = false;
+            uint64_t sequence = 0;
+            double requestTime = 0;
+        };
+
+        class Request {
+        public:
+            int priority;
+            uint64_t sequence;
+            AssetRecord* record;
+
+            //max heap on the priority, equal priorities are processed in request order
+            bool operator<(const Request& other) const {
+                if (priority != other.priority) {
+                    return priority < other.priority;
+                }
+                return sequence > other.sequence;
+            }
         };
 
         std::vector<std::string> searchDirectories;
@@ -106,14 +149,30 @@ namespace tri {
 
         std::vector<int> threadIds;
         bool running;
-        std::mutex wakeMutex;
         std::condition_variable wakeCondition;
         std::mutex dataMutex;
+        //guards get, which inserts new records into the assets
+        std::mutex getMutex;
+
+        //records are referenced by pointer, they are removed from the queues before being erased
+        std::vector<Request> loadQueue;
+        std::vector<Request> activateQueue;
+        std::mutex queueMutex;
+        uint64_t nextSequence = 0;
 
+        double latencySum = 0;
+        double latencyMax = 0;
+        int latencyCount = 0;
 
         bool load(AssetRecord &record);
         bool loadActivate(AssetRecord &record);
         void reloadAsset(AssetRecord& record);
+        void enqueueLoad(AssetRecord& record, int priority);
+        void enqueueActivate(AssetRecord& record);
+        //returns false if the record is currently loaded by an asset thread
+        bool removeFromQueues(AssetRecord& record);
+        bool shouldCancel(AssetRecord& record);
+        int getRequestPriority(Options options);
     };
 
 }
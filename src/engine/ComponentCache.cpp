@@ -11,6 +11,19 @@ namespace tri {
 	TRI_SYSTEM(ComponentCache);
 
 	void ComponentCache::init() {
+		//pending copies into a destroyed world are cancelled and the caches of the world are dropped
+		worldDestroyListener = env->eventManager->onWorldDestroy.addListener([&](World* world) {
+			std::erase_if(copyWorks, [&](const CopyWork& work) {
+				if (work.to == world) {
+					env->workScheduler->cancelWork(work.workId);
+					return true;
+				}
+				return false;
+			});
+			std::erase_if(caches, [&](const std::shared_ptr<Cache>& cache) {
+				return cache->world == world;
+			});
+		});
 		if (enableComponentCaching) {
 			unregisterListener = env->eventManager->onClassUnregister.addListener([&](int classId) {
 				auto* desc = Reflection::getDescriptor(classId);
@@ -40,6 +53,7 @@ namespace tri {
 			});
 			registerListener = env->eventManager->onClassRegister.addListener([&](int classId) {
 				env->eventManager->postTick.addListener([&, classId]() {
+					finishPendingCopies();
 					auto* desc = Reflection::getDescriptor(classId);
 					if (desc && (desc->flags & ClassDescriptor::COMPONENT)) {
 						for (auto* world : World::getAllWorlds()) {
@@ -64,6 +78,11 @@ namespace tri {
 	void ComponentCache::shutdown() {
 		env->eventManager->onClassUnregister.removeListener(unregisterListener);
 		env->eventManager->onClassRegister.removeListener(registerListener);
+		env->eventManager->onWorldDestroy.removeListener(worldDestroyListener);
+		for (auto& work : copyWorks) {
+			env->workScheduler->cancelWork(work.workId);
+		}
+		copyWorks.clear();
 	}
 
 	ComponentCache::Cache* ComponentCache::getCache(World* world, int classId, bool create) {
@@ -103,6 +122,7 @@ namespace tri {
 
 	void ComponentCache::serialize(EntityId id, World* world, SerialData& data) {
 		if (enableComponentCaching) {
+			finishPendingCopies();
 			for (auto& cache : caches) {
 				if (cache->world == world) {
 					auto i = cache->data.find(id);
@@ -117,15 +137,38 @@ namespace tri {
 
 	void ComponentCache::copyWorld(World* from, World* to) {
 		if (enableComponentCaching) {
-			auto tmp = caches;
-			for (auto& cache : tmp) {
-				if (cache->world == from) {
+			auto pending = std::make_shared<std::vector<std::shared_ptr<Cache>>>();
+			for (auto& cache : caches) {
+				if (cache->world == from && !cache->data.empty()) {
+					pending->push_back(cache);
+				}
+			}
+			if (pending->empty()) {
+				return;
+			}
+			std::erase_if(copyWorks, [](const CopyWork& work) {
+				return env->workScheduler->isWorkFinished(work.workId);
+			});
+			int workId = env->workScheduler->addWork("ComponentCache copy world", [this, pending, to]() {
+				if (!pending->empty()) {
+					auto cache = pending->back();
+					pending->pop_back();
+					auto* toCache = getCache(to, cache->componentName, true);
 					for (auto& i : cache->data) {
-						auto* toCache = getCache(to, cache->componentName, true);
 						toCache->data[i.first] = i.second;
 					}
 				}
-			}
+				return pending->empty();
+			});
+			copyWorks.push_back({ workId, to });
+		}
+	}
+
+	void ComponentCache::finishPendingCopies() {
+		auto works = copyWorks;
+		copyWorks.clear();
+		for (auto& work : works) {
+			env->workScheduler->finishWork(work.workId);
 		}
 	}
 
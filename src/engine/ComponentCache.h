@@ -19,7 +19,9 @@ namespace tri {
 
 		void addComponent(EntityId id, World* world, const std::string &componentName, const std::string& data);
 		void serialize(EntityId id, World* world, SerialData &data);
+		//the copy is done in the background, one component type per step
 		void copyWorld(World* from, World* to);
+		void finishPendingCopies();
 
 	private:
 		class Cache {
@@ -31,6 +33,13 @@ namespace tri {
 		std::vector<std::shared_ptr<Cache>> caches;
 		int registerListener = -1;
 		int unregisterListener = -1;
+		int worldDestroyListener = -1;
+		class CopyWork {
+		public:
+			int workId;
+			World* to;
+		};
+		std::vector<CopyWork> copyWorks;
 
 		Cache* getCache(World* world, int classId, bool create);
 		Cache* getCache(World *world, const std::string& componentName, bool create);
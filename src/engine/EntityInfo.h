@@ -9,6 +9,7 @@
 
 namespace tri {
 
+    //name and guid are indexed for the lookups in EntityUtil, call world->componentChanged<EntityInfo>(id) after changing them in place
     class EntityInfo {
     public:
         std::string name;
@@ -4,51 +4,37 @@
 
 #include "EntityUtil.h"
 #include "core/core.h"
-#include "engine/RuntimeMode.h"
 #include "engine/EntityInfo.h"
 
 namespace tri {
 	
 	std::function<bool(Guid guid)> isOwningFunction;
 
-	void eachProperty(int classId, void* comp, std::function<void(void* prop, int classId)> callback) {
-		auto* desc = Reflection::getDescriptor(classId);
-		if (desc) {
-			if (desc->flags & ClassDescriptor::VECTOR) {
-				int size = desc->vectorSize(comp);
-				for (int i = 0; i < size; i++) {
-					void* elm = desc->vectorGet(comp, i);
-					callback((uint8_t*)elm, desc->elementType->classId);
-					eachProperty(desc->elementType->classId, elm, callback);
-				}
-			}
-			for (auto& prop : desc->properties) {
-				callback((uint8_t*)comp + prop.offset, prop.type->classId);
-				eachProperty(prop.type->classId, (uint8_t*)comp + prop.offset, callback);
-			}
+	void EntityUtil::replaceIds(const EntityIdMap& idMap, World* world) {
+		if (idMap.empty()) {
+			return;
 		}
-	}
-
-	void EntityUtil::replaceIds(const std::map<EntityId, EntityId>& idMap, World* world) {
-		for (auto& i : idMap) {
-			for (auto* desc : Reflection::getDescriptors()) {
-				if (desc) {
-					if (desc->flags & ClassDescriptor::COMPONENT) {
-						void* comp = world->getComponent(i.second, desc->classId);
-						if (!comp) {
-							comp = world->getComponentPending(i.second, desc->classId);
-						}
-						if (comp) {
-							eachProperty(desc->classId, comp, [&](void* prop, int classId) {
-								if (classId == Reflection::getClassId<EntityId>()) {
-									EntityId* id = (EntityId*)prop;
-									auto j = idMap.find(*id);
-									if (j != idMap.end()) {
-										*id = j->second;
-									}
-								}
-							});
-						}
+		int entityIdClassId = Reflection::getClassId<EntityId>();
+		for (auto* desc : Reflection::getDescriptors()) {
+			if (desc && (desc->flags & ClassDescriptor::COMPONENT)) {
+				//only components that contain entity ids are visited
+				const FieldLayout& layout = Reflection::getFieldLayout(desc->classId, entityIdClassId);
+				if (layout.empty()) {
+					continue;
+				}
+				for (auto& i : idMap) {
+					void* comp = world->getComponent(i.second, desc->classId);
+					if (!comp) {
+						comp = world->getComponentPending(i.second, desc->classId);
+					}
+					if (comp) {
+						layout.each(comp, [&](void* field) {
+							EntityId* id = (EntityId*)field;
+							auto j = idMap.find(*id);
+							if (j != idMap.end()) {
+								*id = j->second;
+							}
+						});
 					}
 				}
 			}
@@ -95,67 +81,13 @@ namespace tri {
 		return "";
 	}
 
-	class EntityUtilSystem : public System {
-	public:
-		std::map<Guid, EntityId> guidMap;
-		std::unordered_map<std::string, EntityId> nameMap;
-
-		void init() override {
-			env->systemManager->addSystem<RuntimeMode>();
-			env->runtimeMode->setActiveSystem<EntityUtilSystem>({ RuntimeMode::LOADING, RuntimeMode::EDIT, RuntimeMode::PAUSED }, true);
-		}
-
-		void startup() {
-			env->eventManager->onMapBegin.addListener([&](World *world, std::string file) {
-				if (world == env->world) {
-					std::map<Guid, EntityId> tmpGuidMap;
-					std::unordered_map<std::string, EntityId> tmpNameMap;
-
-					env->world->each<const EntityInfo>([&](EntityId id, EntityInfo& info) {
-						tmpGuidMap[info.guid] = id;
-						tmpNameMap[info.name] = id;
-					});
-
-				guidMap.swap(tmpGuidMap);
-				nameMap.swap(tmpNameMap);
-				}
-			});
-			env->eventManager->onComponentAdd<EntityInfo>().addListener([&](World *world, EntityId id) {
-				if (world == env->world) {
-					if (EntityInfo* info = env->world->getComponent<EntityInfo>(id)) {
-						guidMap[info->guid] = id;
-						nameMap[info->name] = id;
-					}
-				}
-			});
-			env->eventManager->onComponentRemove<EntityInfo>().addListener([&](World* world, EntityId id) {
-				if (world == env->world) {
-					if (EntityInfo* info = env->world->getComponent<EntityInfo>(id)) {
-						guidMap.erase(info->guid);
-						nameMap.erase(info->name);
-					}
-				}
-			});
-		}
-	};
-	TRI_SYSTEM(EntityUtilSystem);
-
+	//the indexes are created on first use, the world keeps them up to date from then on
 	EntityId EntityUtil::getEntityByGuid(Guid guid) {
-		auto &map = env->systemManager->getSystem<EntityUtilSystem>()->guidMap;
-		auto entry = map.find(guid);
-		if (entry == map.end()) {
-			return -1;
-		}
-		return entry->second;
+		return env->world->addIndex<EntityInfo>(&EntityInfo::guid)->find(guid);
 	}
 
 	EntityId EntityUtil::getEntityByName(const std::string& name) {
-		auto& map = env->systemManager->getSystem<EntityUtilSystem>()->nameMap;
-		auto entry = map.find(name);
-		if (entry == map.end()) {
-			return -1;
-		}
-		return entry->second;
+		return env->world->addIndex<EntityInfo>(&EntityInfo::name)->find(name);
 	}
 
 	bool EntityUtil::isEntityOwning(EntityId id) {
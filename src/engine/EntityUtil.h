@@ -14,7 +14,7 @@ namespace tri {
 
 	class EntityUtil {
 	public:
-		static void replaceIds(const std::map<EntityId, EntityId>& idMap, World* world);
+		static void replaceIds(const EntityIdMap& idMap, World* world);
 		static void removeEntityWithChilds(EntityId id);
 		static void eachChild(EntityId id, bool recursive, const std::function<void(EntityId id)>& callback);
 
@@ -36,7 +36,9 @@ namespace tri {
 		static Guid getGuid(EntityId id);
 		static const std::string &getName(EntityId id);
 
+		//lookups use indexes on EntityInfo, in place edits of the name or guid need a world->componentChanged<EntityInfo>(id)
 		static EntityId getEntityByGuid(Guid guid);
+		//with duplicate names the first match is returned
 		static EntityId getEntityByName(const std::string &name);
 		static bool isEntityOwning(EntityId id);
 		static bool isEntityOwning(Guid guid);
@@ -15,13 +15,13 @@ namespace tri {
 
 	TRI_ASSET(Prefab);
 
-	EntityId Prefab::createEntity(World* world, EntityId hint, std::map<EntityId, EntityId>* idMap) {
+	EntityId Prefab::createEntity(World* world, EntityId hint, EntityIdMap* idMap) {
 		if (!world) {
 			world = env->world;
 		}
 		EntityId id = world->addEntity(hint);
 
-		std::map<EntityId, EntityId> idMapLocal;
+		EntityIdMap idMapLocal;
 		if (!idMap) {
 			idMap = &idMapLocal;
 		}
@@ -37,12 +37,148 @@ namespace tri {
 		return id;
 	}
 
+	std::vector<EntityId> Prefab::instantiate(World* world, int count, const Transform* transforms) {
+		if (!world) {
+			world = env->world;
+		}
+		std::vector<EntityId> roots;
+		if (count <= 0) {
+			return roots;
+		}
+		TRI_PROFILE_FUNC();
+		const Template& temp = compile();
+		int nodeCount = temp.nodes.size();
+
+		//the ids are stored node major, so that the copies of one node are contiguous for the bulk adds
+		std::vector<EntityId> ids(nodeCount * count);
+		world->addEntities(ids.data(), ids.size());
+		for (auto& comp : temp.components) {
+			world->addComponents(ids.data() + comp.node * count, count, comp.classId, comp.data);
+		}
+
+		//references to entities of the prefab are replaced with the entities of the same copy
+		for (auto& fixup : temp.fixups) {
+			auto& comp = temp.components[fixup.component];
+			EntityId value = *(const EntityId*)((const uint8_t*)comp.data + fixup.offset);
+			auto target = temp.nodeBySourceId.find(value);
+			if (target == temp.nodeBySourceId.end()) {
+				continue;
+			}
+			const EntityId* sourceIds = ids.data() + comp.node * count;
+			const EntityId* targetIds = ids.data() + target->second * count;
+			for (int i = 0; i < count; i++) {
+				if (uint8_t* data = (uint8_t*)world->getComponentPending(sourceIds[i], comp.classId)) {
+					*(EntityId*)(data + fixup.offset) = targetIds[i];
+				}
+			}
+		}
+		for (auto& comp : temp.components) {
+			if (!comp.hasVectors) {
+				continue;
+			}
+			const FieldLayout& layout = Reflection::getFieldLayout<EntityId>(comp.classId);
+			const EntityId* sourceIds = ids.data() + comp.node * count;
+			for (int i = 0; i < count; i++) {
+				if (void* data = world->getComponentPending(sourceIds[i], comp.classId)) {
+					layout.each(data, [&](void* field) {
+						auto target = temp.nodeBySourceId.find(*(EntityId*)field);
+						if (target != temp.nodeBySourceId.end()) {
+							*(EntityId*)field = ids[target->second * count + i];
+						}
+					});
+				}
+			}
+		}
+
+		for (int node = 0; node < nodeCount; node++) {
+			const EntityId* nodeIds = ids.data() + node * count;
+			int parent = temp.nodes[node].parent;
+			if (parent != -1 && temp.transforms[node] != -1) {
+				for (int i = 0; i < count; i++) {
+					if (Transform* t = world->getComponentPending<Transform>(nodeIds[i])) {
+						t->parent = ids[parent * count + i];
+					}
+				}
+			}
+			if (temp.entityInfos[node] != -1) {
+				for (int i = 0; i < count; i++) {
+					if (auto* info = world->getComponentPending<EntityInfo>(nodeIds[i])) {
+						info->guid = env->random->getGuid();
+					}
+				}
+			}
+		}
+
+		roots.assign(ids.begin(), ids.begin() + count);
+		if (transforms) {
+			for (int i = 0; i < count; i++) {
+				if (Transform* t = world->getComponentPending<Transform>(roots[i])) {
+					*t = transforms[i];
+				}
+				else {
+					world->addComponent<Transform>(roots[i], transforms[i]);
+				}
+			}
+		}
+		return roots;
+	}
+
+	const Prefab::Template& Prefab::compile() {
+		if (compiled && isCompiledValid()) {
+			return *compiled;
+		}
+		compiled = std::make_shared<Template>();
+		compileNode(*compiled, -1);
+		return *compiled;
+	}
+
+	bool Prefab::isCompiledValid() {
+		for (auto& node : compiled->nodes) {
+			if (node.prefab->version != node.version) {
+				return false;
+			}
+		}
+		return true;
+	}
+
+	void Prefab::compileNode(Template& temp, int parent) {
+		int node = temp.nodes.size();
+		temp.nodes.push_back({ this, version, parent });
+		temp.entityInfos.push_back(-1);
+		temp.transforms.push_back(-1);
+		if (entityId != -1) {
+			temp.nodeBySourceId[entityId] = node;
+		}
+
+		for (auto& buffer : components) {
+			int index = temp.components.size();
+			const FieldLayout& layout = Reflection::getFieldLayout<EntityId>(buffer.classId);
+			temp.components.push_back({ node, buffer.classId, buffer.data, !layout.vectors.empty() });
+			for (int offset : layout.offsets) {
+				temp.fixups.push_back({ index, offset });
+			}
+			if (buffer.classId == Reflection::getClassId<EntityInfo>()) {
+				temp.entityInfos[node] = index;
+			}
+			else if (buffer.classId == Reflection::getClassId<Transform>()) {
+				temp.transforms[node] = index;
+			}
+		}
+
+		for (auto& child : childs) {
+			if (child) {
+				child->compileNode(temp, node);
+			}
+		}
+	}
+
 	void Prefab::copyEntity(EntityId id, World* world, bool includeChilds) {
 		if (!world) {
 			world = env->world;
 		}
 		clear();
 		entityId = id;
+		version++;
 		for (auto* desc : Reflection::getDescriptors()) {
 			if (desc && desc->flags & ClassDescriptor::COMPONENT) {
 				void *comp = world->getComponent(id, desc->classId);
@@ -58,7 +194,7 @@ namespace tri {
 		}
 	}
 
-	void Prefab::copyIntoEntity(EntityId id, World* world, bool includeChilds, std::map<EntityId, EntityId> *idMap) {
+	void Prefab::copyIntoEntity(EntityId id, World* world, bool includeChilds, EntityIdMap *idMap) {
 		if (!world) {
 			world = env->world;
 		}
@@ -88,6 +224,7 @@ namespace tri {
 	}
 
 	void* Prefab::addComponent(int classId, const void* ptr) {
+		version++;
 		for (int i = 0; i < components.size(); i++) {
 			if (components[i].classId == classId) {
 				Reflection::getDescriptor(classId)->copy(ptr, components[i].data);
@@ -113,6 +250,7 @@ namespace tri {
 	void Prefab::removeComponent(int classId) {
 		for (int i = 0; i < components.size(); i++) {
 			if (components[i].classId == classId) {
+				version++;
 				components[i].clear();
 				components.erase(components.begin() + i);
 				break;
@@ -123,12 +261,14 @@ namespace tri {
 	Prefab* Prefab::addChild() {
 		auto child = Ref<Prefab>::make();
 		childs.push_back(child);
+		version++;
 		return child.get();
 	}
 
 	void Prefab::clear() {
 		components.clear();
 		childs.clear();
+		version++;
 	}
 
 	const std::vector<DynamicObjectBuffer>& Prefab::getComponents() {
@@ -145,6 +285,7 @@ namespace tri {
 
 	void Prefab::setEntityId(EntityId id) {
 		entityId = id;
+		version++;
 	}
 
 	bool Prefab::load(const std::string& file) {
@@ -11,11 +11,17 @@
 
 namespace tri {
 
+	class Transform;
+
 	class Prefab : public Asset {
 	public:
-		EntityId createEntity(World* world = nullptr, EntityId hint = -1, std::map<EntityId, EntityId>* idMap = nullptr);
+		EntityId createEntity(World* world = nullptr, EntityId hint = -1, EntityIdMap* idMap = nullptr);
 		void copyEntity(EntityId id, World* world = nullptr, bool includeChilds = false);
-		void copyIntoEntity(EntityId id, World* world = nullptr, bool includeChilds = false, std::map<EntityId, EntityId>* idMap = nullptr);
+		void copyIntoEntity(EntityId id, World* world = nullptr, bool includeChilds = false, EntityIdMap* idMap = nullptr);
+		//creates count copies of the prefab including its childs and returns the root entities
+		//the copies are created with the bulk operations of the world from a compiled template of the prefab
+		//if transforms is not null the root transform of copy i is set to transforms[i]
+		std::vector<EntityId> instantiate(World* world, int count, const Transform* transforms = nullptr);
 
 		template<typename T>
 		T* addComponent(const T& t = T()) {
@@ -46,7 +52,50 @@ namespace tri {
 	private:
 		std::vector<DynamicObjectBuffer> components;
 		std::vector<Ref<Prefab>> childs;
-		EntityId entityId;
+		EntityId entityId = -1;
+
+		//flattened prefab hierarchy, rebuild when the structure of the prefab or one of its childs changed
+		class Template {
+		public:
+			class Node {
+			public:
+				Prefab* prefab;
+				int version;
+				//index of the parent node or -1 for the root
+				int parent;
+			};
+			class Component {
+			public:
+				int node;
+				int classId;
+				const void* data;
+				//the component has entity ids inside of std::vector fields, these are remapped for every copy
+				//the layout itself is looked up when instantiating, because the layout cache is cleared when classes change
+				bool hasVectors;
+			};
+			//entity id field at a fixed offset inside of a component
+			class Fixup {
+			public:
+				int component;
+				int offset;
+			};
+			//nodes in pre order, the root is the first node
+			std::vector<Node> nodes;
+			std::vector<Component> components;
+			std::vector<Fixup> fixups;
+			//index of the node for the entity id of every prefab in the hierarchy
+			std::unordered_map<EntityId, int> nodeBySourceId;
+			//component index of the EntityInfo and Transform of every node or -1
+			std::vector<int> entityInfos;
+			std::vector<int> transforms;
+		};
+		std::shared_ptr<Template> compiled;
+		//incremented on every structural change
+		int version = 0;
+
+		const Template& compile();
+		bool isCompiledValid();
+		void compileNode(Template& temp, int parent);
 	};
 
 }
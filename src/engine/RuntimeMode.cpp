@@ -68,6 +68,16 @@ namespace tri {
 		else {
 			setAllActive(true);
 		}
+
+		for (auto& suspended : suspendedSystems) {
+			auto* desc = Reflection::getDescriptor(suspended);
+			if (desc) {
+				auto* system = env->systemManager->getSystemHandle(desc->classId);
+				if (system) {
+					system->active = false;
+				}
+			}
+		}
 	}
 
 	void RuntimeMode::setMode(Mode mode) {
@@ -80,6 +90,24 @@ namespace tri {
 		env->eventManager->onRuntimeModeChange.invoke(previousMode, mode);
 	}
 
+	void RuntimeMode::setSuspended(const std::string& systemName, bool suspended) {
+		if (suspended) {
+			if (!suspendedSystems.insert(systemName).second) {
+				return;
+			}
+		}
+		else {
+			if (suspendedSystems.erase(systemName) == 0) {
+				return;
+			}
+		}
+		updateActive();
+	}
+
+	bool RuntimeMode::isSuspended(const std::string& systemName) {
+		return suspendedSystems.contains(systemName);
+	}
+
 	void RuntimeMode::setActiveSystem(Mode mode, const std::string& systemName, bool active) {
 		auto &context = modeContexts[mode];
 		if (active) {
@@ -29,6 +29,10 @@ namespace tri {
 		void setActiveSystem(const std::vector<Mode>& modes, const std::string& systemName, bool active);
 		void setActiveSystems(const std::vector<Mode> &modes, const std::vector<std::string>& systemNames, bool active);
 
+		//suspended systems are inactive in every mode until they are resumed
+		void setSuspended(const std::string& systemName, bool suspended);
+		bool isSuspended(const std::string& systemName);
+
 		template<typename T>
 		void setActiveSystem(Mode mode, bool active) {
 			setActiveSystem(mode, Reflection::getDescriptor<T>()->name, active);
@@ -57,6 +61,7 @@ namespace tri {
 		};
 
 		std::unordered_map<Mode, ModeContext> modeContexts;
+		std::unordered_set<std::string> suspendedSystems;
 
 		void setAllActive(bool active);
 		void updateActive();
@@ -160,7 +160,7 @@ namespace tri {
 		*data.emitter << YAML::EndMap;
 	}
 
-	void Serializer::deserializeEntity(EntityId id, World* world, SerialData& data, std::map<EntityId, EntityId>* idMap) {
+	void Serializer::deserializeEntity(EntityId id, World* world, SerialData& data, EntityIdMap* idMap) {
 		bool active = data.node["active"].as<bool>(true);
 		EntityId hint = data.node["id"].as<int>(-1);
 
@@ -192,7 +192,7 @@ namespace tri {
 	}
 
 
-	void Serializer::deserializeEntity(World* world, SerialData& data, std::map<EntityId, EntityId> *idMap) {
+	void Serializer::deserializeEntity(World* world, SerialData& data, EntityIdMap *idMap) {
 		EntityId id = data.node["id"].as<int>(-1);
 		id = world->addEntity(id);
 		deserializeEntity(id, world, data, idMap);
@@ -498,11 +498,9 @@ namespace tri {
 			if (v->classId != -1) {
 				auto* desc = Reflection::getDescriptor(v->classId);
 				if (desc) {
-					for (int i = 0; i < desc->properties.size(); i++) {
-						if (desc->properties[i].name == property) {
-							v->propertyIndex = i;
-							break;
-						}
+					int index = desc->getPropertyIndex(hashName(property));
+					if (index != -1) {
+						v->propertyIndex = index;
 					}
 				}
 			}
@@ -577,18 +575,18 @@ namespace tri {
 		for (auto* desc : Reflection::getDescriptors()) {
 			if (desc && desc->flags & ClassDescriptor::COMPONENT) {
 				if (void* comp = world->getComponent(id, desc->classId)) {
-					archive.writeStr(desc->name);
+					archive.writeBin(desc->nameHash);
 					archive.writeClass(comp, desc->classId);
 				}
 			}
 		}
 	}
 
-	void Serializer::deserializeEntityBinary(World* world, Archive& memoryArchive, std::map<EntityId, EntityId>* idMap) {
+	void Serializer::deserializeEntityBinary(World* world, Archive& memoryArchive, EntityIdMap* idMap) {
 		deserializeEntityBinary(-1, world, memoryArchive, idMap);
 	}
 
-	void Serializer::deserializeEntityBinary(EntityId id, World* world, Archive& memoryArchive, std::map<EntityId, EntityId>* idMap) {
+	void Serializer::deserializeEntityBinary(EntityId id, World* world, Archive& memoryArchive, EntityIdMap* idMap) {
 		BinaryArchive archive;
 		archive.bytesArchive = &memoryArchive;
 
@@ -603,14 +601,14 @@ namespace tri {
 		}
 
 		while(archive.hasDataLeft()){
-			std::string name;
-			archive.readStr(name);
+			uint64_t nameHash = 0;
+			archive.readBin(nameHash);
 
-			if (name == "") {
+			if (nameHash == 0) {
 				break;
 			}
 
-			auto* desc = Reflection::getDescriptor(name);
+			auto* desc = Reflection::getDescriptorByHash(nameHash);
 			if (desc) {
 				void* comp = world->getOrAddComponentPending(id, desc->classId);
 				archive.readClass(comp, desc->classId);
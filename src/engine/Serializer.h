@@ -31,8 +31,8 @@ namespace tri {
 		void deserializeClass(int classId, void *ptr, SerialData& data);
 		
 		void serializeEntity(EntityId id, World *world, SerialData& data, bool replication = false);
-		void deserializeEntity(World* world, SerialData& data, std::map<EntityId, EntityId>* idMap = nullptr);
-		void deserializeEntity(EntityId id, World* world, SerialData& data, std::map<EntityId, EntityId>* idMap = nullptr);
+		void deserializeEntity(World* world, SerialData& data, EntityIdMap* idMap = nullptr);
+		void deserializeEntity(EntityId id, World* world, SerialData& data, EntityIdMap* idMap = nullptr);
 
 		void serializePrefab(Prefab *prefab, SerialData& data);
 		void deserializePrefab(Prefab* prefab, SerialData& data);
@@ -50,8 +50,8 @@ namespace tri {
 		void addDeserializeCallback(int classId, const std::function<void(void* ptr, SerialData& data)>& callback);
 
 		void serializeEntityBinary(EntityId id, World* world, Archive &archive);
-		void deserializeEntityBinary(World* world, Archive& archive, std::map<EntityId, EntityId>* idMap = nullptr);
-		void deserializeEntityBinary(EntityId id, World* world, Archive& archive, std::map<EntityId, EntityId>* idMap = nullptr);
+		void deserializeEntityBinary(World* world, Archive& archive, EntityIdMap* idMap = nullptr);
+		void deserializeEntityBinary(EntityId id, World* world, Archive& archive, EntityIdMap* idMap = nullptr);
 		
 		void serializeWorldBinary(World* world, const std::string& file);
 		bool deserializeWorldBinary(World* world, const std::string& file);
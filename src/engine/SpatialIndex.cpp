@@ -0,0 +1,393 @@
+//
+// Copyright (c) 2022 Julian Hinxlage. All rights reserved.
+//
+
+#include "SpatialIndex.h"
+#include "entity/World.h"
+#include "engine/Transform.h"
+#include "engine/MeshComponent.h"
+#include "engine/Time.h"
+#include "core/util/Clock.h"
+#include <glm/gtc/matrix_transform.hpp>
+#include <random>
+
+namespace tri {
+
+	TRI_SYSTEM_INSTANCE(SpatialIndex, env->spatialIndex);
+
+	void SpatialIndex::init() {
+		env->console->addCVar("spatialIndex", &enabled);
+		env->console->addCVar("spatialIndexMargin", &margin);
+		env->console->addCVar("spatialIndexRefitInterval", &refitInterval);
+		env->console->addCommand("spatialIndexRebuild", [&](auto& args) {
+			needsRebuild = true;
+		});
+		env->console->addCommand("spatialIndexStats", [&](auto& args) {
+			env->console->info("spatial index: %i entities, height %i, %i pending", tree.size(), tree.getHeight(), (int)pendingIds.size());
+		});
+		env->console->addCommand("spatialIndexBenchmark", [&](auto& args) {
+			int count = 100000;
+			if (args.size() > 0) {
+				try {
+					count = std::stoi(args[0]);
+				}
+				catch (...) {}
+			}
+			benchmark(count);
+		});
+
+		//meshes that are not loaded or created yet have no bounds, entities without a mesh are drawn as quad with the default bounds
+		addBoundsProvider<MeshComponent>([](EntityId id, glm::vec3& min, glm::vec3& max) {
+			MeshComponent* mesh = env->world->getComponent<MeshComponent>(id);
+			if (!mesh) {
+				return false;
+			}
+			if (mesh->mesh) {
+				if (mesh->mesh->changeCounter == 0) {
+					return false;
+				}
+				min = mesh->mesh->boundingMin;
+				max = mesh->mesh->boundingMax;
+			}
+			else {
+				min = { -0.5, -0.5, -0.5 };
+				max = { +0.5, +0.5, +0.5 };
+			}
+			return true;
+		});
+
+		postTickListener = env->eventManager->postTick.addListener([&]() {
+			update();
+		});
+		entityRemoveListener = env->eventManager->onEntityRemove.addListener([&](World* world, EntityId id) {
+			if (world == this->world) {
+				removeEntity(id);
+			}
+		});
+		mapBeginListener = env->eventManager->onMapBegin.addListener([&](World* world, const std::string& file) {
+			needsRebuild = true;
+		});
+	}
+
+	void SpatialIndex::shutdown() {
+		env->eventManager->postTick.removeListener(postTickListener);
+		env->eventManager->onEntityRemove.removeListener(entityRemoveListener);
+		env->eventManager->onMapBegin.removeListener(mapBeginListener);
+		while (!providers.empty()) {
+			removeBoundsProvider(providers.back().classId);
+		}
+		tree.clear();
+		entityNodes.clear();
+		entityBounds.clear();
+		entityMeshes.clear();
+	}
+
+	void SpatialIndex::addBoundsProvider(int classId, const BoundsCallback& callback) {
+		removeBoundsProvider(classId);
+		Provider provider;
+		provider.classId = classId;
+		provider.callback = callback;
+		provider.addListener = env->eventManager->onComponentAdd(classId).addListener([&](World* world, EntityId id) {
+			if (world == env->world) {
+				markChanged(id);
+			}
+		});
+		provider.removeListener = env->eventManager->onComponentRemove(classId).addListener([&](World* world, EntityId id) {
+			if (world == env->world) {
+				markChanged(id);
+			}
+		});
+		providers.push_back(provider);
+		needsRebuild = true;
+	}
+
+	void SpatialIndex::removeBoundsProvider(int classId) {
+		for (int i = 0; i < providers.size(); i++) {
+			if (providers[i].classId == classId) {
+				env->eventManager->onComponentAdd(classId).removeListener(providers[i].addListener);
+				env->eventManager->onComponentRemove(classId).removeListener(providers[i].removeListener);
+				providers.erase(providers.begin() + i);
+				needsRebuild = true;
+				break;
+			}
+		}
+	}
+
+	void SpatialIndex::markChanged(EntityId id) {
+		std::unique_lock<std::mutex> lock(changedMutex);
+		changedIds.push_back(id);
+	}
+
+	void SpatialIndex::rebuild() {
+		TRI_PROFILE_FUNC();
+		tree.clear();
+		entityNodes.clear();
+		entityBounds.clear();
+		entityMeshes.clear();
+		pendingIds.clear();
+		refitCursor = 0;
+		world = env->world;
+		needsRebuild = false;
+		{
+			std::unique_lock<std::mutex> lock(changedMutex);
+			changedIds.clear();
+		}
+		if (!world || !enabled) {
+			return;
+		}
+
+		for (auto& provider : providers) {
+			if (ComponentStorage* storage = world->getComponentStorage(provider.classId)) {
+				EntityId* ids = storage->getIdData();
+				for (int i = 0; i < storage->size(); i++) {
+					if (!contains(ids[i])) {
+						bool pending = false;
+						updateEntity(ids[i], pending);
+						if (pending) {
+							pendingIds.push_back(ids[i]);
+						}
+					}
+				}
+			}
+		}
+		//a top down build gives a better tree than the incremental inserts
+		tree.rebuild();
+	}
+
+	bool SpatialIndex::isMeshCurrent(EntityId id, const Mesh* mesh) const {
+		if (!contains(id)) {
+			return false;
+		}
+		const MeshState& meshState = entityMeshes[id];
+		return meshState.mesh == mesh && (!mesh || meshState.changeCounter == mesh->changeCounter);
+	}
+
+	EntityId SpatialIndex::rayCast(const glm::vec3& origin, const glm::vec3& direction, float maxDistance, float* hitDistance) const {
+		EntityId hit = -1;
+		float nearest = maxDistance;
+		queryRay(origin, direction, maxDistance, [&](EntityId id, float distance) {
+			if (distance <= nearest) {
+				nearest = distance;
+				hit = id;
+			}
+		});
+		if (hitDistance) {
+			*hitDistance = nearest;
+		}
+		return hit;
+	}
+
+	void SpatialIndex::update() {
+		TRI_PROFILE_FUNC();
+		if (!enabled) {
+			if (tree.size() > 0 || world) {
+				tree.clear();
+				entityNodes.clear();
+				entityBounds.clear();
+				entityMeshes.clear();
+				pendingIds.clear();
+				world = nullptr;
+			}
+			needsRebuild = true;
+			std::unique_lock<std::mutex> lock(changedMutex);
+			changedIds.clear();
+			return;
+		}
+		if (needsRebuild || world != env->world) {
+			rebuild();
+			return;
+		}
+		if (!world) {
+			return;
+		}
+
+		std::vector<EntityId> ids;
+		{
+			std::unique_lock<std::mutex> lock(changedMutex);
+			ids.swap(changedIds);
+		}
+		ids.insert(ids.end(), pendingIds.begin(), pendingIds.end());
+		pendingIds.clear();
+		for (EntityId id : Transform::getChangedEntities()) {
+			if (contains(id)) {
+				ids.push_back(id);
+			}
+		}
+
+		//a slice of all entities is checked every frame, so that every entity is checked once per refit interval
+		if (refitInterval > 0 && !entityNodes.empty()) {
+			int count = (int)std::ceil(entityNodes.size() * env->time->deltaTime / refitInterval);
+			count = std::min(count, (int)entityNodes.size());
+			for (int i = 0; i < count; i++) {
+				refitCursor = (refitCursor + 1) % entityNodes.size();
+				if (entityNodes[refitCursor] != -1) {
+					ids.push_back(refitCursor);
+				}
+			}
+		}
+
+		std::sort(ids.begin(), ids.end());
+		ids.erase(std::unique(ids.begin(), ids.end()), ids.end());
+		for (EntityId id : ids) {
+			bool pending = false;
+			updateEntity(id, pending);
+			if (pending) {
+				pendingIds.push_back(id);
+			}
+		}
+	}
+
+	void SpatialIndex::updateEntity(EntityId id, bool& pending) {
+		AABB bounds;
+		if (!calculateBounds(id, bounds, pending)) {
+			removeEntity(id);
+			return;
+		}
+
+		if (entityNodes.size() <= id) {
+			entityNodes.resize(id + 1, -1);
+			entityBounds.resize(id + 1);
+			entityMeshes.resize(id + 1);
+		}
+		entityBounds[id] = bounds;
+		MeshState& meshState = entityMeshes[id];
+		MeshComponent* meshComponent = world->getComponent<MeshComponent>(id);
+		meshState.mesh = meshComponent ? meshComponent->mesh.get() : nullptr;
+		meshState.changeCounter = meshState.mesh ? meshState.mesh->changeCounter : 0;
+		int node = entityNodes[id];
+		if (node != -1) {
+			//the stored box is kept as long as it contains the bounds and is not much larger than needed
+			const AABB& box = tree.getBox(node);
+			if (box.contains(bounds) && box.surfaceArea() <= enlarge(bounds).surfaceArea() * 2.0f) {
+				return;
+			}
+			tree.remove(node);
+		}
+		entityNodes[id] = tree.insert(enlarge(bounds), id);
+	}
+
+	bool SpatialIndex::calculateBounds(EntityId id, AABB& bounds, bool& pending) {
+		Transform* transform = world->getComponent<Transform>(id);
+		if (!transform) {
+			return false;
+		}
+		bool found = false;
+		for (auto& provider : providers) {
+			if (world->hasComponent(id, provider.classId)) {
+				AABB local;
+				if (provider.callback(id, local.min, local.max)) {
+					AABB box = local.transform(transform->getMatrix());
+					bounds = found ? bounds.merge(box) : box;
+					found = true;
+				}
+				else {
+					pending = true;
+				}
+			}
+		}
+		return found;
+	}
+
+	void SpatialIndex::removeEntity(EntityId id) {
+		if (contains(id)) {
+			tree.remove(entityNodes[id]);
+			entityNodes[id] = -1;
+		}
+	}
+
+	AABB SpatialIndex::enlarge(const AABB& bounds) {
+		glm::vec3 extent = (bounds.max - bounds.min) * margin + glm::vec3(0.01f);
+		return AABB(bounds.min - extent, bounds.max + extent);
+	}
+
+	void SpatialIndex::benchmark(int count) {
+		//synthetic scene of small boxes in a cube, independent of the world
+		std::mt19937 random(0);
+		float worldSize = std::cbrt((float)count) * 10.0f;
+		std::uniform_real_distribution<float> position(0, worldSize);
+		std::uniform_real_distribution<float> size(0.5f, 3.0f);
+		std::uniform_real_distribution<float> movement(-0.2f, 0.2f);
+
+		std::vector<AABB> bounds(count);
+		for (auto& box : bounds) {
+			box.min = glm::vec3(position(random), position(random), position(random));
+			box.max = box.min + glm::vec3(size(random), size(random), size(random));
+		}
+
+		AABBTree benchmarkTree;
+		std::vector<int> nodes(count);
+		Clock clock;
+		for (int i = 0; i < count; i++) {
+			nodes[i] = benchmarkTree.insert(enlarge(bounds[i]), i);
+		}
+		env->console->info("insert %i boxes: %.2f ms, height %i", count, clock.round() * 1000.0, benchmarkTree.getHeight());
+
+		benchmarkTree.rebuild();
+		env->console->info("rebuild: %.2f ms, height %i", clock.round() * 1000.0, benchmarkTree.getHeight());
+
+		int moved = 0;
+		for (int i = 0; i < count; i++) {
+			glm::vec3 offset(movement(random), movement(random), movement(random));
+			bounds[i].min += offset;
+			bounds[i].max += offset;
+			if (!benchmarkTree.getBox(nodes[i]).contains(bounds[i])) {
+				benchmarkTree.remove(nodes[i]);
+				nodes[i] = benchmarkTree.insert(enlarge(bounds[i]), i);
+				moved++;
+			}
+		}
+		env->console->info("move all boxes: %.2f ms, %i reinserted", clock.round() * 1000.0, moved);
+
+		const int queryCount = 1000;
+		int hits = 0;
+		for (int i = 0; i < queryCount; i++) {
+			glm::vec3 center(position(random), position(random), position(random));
+			AABB box(center - glm::vec3(10), center + glm::vec3(10));
+			benchmarkTree.query([&](const AABB& node) { return node.overlaps(box); }, [&](EntityId id) {
+				if (bounds[id].overlaps(box)) {
+					hits++;
+				}
+			});
+		}
+		env->console->info("%i box queries: %.2f ms, %i hits", queryCount, clock.round() * 1000.0, hits);
+
+		hits = 0;
+		for (int i = 0; i < queryCount; i++) {
+			glm::vec3 center(position(random), position(random), position(random));
+			benchmarkTree.query([&](const AABB& node) { return node.overlapsSphere(center, 10); }, [&](EntityId id) {
+				if (bounds[id].overlapsSphere(center, 10)) {
+					hits++;
+				}
+			});
+		}
+		env->console->info("%i sphere queries: %.2f ms, %i hits", queryCount, clock.round() * 1000.0, hits);
+
+		hits = 0;
+		for (int i = 0; i < queryCount; i++) {
+			glm::vec3 eye(position(random), position(random), position(random));
+			glm::vec3 target(position(random), position(random), position(random));
+			glm::mat4 viewProjection = glm::perspective(glm::radians(60.0f), 16.0f / 9.0f, 0.1f, 100.0f) * glm::lookAt(eye, target, { 0, 1, 0 });
+			Frustum frustum(viewProjection);
+			benchmarkTree.query([&](const AABB& node) { return frustum.overlaps(node); }, [&](EntityId id) {
+				if (frustum.overlaps(bounds[id])) {
+					hits++;
+				}
+			});
+		}
+		env->console->info("%i frustum queries: %.2f ms, %i hits", queryCount, clock.round() * 1000.0, hits);
+
+		hits = 0;
+		for (int i = 0; i < queryCount; i++) {
+			glm::vec3 origin(position(random), position(random), position(random));
+			glm::vec3 direction = glm::normalize(glm::vec3(movement(random), movement(random), movement(random)) + glm::vec3(0.001f));
+			glm::vec3 inverseDirection = 1.0f / direction;
+			benchmarkTree.query([&](const AABB& node) { return node.rayDistance(origin, inverseDirection, 1000) >= 0; }, [&](EntityId id) {
+				if (bounds[id].rayDistance(origin, inverseDirection, 1000) >= 0) {
+					hits++;
+				}
+			});
+		}
+		env->console->info("%i ray queries: %.2f ms, %i hits", queryCount, clock.round() * 1000.0, hits);
+	}
+
+}
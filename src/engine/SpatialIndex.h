@@ -0,0 +1,144 @@
+//
+// Copyright (c) 2022 Julian Hinxlage. All rights reserved.
+//
+
+#pragma once
+
+#include "pch.h"
+#include "core/core.h"
+#include "AABBTree.h"
+
+namespace tri {
+
+	class Mesh;
+
+	//world space bounds of the entities in the main world (env->world), used for culling and proximity queries
+	//the index is updated on the main thread after the tick, queries are safe from any system during the tick
+	class SpatialIndex : public System {
+	public:
+		bool enabled = true;
+		//the boxes in the tree are enlarged by this factor of their size, so that small movements do not change the tree
+		float margin = 0.1f;
+		//seconds until all bounds where checked again, catches changes that are not reported (e.g. a reloaded mesh)
+		float refitInterval = 1.0f;
+
+		//returns the local space bounds of a component or false if the bounds are not known yet (e.g. a mesh that is still loading)
+		typedef std::function<bool(EntityId id, glm::vec3& min, glm::vec3& max)> BoundsCallback;
+
+		void init() override;
+		void shutdown() override;
+
+		//entities with one of the components are indexed, the bounds of multiple components are merged
+		void addBoundsProvider(int classId, const BoundsCallback& callback);
+		void removeBoundsProvider(int classId);
+		template<typename T>
+		void addBoundsProvider(const BoundsCallback& callback) {
+			addBoundsProvider(Reflection::getClassId<T>(), callback);
+		}
+		template<typename T>
+		void removeBoundsProvider() {
+			removeBoundsProvider(Reflection::getClassId<T>());
+		}
+
+		//the bounds of the entity are calculated again in the next update, transform changes are detected automatically
+		void markChanged(EntityId id);
+		void rebuild();
+
+		bool contains(EntityId id) const {
+			return id < entityNodes.size() && entityNodes[id] != -1;
+		}
+		const AABB& getBounds(EntityId id) const {
+			return entityBounds[id];
+		}
+		int size() const {
+			return tree.size();
+		}
+		//true if the entity is indexed with the bounds of this mesh and the mesh did not change since then (e.g. a reload)
+		//entities without a mesh are indexed with a null mesh
+		bool isMeshCurrent(EntityId id, const Mesh* mesh) const;
+
+		template<typename Func>
+		void queryBox(const AABB& box, Func callback) const {
+			tree.query([&](const AABB& node) { return node.overlaps(box); }, [&](EntityId id) {
+				if (entityBounds[id].overlaps(box)) {
+					callback(id);
+				}
+			});
+		}
+
+		template<typename Func>
+		void querySphere(const glm::vec3& center, float radius, Func callback) const {
+			tree.query([&](const AABB& node) { return node.overlapsSphere(center, radius); }, [&](EntityId id) {
+				if (entityBounds[id].overlapsSphere(center, radius)) {
+					callback(id);
+				}
+			});
+		}
+
+		template<typename Func>
+		void queryFrustum(const glm::mat4& viewProjection, Func callback) const {
+			Frustum frustum(viewProjection);
+			tree.query([&](const AABB& node) { return frustum.overlaps(node); }, [&](EntityId id) {
+				if (frustum.overlaps(entityBounds[id])) {
+					callback(id);
+				}
+			});
+		}
+
+		//invokes the callback with the entity and the distance along the ray to its bounds, the direction needs to be normalized
+		template<typename Func>
+		void queryRay(const glm::vec3& origin, const glm::vec3& direction, float maxDistance, Func callback) const {
+			glm::vec3 inverseDirection = 1.0f / direction;
+			tree.query([&](const AABB& node) { return node.rayDistance(origin, inverseDirection, maxDistance) >= 0; }, [&](EntityId id) {
+				float distance = entityBounds[id].rayDistance(origin, inverseDirection, maxDistance);
+				if (distance >= 0) {
+					callback(id, distance);
+				}
+			});
+		}
+
+		//returns the entity whose bounds are hit first by the ray or -1
+		EntityId rayCast(const glm::vec3& origin, const glm::vec3& direction, float maxDistance, float* hitDistance = nullptr) const;
+
+	private:
+		AABBTree tree;
+		std::vector<int> entityNodes;
+		std::vector<AABB> entityBounds;
+		//the mesh the bounds of an entity where calculated with
+		class MeshState {
+		public:
+			const Mesh* mesh = nullptr;
+			int changeCounter = 0;
+		};
+		std::vector<MeshState> entityMeshes;
+		World* world = nullptr;
+		bool needsRebuild = true;
+		int refitCursor = 0;
+
+		class Provider {
+		public:
+			int classId;
+			BoundsCallback callback;
+			int addListener = -1;
+			int removeListener = -1;
+		};
+		std::vector<Provider> providers;
+
+		std::vector<EntityId> changedIds;
+		std::mutex changedMutex;
+		//entities whose bounds where not known yet
+		std::vector<EntityId> pendingIds;
+
+		int postTickListener = -1;
+		int entityRemoveListener = -1;
+		int mapBeginListener = -1;
+
+		void update();
+		void updateEntity(EntityId id, bool& pending);
+		bool calculateBounds(EntityId id, AABB& bounds, bool& pending);
+		void removeEntity(EntityId id);
+		AABB enlarge(const AABB& bounds);
+		void benchmark(int count);
+	};
+
+}
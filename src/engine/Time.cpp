@@ -54,6 +54,11 @@ namespace tri {
         maxDeltaTime = 0.2;
         pause = false;
         frameRateLimit = -1;
+        framePacing = true;
+        framePacingPhaseLock = true;
+        idleFrameRateLimit = 2;
+        idle = false;
+        wakeRequested = false;
 
         //stats
         framesPerSecond = 0;
@@ -70,6 +75,15 @@ namespace tri {
 
     void Time::init() {
         env->console->addCVar("frameRateLimit", &frameRateLimit);
+        env->console->addCVar("framePacing", &framePacing);
+        env->console->addCVar("framePacingPhaseLock", &framePacingPhaseLock);
+        env->console->addCVar("idleFrameRateLimit", &idleFrameRateLimit);
+        env->console->addCommand("framePacingStats", [&](auto& args) {
+            auto& stats = pacer.getStats();
+            env->console->info("frame pacing: period %.3f ms, error avg %.1f us max %.1f us, %lld late frames of %lld",
+                pacer.getPeriod() * 1000.0, stats.avgError * 1e6, stats.maxError * 1e6, (long long)stats.lateCount, (long long)(stats.count + stats.lateCount));
+            pacer.resetStats();
+        });
 
         class Replay {
         public:
@@ -129,16 +143,40 @@ namespace tri {
 
     void Time::tick() {
         //frame/delta time
-        if (frameRateLimit > 0) {            
+        float measuredFrameTime = 0;
+        if (idle && idleFrameRateLimit > 0) {
+            double sleepTime = (1.0 / idleFrameRateLimit) - clock.elapsed();
+            if (sleepTime > 0) {
+                std::unique_lock<std::mutex> lock(wakeMutex);
+                wakeCondition.wait_for(lock, std::chrono::duration<double>(sleepTime), [&]() { return wakeRequested.load(); });
+            }
+            wakeRequested = false;
+            measuredFrameTime = frameTime = (float)clock.round();
+            //the paced deadlines continue from the next boundary after waking up
+            pacer.restart();
+            env->workScheduler->setFrameDeadline(0);
+        }
+        else if (frameRateLimit > 0 && framePacing) {
+            pacer.setPeriod(1.0 / frameRateLimit);
+            pacer.wait();
+            measuredFrameTime = (float)clock.round();
+            //phase locked frame times are measured from deadline to deadline, so the time stays in sync with the clock
+            double pacedFrameTime = pacer.getFrameTime();
+            frameTime = (framePacingPhaseLock && pacedFrameTime >= 0) ? (float)pacedFrameTime : measuredFrameTime;
+            env->workScheduler->setFrameDeadline(Clock::now() + pacer.getTimeUntilDeadline());
+        }
+        else if (frameRateLimit > 0) {
             frameTime = (float)clock.elapsed();
             float sleepTime = (1.0f / frameRateLimit) - frameTime;
             if (sleepTime > 0) {
                 preciseSleep(sleepTime);
             }
-            frameTime = (float)clock.round();
+            measuredFrameTime = frameTime = (float)clock.round();
+            env->workScheduler->setFrameDeadline(Clock::now() + 1.0 / frameRateLimit);
         }
         else {
-            frameTime = (float)clock.round();
+            measuredFrameTime = frameTime = (float)clock.round();
+            env->workScheduler->setFrameDeadline(0);
         }
 
         if (env->runtimeMode->getMode() == RuntimeMode::PLAY) {
@@ -155,11 +193,11 @@ namespace tri {
         lastFrameTimeAccumulator = frameTimeAccumulator;
         deltaTimeAccumulator += deltaTime;
         frameTimeAccumulator += frameTime;
-        time = frameTimeAccumulator;
-        inGameTime = deltaTimeAccumulator;
+        time = (float)frameTimeAccumulator;
+        inGameTime = (float)deltaTimeAccumulator;
 
         //stats
-        frameTimes.push_back(frameTime);
+        frameTimes.push_back(measuredFrameTime);
         minFrameTime = INFINITY;
         maxFrameTime = -INFINITY;
         float sum = 0;
@@ -176,9 +214,18 @@ namespace tri {
         framesPerSecond = 1.0f / avgFrameTime;
     }
 
+    void Time::wakeUp() {
+        {
+            std::unique_lock<std::mutex> lock(wakeMutex);
+            wakeRequested = true;
+        }
+        wakeCondition.notify_all();
+    }
+
     int Time::frameTicks(float interval, float offset) {
-        int ticks1 = (int)((lastFrameTimeAccumulator + offset) / interval);
-        int ticks2 = (int)((frameTimeAccumulator + offset) / interval);
+        //the epsilon keeps phase locked frames from landing just below a tick boundary
+        int ticks1 = (int)((lastFrameTimeAccumulator + offset) / interval + 1e-6);
+        int ticks2 = (int)((frameTimeAccumulator + offset) / interval + 1e-6);
         return ticks2 - ticks1;
     }
 
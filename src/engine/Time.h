@@ -6,6 +6,8 @@
 
 #include "pch.h"
 #include "core/core.h"
+#include "core/util/FramePacer.h"
+#include <atomic>
 
 namespace tri {
 
@@ -23,6 +25,13 @@ namespace tri {
         float maxDeltaTime;
         bool pause;
         float frameRateLimit;
+        //wait for absolute deadlines instead of sleeping for the remaining frame time
+        bool framePacing;
+        //measure the frame time from deadline to deadline, so that interval ticks stay in phase without drifting from the clock
+        bool framePacingPhaseLock;
+        //frame rate while idle, the idle wait can be interrupted with wakeUp
+        float idleFrameRateLimit;
+        bool idle;
 
         //stats
         float framesPerSecond;
@@ -38,14 +47,21 @@ namespace tri {
         //utility
         int frameTicks(float interval, float offset = 0);
         int deltaTicks(float interval, float offset = 0);
+        const FramePacer::Stats& getFramePacingStats() { return pacer.getStats(); }
+        //ends the current idle wait early, can be called from any thread
+        void wakeUp();
 
     private:
         Clock clock;
+        FramePacer pacer;
         std::vector<float> frameTimes;
-        float frameTimeAccumulator;
-        float deltaTimeAccumulator;
-        float lastFrameTimeAccumulator;
-        float lastDeltaTimeAccumulator;
+        double frameTimeAccumulator;
+        double deltaTimeAccumulator;
+        double lastFrameTimeAccumulator;
+        double lastDeltaTimeAccumulator;
+        std::mutex wakeMutex;
+        std::condition_variable wakeCondition;
+        std::atomic<bool> wakeRequested;
     };
 
 }
@@ -7,8 +7,8 @@
 #include "core/core.h"
 #include "entity/World.h"
 #include "engine/Time.h"
+#include "TransformBatch.h"
 #include <glm/gtc/matrix_transform.hpp>
-#include <glm/glm/gtx/matrix_decompose.hpp>
 
 namespace tri {
 
@@ -17,24 +17,25 @@ namespace tri {
         parent = -1;
         matrix = glm::mat4(0);
         parentMatrix = glm::mat4(1);
+        worldRotation = glm::quat(1, 0, 0, 0);
+        worldScale = glm::vec3(0);
+        rotationQuat = glm::quat(1, 0, 0, 0);
     }
 
     glm::vec3 Transform::getWorldPosition() const {
-        Transform t;
-        t.decompose(getMatrix());
-        return t.position;
+        return glm::vec3(matrix[3]);
     }
 
     glm::vec3 Transform::getWorldScale() const {
-        Transform t;
-        t.decompose(getMatrix());
-        return t.scale;
+        return worldScale;
     }
 
     glm::vec3 Transform::getWorldRotation() const {
-        Transform t;
-        t.decompose(getMatrix());
-        return t.rotation;
+        return glm::eulerAngles(worldRotation);
+    }
+
+    glm::quat Transform::getWorldOrientation() const {
+        return worldRotation;
     }
 
     void Transform::setWorldPosition(const glm::vec3& position) {
@@ -71,19 +72,8 @@ namespace tri {
     }
 
     glm::mat4 Transform::calculateLocalMatrix() const {
-        glm::mat4 transform(1);
-        transform = glm::translate(transform, position);
-        if (rotation.z != 0) {
-            transform = glm::rotate(transform, rotation.z, {0, 0, 1});
-        }
-        if (rotation.y != 0) {
-            transform = glm::rotate(transform, rotation.y, {0, 1, 0});
-        }
-        if (rotation.x != 0) {
-            transform = glm::rotate(transform, rotation.x, {1, 0, 0});
-        }
-        transform = glm::scale(transform, scale);
-        return transform;
+        //the quaternion of the euler angles is the same rotation as rotating around z, y and then x
+        return calculateTRSMatrix(position, glm::quat(rotation), scale);
     }
 
     const glm::mat4 &Transform::getMatrix() const {
@@ -92,13 +82,13 @@ namespace tri {
 
     void Transform::setMatrix(const glm::mat4& matrix) {
         this->matrix = matrix;
+        dirty = true;
+        updateWorldComponents();
     }
 
     void Transform::decompose(const glm::mat4 &matrix) {
-        glm::vec3 skew;
-        glm::vec4 perspective;
         glm::quat orentiation;
-        glm::decompose(matrix, scale, orentiation, position, skew, perspective);
+        decomposeAffine(matrix, position, orentiation, scale);
         rotation = glm::eulerAngles(orentiation);
     }
 
@@ -108,6 +98,7 @@ namespace tri {
 
         if (ptrans.scale.x == ptrans.scale.y && ptrans.scale.y == ptrans.scale.z) {
             matrix = parentMatrix * calculateLocalMatrix();
+            updateWorldComponents();
             return;
         }
 
@@ -126,12 +117,34 @@ namespace tri {
         glm::mat4 ps = glm::scale(glm::mat4(1), glm::vec3(uScale));
 
         matrix = pt * prz * pry * prx * ps * t * rz * ry * rx * s;
+        updateWorldComponents();
     }
 
     const glm::mat4& Transform::getParentMatrix() const {
         return parentMatrix;
     }
 
+    //counts the updates of the transform system, transforms that are not reached by an update are not changed in it
+    static uint64_t transformUpdate = 0;
+
+    bool Transform::hasChanged() const {
+        return changedUpdate != 0 && changedUpdate == transformUpdate;
+    }
+
+    void Transform::markDirty() {
+        dirty = true;
+    }
+
+    void Transform::updateWorldComponents() {
+        glm::vec3 worldPosition;
+        decomposeAffine(matrix, worldPosition, worldRotation, worldScale);
+    }
+
+    bool Transform::needsUpdate(EntityId parentId, bool parentChanged) const {
+        return dirty || parentChanged || parentId != cachedParent
+            || position != cachedPosition || scale != cachedScale || rotation != cachedRotation;
+    }
+
     TRI_COMPONENT(Transform);
     TRI_PROPERTY_FLAGS(Transform, position, PropertyDescriptor::REPLICATE);
     TRI_PROPERTY_FLAGS(Transform, scale, PropertyDescriptor::REPLICATE);
@@ -143,6 +156,10 @@ namespace tri {
         std::unordered_map<EntityId, std::vector<EntityId>> childs;
         std::unordered_map<EntityId, std::vector<EntityId>> newChilds;
         std::vector<EntityId> empty;
+        std::vector<EntityId> changedEntities;
+        std::mutex changedMutex;
+        //transforms per task when a hierarchy level is split over the workers
+        int batchSize = 1024;
         int listener = -1;
         int listener2 = -1;
 
@@ -185,50 +202,101 @@ namespace tri {
         void tick() override {
             TRI_PROFILE_FUNC();
             newChilds.clear();
-            std::vector<EntityId> stack;
-            std::vector<glm::mat4> matStack;
-            glm::mat4 parentMat(1);
-            env->world->each<Transform>([&](EntityId tid, Transform& t) {
+            changedEntities.clear();
+            transformUpdate++;
+
+            //the hierarchy is processed level by level, so that the parents of a level are done before it starts
+            //entries are the entity and the parent it was reached from
+            FrameVector<std::pair<EntityId, EntityId>> level(env->frameAllocator->allocator<std::pair<EntityId, EntityId>>());
+            FrameVector<std::pair<EntityId, EntityId>> nextLevel(env->frameAllocator->allocator<std::pair<EntityId, EntityId>>());
+            env->world->each<Transform>([&](EntityId id, Transform& t) {
                 if (t.parent == -1) {
+                    level.push_back({ id, -1 });
+                }
+                else {
+                    newChilds[t.parent].push_back(id);
+                }
+            });
 
-                    t.parentMatrix = glm::mat4(1);
-                    t.matrix = t.calculateLocalMatrix();
-                    parentMat = t.matrix;
-                    for (auto child : getChilds(tid)) {
-                        stack.push_back(child);
-                    }
-
-                    while (!stack.empty()) {
-                        EntityId id = stack.back();
-                        stack.pop_back();
-
-                        if (id == -1) {
-                            parentMat = matStack.back();
-                            matStack.pop_back();
-                            continue;
+            while (!level.empty()) {
+                env->threadManager->parallelFor(level.size(), batchSize, [&](int begin, int end) {
+                    FrameVector<EntityId> changedIds(env->frameAllocator->allocator<EntityId>());
+                    for (int i = begin; i < end;) {
+                        //the transforms that need an update are collected in chunks, so that the local matrices are calculated together
+                        const int chunkSize = 64;
+                        Transform* transforms[chunkSize];
+                        Transform* parents[chunkSize];
+                        glm::vec3 positions[chunkSize];
+                        glm::vec3 scales[chunkSize];
+                        glm::quat rotations[chunkSize];
+                        glm::mat4 matrices[chunkSize];
+                        int count = 0;
+
+                        for (; i < end && count < chunkSize; i++) {
+                            EntityId id = level[i].first;
+                            EntityId parentId = level[i].second;
+                            Transform* t = env->world->getComponent<Transform>(id);
+                            if (!t) {
+                                continue;
+                            }
+                            Transform* parent = parentId == -1 ? nullptr : env->world->getComponent<Transform>(parentId);
+                            if (t->needsUpdate(parentId, parent && parent->hasChanged())) {
+                                if (t->dirty || t->rotation != t->cachedRotation) {
+                                    t->rotationQuat = glm::quat(t->rotation);
+                                }
+                                t->cachedParent = parentId;
+                                transforms[count] = t;
+                                parents[count] = parent;
+                                positions[count] = t->position;
+                                scales[count] = t->scale;
+                                rotations[count] = t->rotationQuat;
+                                count++;
+                                changedIds.push_back(id);
+                            }
                         }
 
-                        Transform* t = env->world->getComponent<Transform>(id);
-                        auto &childs = getChilds(id);
-                        if (t) {
-                            t->parentMatrix = parentMat;
-                            t->updateMatrix();
-                            if (childs.size() > 0) {
-                                matStack.push_back(parentMat);
-                                parentMat = t->matrix;
-                                stack.push_back(-1);
+                        calculateTRSMatrices(positions, rotations, scales, matrices, count);
+
+                        for (int j = 0; j < count; j++) {
+                            Transform* t = transforms[j];
+                            Transform* parent = parents[j];
+                            if (!parent) {
+                                t->parentMatrix = glm::mat4(1);
+                                t->matrix = matrices[j];
+                                t->worldRotation = t->rotationQuat;
+                                t->worldScale = t->scale;
+                            }
+                            else if (parent->worldScale.x == parent->worldScale.y && parent->worldScale.y == parent->worldScale.z) {
+                                t->parentMatrix = parent->matrix;
+                                t->matrix = parent->matrix * matrices[j];
+                                t->updateWorldComponents();
                             }
-                            for (auto child : childs) {
-                                stack.push_back(child);
+                            else {
+                                //non uniform parent scale would skew the child
+                                t->parentMatrix = parent->matrix;
+                                t->updateMatrix();
                             }
+                            t->cachedPosition = t->position;
+                            t->cachedScale = t->scale;
+                            t->cachedRotation = t->rotation;
+                            t->dirty = false;
+                            t->changedUpdate = transformUpdate;
                         }
                     }
+                    if (!changedIds.empty()) {
+                        std::unique_lock<std::mutex> lock(changedMutex);
+                        changedEntities.insert(changedEntities.end(), changedIds.begin(), changedIds.end());
+                    }
+                });
 
+                nextLevel.clear();
+                for (auto& entry : level) {
+                    for (auto child : getChilds(entry.first)) {
+                        nextLevel.push_back({ child, entry.first });
+                    }
                 }
-                else {
-                    newChilds[t.parent].push_back(tid);
-                }
-            });
+                level.swap(nextLevel);
+            }
         }
 
         const std::vector<EntityId>& getChilds(EntityId id) {
@@ -247,4 +315,8 @@ namespace tri {
         return env->systemManager->getSystem<TransformSystem>()->getChilds(id);
     }
 
+    const std::vector<EntityId>& Transform::getChangedEntities() {
+        return env->systemManager->getSystem<TransformSystem>()->changedEntities;
+    }
+
 }
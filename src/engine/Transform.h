@@ -8,6 +8,7 @@
 #include "core/System.h"
 #include "core/config.h"
 #include <glm/glm.hpp>
+#include <glm/gtc/quaternion.hpp>
 
 namespace tri {
 
@@ -23,6 +24,7 @@ namespace tri {
         glm::vec3 getWorldPosition() const;
         glm::vec3 getWorldScale() const;
         glm::vec3 getWorldRotation() const;
+        glm::quat getWorldOrientation() const;
         void setWorldPosition(const glm::vec3& position);
         void setWorldScale(const glm::vec3& scale);
         void setWorldRotation(const glm::vec3& rotation);
@@ -35,12 +37,37 @@ namespace tri {
         void updateMatrix();
         const glm::mat4& getParentMatrix() const;
 
+        //true if the world matrix changed in the last update of the transform system
+        bool hasChanged() const;
+        //forces the matrix to be recalculated, changes of position, scale, rotation and parent are detected automatically
+        void markDirty();
+
         //only for main world (env->world)
         static const std::vector<EntityId>& getChilds(EntityId id);
+        //entities whose world matrix changed in the last update of the transform system
+        static const std::vector<EntityId>& getChangedEntities();
 
     private:
         glm::mat4 matrix;
         glm::mat4 parentMatrix;
+
+        //components of the world matrix, updated together with the matrix so that the world getters do not decompose
+        glm::quat worldRotation;
+        glm::vec3 worldScale;
+
+        //values the matrix was calculated with
+        glm::vec3 cachedPosition;
+        glm::vec3 cachedScale;
+        glm::vec3 cachedRotation;
+        //the rotation as quaternion, only recalculated when the euler angles change
+        glm::quat rotationQuat;
+        EntityId cachedParent = -1;
+        bool dirty = true;
+        //update of the transform system in which the matrix changed last
+        uint64_t changedUpdate = 0;
+
+        bool needsUpdate(EntityId parentId, bool parentChanged) const;
+        void updateWorldComponents();
         friend class TransformSystem;
     };
 
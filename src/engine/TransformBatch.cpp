@@ -0,0 +1,127 @@
+//
+// Copyright (c) 2022 Julian Hinxlage. All rights reserved.
+//
+
+#include "TransformBatch.h"
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define TRI_TRANSFORM_SSE 1
+#include <emmintrin.h>
+#else
+#define TRI_TRANSFORM_SSE 0
+#endif
+
+namespace tri {
+
+    glm::mat4 calculateTRSMatrix(const glm::vec3& position, const glm::quat& rotation, const glm::vec3& scale) {
+        float xx = rotation.x * rotation.x;
+        float yy = rotation.y * rotation.y;
+        float zz = rotation.z * rotation.z;
+        float xy = rotation.x * rotation.y;
+        float xz = rotation.x * rotation.z;
+        float yz = rotation.y * rotation.z;
+        float wx = rotation.w * rotation.x;
+        float wy = rotation.w * rotation.y;
+        float wz = rotation.w * rotation.z;
+
+        glm::mat4 matrix;
+        matrix[0] = glm::vec4(1.0f - 2.0f * (yy + zz), 2.0f * (xy + wz), 2.0f * (xz - wy), 0) * scale.x;
+        matrix[1] = glm::vec4(2.0f * (xy - wz), 1.0f - 2.0f * (xx + zz), 2.0f * (yz + wx), 0) * scale.y;
+        matrix[2] = glm::vec4(2.0f * (xz + wy), 2.0f * (yz - wx), 1.0f - 2.0f * (xx + yy), 0) * scale.z;
+        matrix[3] = glm::vec4(position, 1);
+        return matrix;
+    }
+
+    void calculateTRSMatrices(const glm::vec3* positions, const glm::quat* rotations, const glm::vec3* scales, glm::mat4* matrices, int count) {
+        int i = 0;
+#if TRI_TRANSFORM_SSE
+        const __m128 one = _mm_set1_ps(1.0f);
+        const __m128 two = _mm_set1_ps(2.0f);
+        const __m128 zero = _mm_setzero_ps();
+        for (; i + 4 <= count; i += 4) {
+            const glm::quat* r = rotations + i;
+            const glm::vec3* s = scales + i;
+            const glm::vec3* p = positions + i;
+
+            //the inputs are transposed, so that each register holds one component of four transforms
+            __m128 x = _mm_setr_ps(r[0].x, r[1].x, r[2].x, r[3].x);
+            __m128 y = _mm_setr_ps(r[0].y, r[1].y, r[2].y, r[3].y);
+            __m128 z = _mm_setr_ps(r[0].z, r[1].z, r[2].z, r[3].z);
+            __m128 w = _mm_setr_ps(r[0].w, r[1].w, r[2].w, r[3].w);
+            __m128 sx = _mm_setr_ps(s[0].x, s[1].x, s[2].x, s[3].x);
+            __m128 sy = _mm_setr_ps(s[0].y, s[1].y, s[2].y, s[3].y);
+            __m128 sz = _mm_setr_ps(s[0].z, s[1].z, s[2].z, s[3].z);
+
+            __m128 x2 = _mm_mul_ps(x, two);
+            __m128 y2 = _mm_mul_ps(y, two);
+            __m128 z2 = _mm_mul_ps(z, two);
+            __m128 xx = _mm_mul_ps(x, x2);
+            __m128 yy = _mm_mul_ps(y, y2);
+            __m128 zz = _mm_mul_ps(z, z2);
+            __m128 xy = _mm_mul_ps(x, y2);
+            __m128 xz = _mm_mul_ps(x, z2);
+            __m128 yz = _mm_mul_ps(y, z2);
+            __m128 wx = _mm_mul_ps(w, x2);
+            __m128 wy = _mm_mul_ps(w, y2);
+            __m128 wz = _mm_mul_ps(w, z2);
+
+            __m128 columns[3][4];
+            columns[0][0] = _mm_mul_ps(_mm_sub_ps(one, _mm_add_ps(yy, zz)), sx);
+            columns[0][1] = _mm_mul_ps(_mm_add_ps(xy, wz), sx);
+            columns[0][2] = _mm_mul_ps(_mm_sub_ps(xz, wy), sx);
+            columns[0][3] = zero;
+            columns[1][0] = _mm_mul_ps(_mm_sub_ps(xy, wz), sy);
+            columns[1][1] = _mm_mul_ps(_mm_sub_ps(one, _mm_add_ps(xx, zz)), sy);
+            columns[1][2] = _mm_mul_ps(_mm_add_ps(yz, wx), sy);
+            columns[1][3] = zero;
+            columns[2][0] = _mm_mul_ps(_mm_add_ps(xz, wy), sz);
+            columns[2][1] = _mm_mul_ps(_mm_sub_ps(yz, wx), sz);
+            columns[2][2] = _mm_mul_ps(_mm_sub_ps(one, _mm_add_ps(xx, yy)), sz);
+            columns[2][3] = zero;
+
+            //transposed back, afterwards each register is one column of one matrix
+            for (int c = 0; c < 3; c++) {
+                _MM_TRANSPOSE4_PS(columns[c][0], columns[c][1], columns[c][2], columns[c][3]);
+                for (int j = 0; j < 4; j++) {
+                    _mm_storeu_ps(&matrices[i + j][c][0], columns[c][j]);
+                }
+            }
+            for (int j = 0; j < 4; j++) {
+                matrices[i + j][3] = glm::vec4(p[j], 1);
+            }
+        }
+#endif
+        for (; i < count; i++) {
+            matrices[i] = calculateTRSMatrix(positions[i], rotations[i], scales[i]);
+        }
+    }
+
+    void decomposeAffine(const glm::mat4& matrix, glm::vec3& position, glm::quat& rotation, glm::vec3& scale) {
+        position = glm::vec3(matrix[3]);
+
+        glm::vec3 x = glm::vec3(matrix[0]);
+        glm::vec3 y = glm::vec3(matrix[1]);
+        glm::vec3 z = glm::vec3(matrix[2]);
+
+        //the columns are made orthonormal like glm::decompose does, so that skewed matrices give a valid rotation
+        scale.x = glm::length(x);
+        x = scale.x != 0 ? x / scale.x : glm::vec3(1, 0, 0);
+        y -= x * glm::dot(x, y);
+        scale.y = glm::length(y);
+        y = scale.y != 0 ? y / scale.y : glm::vec3(0, 1, 0);
+        z -= x * glm::dot(x, z);
+        z -= y * glm::dot(y, z);
+        scale.z = glm::length(z);
+        z = scale.z != 0 ? z / scale.z : glm::vec3(0, 0, 1);
+
+        if (glm::dot(x, glm::cross(y, z)) < 0) {
+            scale = -scale;
+            x = -x;
+            y = -y;
+            z = -z;
+        }
+
+        rotation = glm::quat_cast(glm::mat3(x, y, z));
+    }
+
+}
@@ -0,0 +1,23 @@
+//
+// Copyright (c) 2022 Julian Hinxlage. All rights reserved.
+//
+
+#pragma once
+
+#include "pch.h"
+#include <glm/glm.hpp>
+#include <glm/gtc/quaternion.hpp>
+
+namespace tri {
+
+    //calculates translate * rotate * scale matrices for arrays of transforms
+    //four transforms are processed at once with SSE when available
+    void calculateTRSMatrices(const glm::vec3* positions, const glm::quat* rotations, const glm::vec3* scales, glm::mat4* matrices, int count);
+
+    glm::mat4 calculateTRSMatrix(const glm::vec3& position, const glm::quat& rotation, const glm::vec3& scale);
+
+    //splits an affine matrix into position, rotation and scale
+    //cheaper than glm::decompose, because perspective is not handled
+    void decomposeAffine(const glm::mat4& matrix, glm::vec3& position, glm::quat& rotation, glm::vec3& scale);
+
+}
@@ -0,0 +1,47 @@
+//
+// Copyright (c) 2022 Julian Hinxlage. All rights reserved.
+//
+
+#include "ComponentIndex.h"
+#include "ComponentStorage.h"
+
+namespace tri {
+
+	void ComponentIndexBase::rebuild() {
+		std::unique_lock<std::mutex> lock(mutex);
+		dirtyIds.clear();
+		clearEntries();
+		if (storage) {
+			int size = storage->size() + storage->deactiveSize();
+			for (int i = 0; i < size; i++) {
+				updateEntry(storage->getIdByIndex(i), (uint8_t*)storage->getComponentByIndex(i) + offset);
+			}
+		}
+	}
+
+	void* ComponentIndexBase::getField(EntityId id) {
+		if (!storage) {
+			return nullptr;
+		}
+		if (void* comp = storage->getComponentById(id)) {
+			return (uint8_t*)comp + offset;
+		}
+		return nullptr;
+	}
+
+	void ComponentIndexBase::flushDirty() {
+		if (dirtyIds.empty()) {
+			return;
+		}
+		for (EntityId id : dirtyIds) {
+			if (void* field = getField(id)) {
+				updateEntry(id, field);
+			}
+			else {
+				removeEntry(id);
+			}
+		}
+		dirtyIds.clear();
+	}
+
+}
@@ -0,0 +1,259 @@
+//
+// Copyright (c) 2022 Julian Hinxlage. All rights reserved.
+//
+
+#pragma once
+
+#include "pch.h"
+#include "core/config.h"
+
+namespace tri {
+
+	class ComponentStorage;
+
+	//secondary index from the value of a component field to the entities with that value
+	//the storage reports added, removed and changed components, the keys are read lazily before the next lookup
+	//so that components which are filled after being added are indexed with their final value
+	class ComponentIndexBase {
+	public:
+		const int classId;
+		//byte offset of the indexed field inside of the component
+		const int offset;
+
+		ComponentIndexBase(int classId, int offset) : classId(classId), offset(offset) {}
+		virtual ~ComponentIndexBase() {}
+
+		void setStorage(ComponentStorage* storage) {
+			std::unique_lock<std::mutex> lock(mutex);
+			this->storage = storage;
+		}
+		ComponentStorage* getStorage() {
+			return storage;
+		}
+
+		void add(EntityId id) {
+			std::unique_lock<std::mutex> lock(mutex);
+			dirtyIds.push_back(id);
+		}
+		//the value of the field may have changed, it is read again before the next lookup
+		void changed(EntityId id) {
+			std::unique_lock<std::mutex> lock(mutex);
+			dirtyIds.push_back(id);
+		}
+		void remove(EntityId id) {
+			std::unique_lock<std::mutex> lock(mutex);
+			removeEntry(id);
+		}
+		void clear() {
+			std::unique_lock<std::mutex> lock(mutex);
+			dirtyIds.clear();
+			clearEntries();
+		}
+		//indexes all components of the storage
+		void rebuild();
+		//applies the pending changes
+		void flush() {
+			std::unique_lock<std::mutex> lock(mutex);
+			flushDirty();
+		}
+
+	protected:
+		ComponentStorage* storage = nullptr;
+		std::vector<EntityId> dirtyIds;
+		std::mutex mutex;
+
+		//pointer to the indexed field of the entity or nullptr if it has no component
+		void* getField(EntityId id);
+		void flushDirty();
+		virtual void updateEntry(EntityId id, const void* field) = 0;
+		virtual void removeEntry(EntityId id) = 0;
+		virtual void clearEntries() = 0;
+	};
+
+	template<typename Key, typename Hash = std::hash<Key>>
+	class ComponentIndex : public ComponentIndexBase {
+	public:
+		ComponentIndex(int classId, int offset) : ComponentIndexBase(classId, offset) {}
+
+		//returns an entity with the key or -1
+		EntityId find(const Key& key) {
+			std::unique_lock<std::mutex> lock(mutex);
+			flushDirty();
+			for (int retry = 0; retry < 2; retry++) {
+				EntityId id = findEntry(key);
+				if (id == -1) {
+					return -1;
+				}
+				//in place changes that were not reported are detected here and the entry is fixed
+				if (const Key* value = (const Key*)getField(id)) {
+					if (*value == key) {
+						return id;
+					}
+				}
+				dirtyIds.push_back(id);
+				flushDirty();
+			}
+			return -1;
+		}
+
+		//invokes the callback for every entity with the key
+		template<typename Func>
+		void each(const Key& key, Func func) {
+			std::unique_lock<std::mutex> lock(mutex);
+			flushDirty();
+			if (slots.empty()) {
+				return;
+			}
+			size_t hash = Hash()(key);
+			uint32_t mask = slots.size() - 1;
+			for (uint32_t i = hash & mask;; i = (i + 1) & mask) {
+				Slot& slot = slots[i];
+				if (slot.state == EMPTY) {
+					break;
+				}
+				if (slot.state == USED && slot.hash == hash && slot.key == key) {
+					func(slot.id);
+				}
+			}
+		}
+
+		bool contains(const Key& key) {
+			return find(key) != -1;
+		}
+
+		int size() {
+			std::unique_lock<std::mutex> lock(mutex);
+			flushDirty();
+			return count;
+		}
+
+	private:
+		enum State : uint8_t {
+			EMPTY,
+			USED,
+			REMOVED,
+		};
+		class Slot {
+		public:
+			Key key;
+			size_t hash = 0;
+			EntityId id = -1;
+			State state = EMPTY;
+		};
+		//open addressing with linear probing, the size is a power of two
+		std::vector<Slot> slots;
+		int count = 0;
+		int removedCount = 0;
+
+		//the key an entity is currently indexed with, so that it can be removed after the component changed
+		std::vector<Key> entityKeys;
+		std::vector<uint8_t> entityIndexed;
+
+		EntityId findEntry(const Key& key) {
+			if (slots.empty()) {
+				return -1;
+			}
+			size_t hash = Hash()(key);
+			uint32_t mask = slots.size() - 1;
+			for (uint32_t i = hash & mask;; i = (i + 1) & mask) {
+				Slot& slot = slots[i];
+				if (slot.state == EMPTY) {
+					return -1;
+				}
+				if (slot.state == USED && slot.hash == hash && slot.key == key) {
+					return slot.id;
+				}
+			}
+		}
+
+		void insertSlot(const Key& key, size_t hash, EntityId id) {
+			uint32_t mask = slots.size() - 1;
+			for (uint32_t i = hash & mask;; i = (i + 1) & mask) {
+				Slot& slot = slots[i];
+				if (slot.state != USED) {
+					if (slot.state == REMOVED) {
+						removedCount--;
+					}
+					slot.key = key;
+					slot.hash = hash;
+					slot.id = id;
+					slot.state = USED;
+					count++;
+					return;
+				}
+			}
+		}
+
+		void grow() {
+			//keep the load including removed slots below 3/4
+			if ((count + removedCount + 1) * 4 < slots.size() * 3) {
+				return;
+			}
+			size_t capacity = std::max((size_t)16, slots.size());
+			while ((count + 1) * 2 > capacity) {
+				capacity *= 2;
+			}
+			std::vector<Slot> old;
+			old.swap(slots);
+			slots.resize(capacity);
+			count = 0;
+			removedCount = 0;
+			for (auto& slot : old) {
+				if (slot.state == USED) {
+					insertSlot(slot.key, slot.hash, slot.id);
+				}
+			}
+		}
+
+		void updateEntry(EntityId id, const void* field) override {
+			const Key& key = *(const Key*)field;
+			if (id < entityIndexed.size() && entityIndexed[id]) {
+				if (entityKeys[id] == key) {
+					return;
+				}
+				removeEntry(id);
+			}
+			grow();
+			insertSlot(key, Hash()(key), id);
+			if (entityIndexed.size() <= id) {
+				entityIndexed.resize(id + 1, 0);
+				entityKeys.resize(id + 1);
+			}
+			entityIndexed[id] = 1;
+			entityKeys[id] = key;
+		}
+
+		void removeEntry(EntityId id) override {
+			if (id >= entityIndexed.size() || !entityIndexed[id]) {
+				return;
+			}
+			const Key& key = entityKeys[id];
+			size_t hash = Hash()(key);
+			uint32_t mask = slots.size() - 1;
+			for (uint32_t i = hash & mask;; i = (i + 1) & mask) {
+				Slot& slot = slots[i];
+				if (slot.state == EMPTY) {
+					break;
+				}
+				if (slot.state == USED && slot.id == id) {
+					slot.state = REMOVED;
+					slot.key = Key();
+					count--;
+					removedCount++;
+					break;
+				}
+			}
+			entityIndexed[id] = 0;
+			entityKeys[id] = Key();
+		}
+
+		void clearEntries() override {
+			slots.clear();
+			count = 0;
+			removedCount = 0;
+			entityKeys.clear();
+			entityIndexed.clear();
+		}
+	};
+
+}
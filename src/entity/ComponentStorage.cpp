@@ -21,6 +21,14 @@ namespace tri {
 	}
 
 	ComponentStorage::~ComponentStorage() {
+		//the indexes are owned by the world and may already be attached to a new storage
+		for (auto& index : indexes) {
+			if (index->getStorage() == this) {
+				index->setStorage(nullptr);
+				index->clear();
+			}
+		}
+		indexes.clear();
 		clear();
 	}
 
@@ -55,6 +63,10 @@ namespace tri {
 		return deactiveComponentCount;
 	}
 
+	int ComponentStorage::capacity() {
+		return componentDataCapacity;
+	}
+
 	EntityId* ComponentStorage::getIdData() {
 		return idData.data() + deactiveComponentCount;
 	}
@@ -78,6 +90,9 @@ namespace tri {
 		for (auto& g : groups) {
 			g->size = 0;
 		}
+		for (auto& index : indexes) {
+			index->clear();
+		}
 	}
 
 	uint32_t ComponentStorage::getIndexById(EntityId id) {
@@ -129,7 +144,32 @@ namespace tri {
 	void* ComponentStorage::addComponent(EntityId id, const void* ptr) {
 		TRI_ASSERT(!hasComponent(id), "component already present");
 		mutex->mutex.lock();
+		void* comp = addComponentUnlocked(id, ptr);
+		mutex->mutex.unlock();
+		return comp;
+	}
 
+	void ComponentStorage::addComponents(const EntityId* ids, int count, const void* ptr) {
+		if (count <= 0) {
+			return;
+		}
+		mutex->mutex.lock();
+		//grow once for all components, geometrically so that repeated bulk adds do not reallocate every time
+		uint32_t needed = componentDataSize + count;
+		if (componentDataCapacity < needed) {
+			resizeData(std::max(needed, componentDataCapacity * 2));
+		}
+		if (idData.capacity() < idData.size() + count) {
+			idData.reserve(std::max(idData.size() + count, idData.capacity() * 2));
+		}
+		for (int i = 0; i < count; i++) {
+			TRI_ASSERT(!hasComponent(ids[i]), "component already present");
+			addComponentUnlocked(ids[i], ptr);
+		}
+		mutex->mutex.unlock();
+	}
+
+	void* ComponentStorage::addComponentUnlocked(EntityId id, const void* ptr) {
 		//component data
 		if (componentDataCapacity < componentDataSize + 1) {
 			if (componentDataCapacity == 0) {
@@ -204,8 +244,9 @@ namespace tri {
 		else {
 			desc->construct(comp);
 		}
-
-		mutex->mutex.unlock();
+		for (auto& fieldIndex : indexes) {
+			fieldIndex->add(id);
+		}
 		return comp;
 	}
 
@@ -234,6 +275,9 @@ namespace tri {
 
 		swapIndex(index, endIndex);
 
+		for (auto& fieldIndex : indexes) {
+			fieldIndex->remove(id);
+		}
 		auto* desc = Reflection::getDescriptor(classId);
 		desc->destruct(getComponentByIndex(endIndex));
 		idData.pop_back();
@@ -383,6 +427,18 @@ namespace tri {
 		}
 	}
 
+	void ComponentStorage::addIndex(const std::shared_ptr<ComponentIndexBase>& index) {
+		TRI_ASSERT(index->classId == classId, "index belongs to a different component type");
+		for (auto& i : indexes) {
+			if (i == index) {
+				return;
+			}
+		}
+		indexes.push_back(index);
+		index->setStorage(this);
+		index->rebuild();
+	}
+
 	int ComponentStorage::getGroupSize(const std::vector<int>& classIds) {
 		for (auto& group : groups) {
 			if (group->storages.size() == classIds.size()) {
@@ -458,6 +514,10 @@ namespace tri {
 				}
 			}
 		}
+
+		for (auto& index : indexes) {
+			index->rebuild();
+		}
 	}
 
 	void ComponentStorage::reserve(int count) {
@@ -7,6 +7,7 @@
 #include "pch.h"
 #include "core/config.h"
 #include "core/Reflection.h"
+#include "ComponentIndex.h"
 #include <unordered_map>
 #include <tracy/Tracy.hpp>
 
@@ -32,6 +33,8 @@ namespace tri {
 
 		bool hasComponent(EntityId id);
 		void* addComponent(EntityId id, const void *ptr = nullptr);
+		//adds the component to all entities, the storage is grown and locked once
+		void addComponents(const EntityId* ids, int count, const void* ptr = nullptr);
 		void removeComponent(EntityId id);
 		EntityId getIdByComponent(const void* comp);
 
@@ -40,6 +43,8 @@ namespace tri {
 
 		int size();
 		int deactiveSize();
+		//count of components that fit without a reallocation
+		int capacity();
 		EntityId* getIdData();
 		void* getComponentData();
 		void clear();
@@ -69,6 +74,10 @@ namespace tri {
 		//size of a given group, returns -1 if no matching group exists
 		int getGroupSize(const std::vector<int>& classIds);
 
+		//the index is kept up to date with the components of this storage
+		void addIndex(const std::shared_ptr<ComponentIndexBase>& index);
+		const std::vector<std::shared_ptr<ComponentIndexBase>>& getIndexes() { return indexes; }
+
 	private:
 		std::vector<EntityId> idData;
 
@@ -88,6 +97,7 @@ namespace tri {
 		uint32_t deactiveComponentCount = 0;
 
 		std::vector<std::shared_ptr<Group>> groups;
+		std::vector<std::shared_ptr<ComponentIndexBase>> indexes;
 
 		class Mutex {
 		public:
@@ -98,6 +108,7 @@ namespace tri {
 		size_t lockCount = 0;
 
 		void resizeData(int count);
+		void* addComponentUnlocked(EntityId id, const void* ptr);
 		void swapIndex(uint32_t index1, uint32_t index2);
 		void initialGroupSorting(Group* group);
 	};
@@ -58,6 +58,9 @@ namespace tri {
 	}
 
 	World::~World() {
+		if (env->eventManager) {
+			env->eventManager->onWorldDestroy.invoke(this);
+		}
 		env->systemManager->getSystem<WorldManager>()->removeWorld(this);
 	}
 
@@ -173,13 +176,74 @@ namespace tri {
 			storages.resize(classId + 1);
 		}
 		if (!storages[classId]) {
-			storages[classId] = std::make_shared<ComponentStorage>(classId);
+			storages[classId] = createStorage(classId);
 		}
 		auto* signature = (EntitySignature*)entityStorage.getComponentById(id);
 		*signature |= ((EntitySignature)1 << getComponentId(classId));
 		return storages[classId]->addComponent(id, ptr);
 	}
 
+	void World::addEntities(EntityId* ids, int count) {
+		if (count <= 0) {
+			return;
+		}
+		if (!enablePendingOperations) {
+			//grow once for all entities, but only if the capacity is not enough
+			int needed = entityStorage.size() + entityStorage.deactiveSize() + count;
+			if (needed > entityStorage.capacity()) {
+				entityStorage.reserve(std::max(needed, entityStorage.capacity() * 2));
+			}
+		}
+		for (int i = 0; i < count; i++) {
+			ids[i] = addEntity();
+		}
+	}
+
+	void World::addComponents(const EntityId* ids, int count, int classId, const void* ptr) {
+		if (count <= 0) {
+			return;
+		}
+		if (enablePendingOperations) {
+			//pending operation
+			if (pendingAddComponentStorages.size() <= classId) {
+				std::unique_lock<std::mutex> lock(mutex);
+				pendingAddComponentStorages.resize(classId + 1);
+			}
+			if (!pendingAddComponentStorages[classId]) {
+				if (!Reflection::getDescriptor(classId)) {
+					return;
+				}
+				pendingAddComponentStorages[classId] = std::make_shared<ComponentStorage>(classId);
+			}
+			pendingAddComponentStorages[classId]->addComponents(ids, count, ptr);
+			return;
+		}
+
+		//event buffer
+		if (onComponentAddIds.size() <= classId) {
+			std::unique_lock<std::mutex> lock(mutex);
+			onComponentAddIds.resize(classId + 1);
+		}
+		if (!onComponentAddIds[classId]) {
+			onComponentAddIds[classId] = std::make_shared<std::vector<EntityId>>();
+		}
+		onComponentAddIds[classId]->insert(onComponentAddIds[classId]->end(), ids, ids + count);
+
+		if (storages.size() <= classId) {
+			std::unique_lock<std::mutex> lock(mutex);
+			storages.resize(classId + 1);
+		}
+		if (!storages[classId]) {
+			storages[classId] = createStorage(classId);
+		}
+		EntitySignature bit = (EntitySignature)1 << getComponentId(classId);
+		for (int i = 0; i < count; i++) {
+			auto* signature = (EntitySignature*)entityStorage.getComponentById(ids[i]);
+			*signature |= bit;
+		}
+		storages[classId]->addComponents(ids, count, ptr);
+	}
+
 	void* World::getComponent(EntityId id, int classId) {
 		if (storages.size() <= classId) {
 			return nullptr;
@@ -289,7 +353,7 @@ namespace tri {
 		storages.resize(from.storages.size());
 		for (int i = 0; i < storages.size(); i++) {
 			if (from.storages[i]) {
-				storages[i] = std::make_shared<ComponentStorage>(from.storages[i]->classId);
+				storages[i] = createStorage(from.storages[i]->classId);
 				storages[i]->copy(*from.storages[i]);
 			}
 			else if (storages[i]) {
@@ -467,6 +531,10 @@ namespace tri {
 		}
 
 
+		for (auto& index : indexes) {
+			index->flush();
+		}
+
 		enablePendingOperations = currentEnablePendingOperations;
 	}
 
@@ -491,7 +559,7 @@ namespace tri {
 		}
 		if (!storages[classId]) {
 			if (Reflection::getDescriptor(classId)) {
-				storages[classId] = std::make_shared<ComponentStorage>(classId);
+				storages[classId] = createStorage(classId);
 			}
 		}
 		return storages[classId].get();
@@ -556,4 +624,50 @@ namespace tri {
 		pendingRemovePreventIds.insert(id);
 	}
 
+	ComponentIndexBase* World::addIndex(int classId, int offset, const std::function<std::shared_ptr<ComponentIndexBase>()>& create) {
+		//the lookup and the insert happen under the same lock, so that concurrent first uses do not add the index twice
+		std::unique_lock<std::mutex> lock(mutex);
+		for (auto& index : indexes) {
+			if (index->classId == classId && index->offset == offset) {
+				return index.get();
+			}
+		}
+		std::shared_ptr<ComponentIndexBase> index = create();
+		indexes.push_back(index);
+		if (storages.size() > classId && storages[classId]) {
+			storages[classId]->addIndex(index);
+		}
+		return index.get();
+	}
+
+	ComponentIndexBase* World::getIndex(int classId, int offset) {
+		std::unique_lock<std::mutex> lock(mutex);
+		for (auto& index : indexes) {
+			if (index->classId == classId && index->offset == offset) {
+				return index.get();
+			}
+		}
+		return nullptr;
+	}
+
+	void World::componentChanged(EntityId id, int classId) {
+		std::unique_lock<std::mutex> lock(mutex);
+		for (auto& index : indexes) {
+			if (index->classId == classId) {
+				index->changed(id);
+			}
+		}
+	}
+
+	std::shared_ptr<ComponentStorage> World::createStorage(int classId) {
+		auto storage = std::make_shared<ComponentStorage>(classId);
+		std::unique_lock<std::mutex> lock(mutex);
+		for (auto& index : indexes) {
+			if (index->classId == classId) {
+				storage->addIndex(index);
+			}
+		}
+		return storage;
+	}
+
 }
@@ -7,6 +7,7 @@
 #include "pch.h"
 #include "core/System.h"
 #include "ComponentStorage.h"
+#include "ComponentIndex.h"
 #include <deque>
 
 namespace tri {
@@ -127,12 +128,36 @@ namespace tri {
 			setComponentGroup(storages);
 		}
 
+		//secondary index on a field of a component, e.g. addIndex<EntityInfo>(&EntityInfo::guid)
+		//adding an index for the same field again returns the existing one
+		template<typename Component, typename Key>
+		ComponentIndex<Key>* addIndex(Key Component::* field) {
+			int classId = Reflection::getClassId<Component>();
+			return (ComponentIndex<Key>*)addIndex(classId, getFieldOffset(field), [&]() {
+				return std::make_shared<ComponentIndex<Key>>(classId, getFieldOffset(field));
+			});
+		}
+
+		template<typename Component, typename Key>
+		ComponentIndex<Key>* getIndex(Key Component::* field) {
+			return (ComponentIndex<Key>*)getIndex(Reflection::getClassId<Component>(), getFieldOffset(field));
+		}
+
+		//reports an in place change of a component to the indexes on that component
+		template<typename Component>
+		void componentChanged(EntityId id) {
+			componentChanged(id, Reflection::getClassId<Component>());
+		}
 
 		EntityId addEntity(EntityId hint = -1);
 		bool hasEntity(EntityId id);
 		void removeEntity(EntityId id);
 
 		void* addComponent(EntityId id, int classId, const void *ptr = nullptr);
+		//adds count entities at once and writes the ids into the array
+		void addEntities(EntityId* ids, int count);
+		//adds the component to every entity of the array, the storage is grown and written in one batch
+		void addComponents(const EntityId* ids, int count, int classId, const void* ptr = nullptr);
 		void* getComponent(EntityId id, int classId);
 		void* getComponentUnchecked(EntityId id, int classId);
 		bool hasComponent(EntityId id, int classId);
@@ -158,6 +183,10 @@ namespace tri {
 		void removeComponentStorage(int classId);
 
 		void preventPendingEntityRemove(EntityId id);
+
+		ComponentIndexBase* addIndex(int classId, int offset, const std::function<std::shared_ptr<ComponentIndexBase>()>& create);
+		ComponentIndexBase* getIndex(int classId, int offset);
+		void componentChanged(EntityId id, int classId);
 	private:
 		//component data
 		std::vector<std::shared_ptr<ComponentStorage>> storages;
@@ -180,6 +209,9 @@ namespace tri {
 		std::vector<EntityId> onEntityAddIds;
 		std::vector<EntityId> onEntityRemoveIds;
 
+		//secondary indexes, attached to the storage of their component
+		std::vector<std::shared_ptr<ComponentIndexBase>> indexes;
+
 		//to map classIds to bit positions in entity signatures
 		std::vector<int> componentIdMap;
 		int nextComponentId = 0;
@@ -187,6 +219,13 @@ namespace tri {
 		std::mutex mutex;
 
 		int getComponentId(int classId);
+		std::shared_ptr<ComponentStorage> createStorage(int classId);
+
+		template<typename Component, typename Key>
+		static int getFieldOffset(Key Component::* field) {
+			alignas(Component) static uint8_t buffer[sizeof(Component)];
+			return (int)((uint8_t*)&(((Component*)buffer)->*field) - buffer);
+		}
 	};
 
 }
@@ -23,6 +23,9 @@ namespace tri {
 		bool running;
 		StringArchive readStringArchive;
 		StringArchive writeStringArchive;
+		//traffic of the last second, updated by the network manager
+		int bytesUpPerSecond = 0;
+		int bytesDownPerSecond = 0;
 		std::function<void(Connection* conn)> onDisconnect;
 		std::function<void(Connection* conn)> onConnect;
 		std::function<void(Connection* conn)> onFail;
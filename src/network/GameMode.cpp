@@ -71,7 +71,7 @@ namespace tri {
 		void join(Connection* conn) {
 			std::unique_lock<std::mutex> lock(env->world->performePendingMutex);
 			env->world->each<GameMode>([&](GameMode& gameMode) {
-				std::map<EntityId, EntityId> idMap;
+				EntityIdMap idMap;
 				for (auto& prefab : gameMode.playerPrefab) {
 					if (prefab) {
 						prefab->createEntity(env->world, -1, &idMap);
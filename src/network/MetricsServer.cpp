@@ -0,0 +1,335 @@
+//
+// Copyright (c) 2022 Julian Hinxlage. All rights reserved.
+//
+
+#include "MetricsServer.h"
+#include "core/core.h"
+#include "engine/Time.h"
+#include "engine/AssetManager.h"
+#include "entity/World.h"
+#include "NetworkManager.h"
+#include "ServerIdle.h"
+
+#if TRI_WINDOWS
+#include <winsock2.h>
+#include <ws2tcpip.h>
+#undef ERROR
+#else
+#include<unistd.h>
+#include<sys/socket.h>
+#include<sys/time.h>
+#endif
+
+namespace tri {
+
+	TRI_SYSTEM(MetricsServer);
+
+	static std::string escapeLabel(const std::string& value) {
+		std::string result;
+		result.reserve(value.size());
+		for (char c : value) {
+			if (c == '\\' || c == '"') {
+				result += '\\';
+				result += c;
+			}
+			else if (c == '\n') {
+				result += "\\n";
+			}
+			else {
+				result += c;
+			}
+		}
+		return result;
+	}
+
+	class MetricsWriter {
+	public:
+		std::string text;
+
+		void header(const char* name, const char* type, const char* help) {
+			text += "# HELP ";
+			text += name;
+			text += " ";
+			text += help;
+			text += "\n# TYPE ";
+			text += name;
+			text += " ";
+			text += type;
+			text += "\n";
+		}
+
+		//labels are given as name value pairs
+		void value(const char* name, double value, const std::vector<std::pair<const char*, std::string>>& labels = {}) {
+			text += name;
+			if (!labels.empty()) {
+				text += "{";
+				for (int i = 0; i < labels.size(); i++) {
+					if (i > 0) {
+						text += ",";
+					}
+					text += labels[i].first;
+					text += "=\"";
+					text += escapeLabel(labels[i].second);
+					text += "\"";
+				}
+				text += "}";
+			}
+			char buffer[64];
+			snprintf(buffer, sizeof(buffer), " %.9g\n", value);
+			text += buffer;
+		}
+
+		//quantiles over the stats window, sum and count over all samples
+		void summary(const char* name, const Profiler::Stats& stats, std::vector<std::pair<const char*, std::string>> labels = {}) {
+			value((std::string(name) + "_sum").c_str(), stats.totalTime, labels);
+			value((std::string(name) + "_count").c_str(), (double)stats.totalCount, labels);
+			labels.push_back({ "quantile", "" });
+			labels.back().second = "0.5";
+			value(name, stats.p50, labels);
+			labels.back().second = "0.95";
+			value(name, stats.p95, labels);
+			labels.back().second = "0.99";
+			value(name, stats.p99, labels);
+			labels.back().second = "1";
+			value(name, stats.max, labels);
+		}
+	};
+
+	static void writeProfilerNodes(MetricsWriter& writer, Profiler::Node* node, const std::string& parent) {
+		for (auto& child : node->nodes) {
+			if (child.second && child.second->name) {
+				writer.summary("tridot_profiler_time_seconds", child.second->stats, { {"name", child.second->name}, {"parent", parent} });
+				writeProfilerNodes(writer, child.second.get(), child.second->name);
+			}
+		}
+	}
+
+	static int64_t getResidentBytes() {
+#if TRI_LINUX
+		std::ifstream stream("/proc/self/statm");
+		int64_t size = 0;
+		int64_t resident = 0;
+		if (stream >> size >> resident) {
+			return resident * sysconf(_SC_PAGESIZE);
+		}
+#endif
+		return -1;
+	}
+
+	void MetricsServer::init() {
+		env->console->addCVar("metricsPort", &port);
+		env->console->addCVar("metricsLoopbackOnly", &loopbackOnly);
+		env->console->addCVar("metricsCollectInterval", &collectInterval);
+		env->console->addCommand("metricsDump", [&](auto& args) {
+			collect();
+			env->console->info("%s", getMetrics()->c_str());
+		});
+
+		metrics = std::make_shared<const std::string>();
+		postTickListener = env->eventManager->postTick.addListener([&]() {
+			if (port != listeningPort) {
+				stopListening();
+				if (port != 0) {
+					startListening();
+				}
+			}
+			if (listeningPort != 0 && env->time->frameTicks(collectInterval)) {
+				collect();
+			}
+		});
+	}
+
+	void MetricsServer::shutdown() {
+		env->eventManager->postTick.removeListener(postTickListener);
+		stopListening();
+	}
+
+	void MetricsServer::collect() {
+		TRI_PROFILE_FUNC();
+		MetricsWriter writer;
+
+		//frame and system times
+		{
+			std::unique_lock<std::mutex> lock(env->profiler->getTreeMutex());
+			auto* root = env->profiler->getRoot();
+			writer.header("tridot_frame_time_seconds", "summary", "Frame time percentiles over the profiler stats window");
+			writer.summary("tridot_frame_time_seconds", root->stats);
+			writer.header("tridot_profiler_time_seconds", "summary", "Time percentiles of the profiled scopes (jobs, systems and sub scopes)");
+			writeProfilerNodes(writer, root, root->name ? root->name : "");
+		}
+		writer.header("tridot_frames_per_second", "gauge", "Average frames per second");
+		writer.value("tridot_frames_per_second", env->time->framesPerSecond);
+		writer.header("tridot_frame_pacing_error_seconds", "gauge", "Average and maximum wake up error of the frame limiter");
+		writer.value("tridot_frame_pacing_error_seconds", env->time->getFramePacingStats().avgError, { {"stat", "avg"} });
+		writer.value("tridot_frame_pacing_error_seconds", env->time->getFramePacingStats().maxError, { {"stat", "max"} });
+
+		//entities and components
+		if (env->world) {
+			writer.header("tridot_entities", "gauge", "Number of entities in the active world");
+			writer.value("tridot_entities", env->world->getEntityStorage()->size());
+			writer.header("tridot_components", "gauge", "Number of components per storage in the active world");
+			for (auto* desc : Reflection::getDescriptors()) {
+				if (desc && (desc->flags & ClassDescriptor::COMPONENT)) {
+					if (auto* storage = env->world->getComponentStorage(desc->classId)) {
+						writer.value("tridot_components", storage->size(), { {"component", desc->name} });
+					}
+				}
+			}
+		}
+
+		//network
+		if (env->networkManager) {
+			std::vector<Ref<Connection>> connections;
+			if (env->networkManager->hasAuthority()) {
+				connections = env->networkManager->getConnections();
+			}
+			else if (env->networkManager->getConnection() && env->networkManager->isConnected()) {
+				connections.push_back(env->networkManager->getConnection());
+			}
+			writer.header("tridot_connections", "gauge", "Number of open connections");
+			writer.value("tridot_connections", connections.size());
+			writer.header("tridot_network_bytes_per_second", "gauge", "Total network traffic of the last second");
+			writer.value("tridot_network_bytes_per_second", env->networkManager->bytesUpPerSecond, { {"direction", "up"} });
+			writer.value("tridot_network_bytes_per_second", env->networkManager->bytesDownPerSecond, { {"direction", "down"} });
+			writer.header("tridot_connection_bytes_per_second", "gauge", "Network traffic of the last second per connection");
+			for (auto& conn : connections) {
+				if (conn) {
+					std::string endpoint = conn->socket->getEndpoint().getAddress() + ":" + std::to_string(conn->socket->getEndpoint().getPort());
+					writer.value("tridot_connection_bytes_per_second", conn->bytesUpPerSecond, { {"endpoint", endpoint}, {"direction", "up"} });
+					writer.value("tridot_connection_bytes_per_second", conn->bytesDownPerSecond, { {"endpoint", endpoint}, {"direction", "down"} });
+				}
+			}
+			writer.header("tridot_connection_rtt_seconds", "gauge", "Smoothed round trip time per connection");
+			for (auto& conn : connections) {
+				if (conn) {
+					double rtt = conn->socket->getRoundTripTime();
+					if (rtt >= 0) {
+						std::string endpoint = conn->socket->getEndpoint().getAddress() + ":" + std::to_string(conn->socket->getEndpoint().getPort());
+						writer.value("tridot_connection_rtt_seconds", rtt, { {"endpoint", endpoint} });
+					}
+				}
+			}
+		}
+
+		//idle policy
+		if (auto* serverIdle = env->systemManager->getSystem<ServerIdle>()) {
+			auto& stats = serverIdle->getStats();
+			writer.header("tridot_server_idle", "gauge", "1 if the server ticks at the idle rate");
+			writer.value("tridot_server_idle", serverIdle->isIdle() ? 1 : 0);
+			writer.header("tridot_cpu_seconds_total", "counter", "Process cpu time spent while active and while idle");
+			writer.value("tridot_cpu_seconds_total", stats.activeCpuTime, { {"state", "active"} });
+			writer.value("tridot_cpu_seconds_total", stats.idleCpuTime, { {"state", "idle"} });
+			writer.header("tridot_state_seconds_total", "counter", "Wall time spent while active and while idle");
+			writer.value("tridot_state_seconds_total", stats.activeTime, { {"state", "active"} });
+			writer.value("tridot_state_seconds_total", stats.idleTime, { {"state", "idle"} });
+		}
+
+		//assets and background work
+		if (env->assetManager) {
+			writer.header("tridot_asset_queue_depth", "gauge", "Assets waiting to be loaded or activated");
+			writer.value("tridot_asset_queue_depth", env->assetManager->getLoadingCount());
+			writer.header("tridot_asset_load_latency_seconds", "gauge", "Time from requesting an asset until it is activated");
+			writer.value("tridot_asset_load_latency_seconds", env->assetManager->getAverageLatency(), { {"stat", "average"} });
+			writer.value("tridot_asset_load_latency_seconds", env->assetManager->getMaxLatency(), { {"stat", "max"} });
+		}
+		writer.header("tridot_background_work_pending", "gauge", "Pending items of the background work scheduler");
+		writer.value("tridot_background_work_pending", env->workScheduler->getStats().pendingCount);
+
+		//memory
+		int64_t resident = getResidentBytes();
+		if (resident >= 0) {
+			writer.header("tridot_memory_resident_bytes", "gauge", "Resident set size of the process");
+			writer.value("tridot_memory_resident_bytes", (double)resident);
+		}
+		writer.header("tridot_frame_allocator_bytes", "gauge", "Bytes allocated from the frame arenas during the last frame");
+		writer.value("tridot_frame_allocator_bytes", (double)env->frameAllocator->getLastFrameStats().allocatedBytes);
+		if (MemoryTracker::isAvailable() && env->memoryTracker->enabled) {
+			writer.header("tridot_memory_live_bytes", "gauge", "Heap memory allocated per system and module");
+			for (auto& tag : env->memoryTracker->getStats()) {
+				writer.value("tridot_memory_live_bytes", (double)tag.liveBytes, { {"tag", tag.name}, {"kind", tag.isModule ? "module" : "system"} });
+			}
+		}
+
+		std::atomic_store(&metrics, std::shared_ptr<const std::string>(std::make_shared<const std::string>(std::move(writer.text))));
+	}
+
+	std::shared_ptr<const std::string> MetricsServer::getMetrics() {
+		return std::atomic_load(&metrics);
+	}
+
+	void MetricsServer::startListening() {
+		socket = Ref<TcpSocket>::make();
+		if (!socket->listen(port, true, loopbackOnly)) {
+			env->console->warning("metrics server failed to listen on port %i", port);
+			socket = nullptr;
+			//do not retry every frame
+			listeningPort = port;
+			return;
+		}
+		listeningPort = port;
+		env->console->info("metrics server listening on port %i", port);
+		collect();
+
+		running = true;
+		threadId = env->threadManager->addThread("Metrics", [&]() {
+			while (running && socket->isConnected()) {
+				Ref<TcpSocket> client = socket->accept();
+				if (client && running) {
+					serve(client);
+				}
+			}
+		});
+	}
+
+	void MetricsServer::stopListening() {
+		running = false;
+		if (socket) {
+			socket->disconnect();
+		}
+		if (threadId != -1) {
+			env->threadManager->joinThread(threadId);
+			env->threadManager->terminateThread(threadId);
+			threadId = -1;
+		}
+		socket = nullptr;
+		listeningPort = 0;
+	}
+
+	void MetricsServer::serve(Ref<TcpSocket> client) {
+		//a client that does not send its request is dropped after a short time
+#if TRI_WINDOWS
+		DWORD timeout = 2000;
+#else
+		timeval timeout;
+		timeout.tv_sec = 2;
+		timeout.tv_usec = 0;
+#endif
+		setsockopt(client->getHandle(), SOL_SOCKET, SO_RCVTIMEO, (const char*)&timeout, sizeof(timeout));
+
+		std::string request;
+		char buffer[1024];
+		while (request.find("\r\n\r\n") == std::string::npos && request.size() < 8192) {
+			int bytes = sizeof(buffer);
+			if (!client->read(buffer, bytes)) {
+				return;
+			}
+			request.append(buffer, bytes);
+		}
+
+		std::string status = "200 OK";
+		std::shared_ptr<const std::string> body = getMetrics();
+		if (request.rfind("GET /metrics ", 0) != 0 && request.rfind("GET / ", 0) != 0) {
+			status = "404 Not Found";
+			body = std::make_shared<const std::string>("not found\n");
+		}
+
+		std::string response = "HTTP/1.1 " + status + "\r\n";
+		response += "Content-Type: text/plain; version=0.0.4; charset=utf-8\r\n";
+		response += "Content-Length: " + std::to_string(body->size()) + "\r\n";
+		response += "Connection: close\r\n\r\n";
+		response += *body;
+		client->write(response.data(), (int)response.size());
+		client->disconnect();
+	}
+
+}
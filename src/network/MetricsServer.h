@@ -0,0 +1,44 @@
+//
+// Copyright (c) 2022 Julian Hinxlage. All rights reserved.
+//
+
+#pragma once
+
+#include "pch.h"
+#include "core/System.h"
+#include "TcpSocket.h"
+#include <atomic>
+
+namespace tri {
+
+	//serves metrics in the prometheus text format over http (GET /metrics)
+	//the metrics are collected on the main thread between two frames, the http thread only reads the last snapshot
+	class MetricsServer : public System {
+	public:
+		//0 = disabled
+		int port = 0;
+		//only accept scrapes from the local machine
+		bool loopbackOnly = true;
+		//seconds between two collections
+		float collectInterval = 1.0f;
+
+		void init() override;
+		void shutdown() override;
+
+		void collect();
+		std::shared_ptr<const std::string> getMetrics();
+
+	private:
+		std::shared_ptr<const std::string> metrics;
+		Ref<TcpSocket> socket;
+		int threadId = -1;
+		std::atomic<bool> running = false;
+		int listeningPort = 0;
+		int postTickListener = -1;
+
+		void startListening();
+		void stopListening();
+		void serve(Ref<TcpSocket> client);
+	};
+
+}
@@ -115,6 +115,8 @@ namespace tri {
 			bytesUpPerSecond = 0;
 
 			if (connection) {
+				connection->bytesDownPerSecond = connection->socket->bytesDown;
+				connection->bytesUpPerSecond = connection->socket->bytesUp;
 				bytesDownPerSecond += connection->socket->bytesDown;
 				bytesUpPerSecond += connection->socket->bytesUp;
 				connection->socket->bytesDown = 0;
@@ -122,6 +124,8 @@ namespace tri {
 			}
 			for (auto& conn : connections) {
 				if (conn) {
+					conn->bytesDownPerSecond = conn->socket->bytesDown;
+					conn->bytesUpPerSecond = conn->socket->bytesUp;
 					bytesDownPerSecond += conn->socket->bytesDown;
 					bytesUpPerSecond += conn->socket->bytesUp;
 					conn->socket->bytesDown = 0;
@@ -42,7 +42,7 @@ namespace tri {
 		std::set<Guid> removedNetworkEntities;
 
 
-		std::map<EntityId, EntityId> idMap;
+		EntityIdMap idMap;
 	};
 
 }
@@ -77,27 +77,22 @@ namespace tri {
 
 			if (next == PROPERTY) {
 
-				std::string name;
+				uint64_t nameHash = 0;
 				uint8_t index = 0;
-				packet.readStr(name);
-				relay.writeStr(name);
+				packet.readBin(nameHash);
+				relay.writeBin(nameHash);
 				packet.readBin(index);
 				relay.writeBin(index);
 
-				bool processedProperty = false;
-				for (auto* desc : Reflection::getDescriptors()) {
-					if (desc && desc->name == name) {
-						if (desc->properties.size() > index) {
-							auto& prop = desc->properties[index];
+				if (auto* desc = Reflection::getDescriptorByHash(nameHash)) {
+					if (desc->properties.size() > index) {
+						auto& prop = desc->properties[index];
 
-							//todo: cache tmp buffers
-							DynamicObjectBuffer tmp;
-							tmp.set(prop.type->classId);
-							packet.readClass(tmp.get(), prop.type->classId);
-							relay.writeClass(tmp.get(), prop.type->classId);
-
-							break;
-						}
+						//todo: cache tmp buffers
+						DynamicObjectBuffer tmp;
+						tmp.set(prop.type->classId);
+						packet.readClass(tmp.get(), prop.type->classId);
+						relay.writeClass(tmp.get(), prop.type->classId);
 					}
 				}
 			}
@@ -161,33 +156,30 @@ namespace tri {
 
 					if (next == PROPERTY) {
 
-						std::string name;
+						uint64_t nameHash = 0;
 						uint8_t index = 0;
-						packet.readStr(name);
+						packet.readBin(nameHash);
 						packet.readBin(index);
 
-						bool processedProperty = false;
-						for (auto* desc : Reflection::getDescriptors()) {
-							if (desc && desc->name == name) {
-								if (desc->properties.size() > index) {
-									auto& prop = desc->properties[index];
+						if (auto* desc = Reflection::getDescriptorByHash(nameHash)) {
+							if (desc->properties.size() > index) {
+								auto& prop = desc->properties[index];
 
-									if (void* comp = env->world->getComponent(id, desc->classId)) {
-										void* ptr = (uint8_t*)comp + prop.offset;
-										if (!ignoreProperty && (prop.flags & PropertyDescriptor::REPLICATE)) {
-											packet.readClass(ptr, prop.type->classId);
-										}
-										else {
-											//todo: cache tmp buffers
-											DynamicObjectBuffer tmp;
-											tmp.set(prop.type->classId);
-											packet.readClass(tmp.get(), prop.type->classId);
-										}
+								if (void* comp = env->world->getComponent(id, desc->classId)) {
+									void* ptr = (uint8_t*)comp + prop.offset;
+									if (!ignoreProperty && (prop.flags & PropertyDescriptor::REPLICATE)) {
+										packet.readClass(ptr, prop.type->classId);
+										env->world->componentChanged(id, desc->classId);
 									}
 									else {
-										env->console->log(LogLevel::TRACE, "Network", "property %s index %i dose not exists on entity %s", name.c_str(), index, guid.toString().c_str());
+										//todo: cache tmp buffers
+										DynamicObjectBuffer tmp;
+										tmp.set(prop.type->classId);
+										packet.readClass(tmp.get(), prop.type->classId);
 									}
-									break;
+								}
+								else {
+									env->console->log(LogLevel::TRACE, "Network", "property %s index %i dose not exists on entity %s", desc->name.c_str(), index, guid.toString().c_str());
 								}
 							}
 						}
@@ -263,7 +255,9 @@ namespace tri {
 	}
 
 	void PropertyReplication::replicateToConnection(Connection* conn) {
-		Packet packet;
+		//the packet is reused to keep the capacity of its buffer between frames
+		Packet& packet = replicationPacket;
+		packet.clear();
 		BinaryArchive binaryArchive;
 		packet.classArchive = &binaryArchive;
 		packet.stringArchive = &conn->writeStringArchive;
@@ -277,8 +271,8 @@ namespace tri {
 		if (env->time->frameTicks(1.0f / networkReplicationRate)) {
 			if (env->networkManager->isConnected()) {
 
-				std::vector<EntityId> ids;
-				std::vector<Guid> guids;
+				FrameVector<EntityId> ids(env->frameAllocator->allocator<EntityId>());
+				FrameVector<Guid> guids(env->frameAllocator->allocator<Guid>());
 				env->world->each<NetworkComponent>([&](EntityId id, NetworkComponent& net) {
 					if (net.syncAlways) {
 						Guid guid = EntityUtil::getGuid(id);
@@ -328,7 +322,7 @@ namespace tri {
 													}
 
 													packet.writeBin(NextField::PROPERTY);
-													packet.writeStr(desc->name);
+													packet.writeBin(desc->nameHash);
 													packet.writeBin((uint8_t)j);
 
 													packet.writeClass(ptr, prop.type->classId);
@@ -360,8 +354,8 @@ namespace tri {
 			if (env->networkManager->isConnected()) {
 				std::unique_lock<std::mutex> lock(env->world->performePendingMutex);
 
-				std::vector<EntityId> ids;
-				std::vector<Guid> guids;
+				FrameVector<EntityId> ids(env->frameAllocator->allocator<EntityId>());
+				FrameVector<Guid> guids(env->frameAllocator->allocator<Guid>());
 				env->world->each<NetworkComponent>([&](EntityId id, NetworkComponent& net) {
 					if (net.syncAlways) {
 						Guid guid = EntityUtil::getGuid(id);
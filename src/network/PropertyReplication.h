@@ -25,6 +25,7 @@ namespace tri {
 	private:
 		std::vector<std::vector<std::shared_ptr<ComponentStorage>>> storages;
 		std::mutex mutex;
+		Packet replicationPacket;
 	};
 
 }
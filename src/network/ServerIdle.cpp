@@ -0,0 +1,142 @@
+//
+// Copyright (c) 2022 Julian Hinxlage. All rights reserved.
+//
+
+#include "ServerIdle.h"
+#include "core/core.h"
+#include "engine/Time.h"
+#include "engine/RuntimeMode.h"
+#include "NetworkManager.h"
+
+#if TRI_WINDOWS
+#include <windows.h>
+#undef ERROR
+#else
+#include <sys/resource.h>
+#endif
+
+namespace tri {
+
+	TRI_SYSTEM(ServerIdle);
+
+	//user and system time of the whole process in seconds
+	static double getProcessCpuTime() {
+#if TRI_WINDOWS
+		FILETIME creation, exit, kernel, user;
+		if (GetProcessTimes(GetCurrentProcess(), &creation, &exit, &kernel, &user)) {
+			auto toSeconds = [](const FILETIME& time) {
+				return (double)(((uint64_t)time.dwHighDateTime << 32) | time.dwLowDateTime) / 1e7;
+			};
+			return toSeconds(kernel) + toSeconds(user);
+		}
+		return 0;
+#else
+		rusage usage;
+		if (getrusage(RUSAGE_SELF, &usage) == 0) {
+			return usage.ru_utime.tv_sec + usage.ru_utime.tv_usec / 1e6 + usage.ru_stime.tv_sec + usage.ru_stime.tv_usec / 1e6;
+		}
+		return 0;
+#endif
+	}
+
+	void ServerIdle::init() {
+		env->console->addCVar("serverIdle", &enabled);
+		env->console->addCVar("serverIdleDelay", &idleDelay);
+		env->console->addCommand("serverIdleSuspend", [&](auto& args) {
+			if (idle) {
+				setIdle(false);
+				suspendedSystems = args;
+				setIdle(true);
+			}
+			else {
+				suspendedSystems = args;
+			}
+		});
+		env->console->addCommand("serverIdleStats", [&](auto& args) {
+			updateStats();
+			auto usage = [](double cpu, double time) {
+				return time > 0 ? cpu / time * 100.0 : 0.0;
+			};
+			env->console->info("server is %s, idle %i times", idle ? "idle" : "active", stats.idleCount);
+			env->console->info("active: %.1f s, %.1f%% cpu", stats.activeTime, usage(stats.activeCpuTime, stats.activeTime));
+			env->console->info("idle: %.1f s, %.1f%% cpu", stats.idleTime, usage(stats.idleCpuTime, stats.idleTime));
+		});
+	}
+
+	void ServerIdle::startup() {
+		lastTime = Clock::now();
+		lastClientTime = lastTime;
+		lastCpuTime = getProcessCpuTime();
+
+		//called on the listen thread, the idle wait ends right away
+		connectListener = env->networkManager->onConnect.addListener([&](Connection* conn) {
+			env->time->wakeUp();
+		});
+
+		//the job threads are parked, so changing the active systems is safe
+		postTickListener = env->eventManager->postTick.addListener([&]() {
+			double now = Clock::now();
+			if (!enabled || hasClients()) {
+				lastClientTime = now;
+				if (idle) {
+					setIdle(false);
+				}
+			}
+			else if (!idle && now - lastClientTime >= idleDelay) {
+				setIdle(true);
+			}
+			if (env->time->frameTicks(1.0f)) {
+				updateStats();
+			}
+		});
+	}
+
+	void ServerIdle::shutdown() {
+		env->eventManager->postTick.removeListener(postTickListener);
+		env->networkManager->onConnect.removeListener(connectListener);
+		setIdle(false);
+	}
+
+	bool ServerIdle::hasClients() {
+		//a host has a local player and a client depends on its server
+		if (env->networkManager->getMode() != SERVER) {
+			return true;
+		}
+		return env->networkManager->getConnections().size() > 0;
+	}
+
+	void ServerIdle::setIdle(bool idle) {
+		if (idle == this->idle) {
+			return;
+		}
+		updateStats();
+		this->idle = idle;
+		env->time->idle = idle;
+		for (auto& name : suspendedSystems) {
+			env->runtimeMode->setSuspended(name, idle);
+		}
+		if (idle) {
+			stats.idleCount++;
+			env->console->info("server idle, %i systems suspended", (int)suspendedSystems.size());
+		}
+		else {
+			env->console->info("server active");
+		}
+	}
+
+	void ServerIdle::updateStats() {
+		double now = Clock::now();
+		double cpuTime = getProcessCpuTime();
+		if (idle) {
+			stats.idleTime += now - lastTime;
+			stats.idleCpuTime += cpuTime - lastCpuTime;
+		}
+		else {
+			stats.activeTime += now - lastTime;
+			stats.activeCpuTime += cpuTime - lastCpuTime;
+		}
+		lastTime = now;
+		lastCpuTime = cpuTime;
+	}
+
+}
@@ -0,0 +1,53 @@
+//
+// Copyright (c) 2022 Julian Hinxlage. All rights reserved.
+//
+
+#pragma once
+
+#include "pch.h"
+#include "core/System.h"
+
+namespace tri {
+
+	//lowers the tick rate of a dedicated server and suspends simulation systems while no client is connected
+	//a connecting client wakes the server up, so that the next tick runs at the full rate again
+	class ServerIdle : public System {
+	public:
+		bool enabled = false;
+		//seconds without clients before the server becomes idle
+		float idleDelay = 5.0f;
+		//systems that are not ticked while idle
+		std::vector<std::string> suspendedSystems = { "Physics", "ParticleSystem", "AnimationSystem" };
+
+		class Stats {
+		public:
+			//process cpu time and wall time spent in each state in seconds
+			double activeCpuTime = 0;
+			double activeTime = 0;
+			double idleCpuTime = 0;
+			double idleTime = 0;
+			int idleCount = 0;
+		};
+
+		void init() override;
+		void startup() override;
+		void shutdown() override;
+
+		bool isIdle() { return idle; }
+		const Stats& getStats() { return stats; }
+
+	private:
+		bool idle = false;
+		double lastClientTime = 0;
+		double lastCpuTime = 0;
+		double lastTime = 0;
+		Stats stats;
+		int postTickListener = -1;
+		int connectListener = -1;
+
+		bool hasClients();
+		void setIdle(bool idle);
+		void updateStats();
+	};
+
+}
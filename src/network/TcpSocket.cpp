@@ -14,6 +14,8 @@
 #include<sys/types.h>
 #include<netdb.h>
 #include<arpa/inet.h>
+#include<netinet/in.h>
+#include<netinet/tcp.h>
 #endif
 
 #include <iostream>
@@ -75,7 +77,7 @@ namespace tri {
 		return connect(Endpoint(address, port, resolve, prefereIpv4));
 	}
 
-	bool TcpSocket::listen(uint16_t port, bool prefereIpv4) {
+	bool TcpSocket::listen(uint16_t port, bool prefereIpv4, bool loopbackOnly) {
 		struct sockaddr_in6 &addr6 = *(sockaddr_in6*)endpoint.getHandle();
 		struct sockaddr_in& addr4 = *(sockaddr_in*)&addr6;
 		memset(&addr6, 0, sizeof(addr6));
@@ -83,12 +85,12 @@ namespace tri {
 		if (prefereIpv4) {
 			addr4.sin_family = AF_INET;
 			addr4.sin_port = htons(port);
-			addr4.sin_addr.S_un.S_addr = INADDR_ANY;
+			addr4.sin_addr.s_addr = htonl(loopbackOnly ? INADDR_LOOPBACK : INADDR_ANY);
 		}
 		else {
 			addr6.sin6_family = AF_INET6;
 			addr6.sin6_port = htons(port);
-			addr6.sin6_addr = in6addr_any;
+			addr6.sin6_addr = loopbackOnly ? in6addr_loopback : in6addr_any;
 		}
 
 		if (handle != -1) {
@@ -193,4 +195,15 @@ namespace tri {
 		return handle;
 	}
 
+	double TcpSocket::getRoundTripTime() {
+#if TRI_LINUX
+		tcp_info info;
+		socklen_t size = sizeof(info);
+		if (handle != -1 && getsockopt(handle, IPPROTO_TCP, TCP_INFO, &info, &size) == 0) {
+			return info.tcpi_rtt / 1000000.0;
+		}
+#endif
+		return -1;
+	}
+
 }
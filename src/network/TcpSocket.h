@@ -20,7 +20,8 @@ namespace tri {
 
 		bool connect(const Endpoint &endpoint);
 		bool connect(const std::string& address, uint16_t port, bool resolve = true, bool prefereIpv4 = false);
-		bool listen(uint16_t port, bool prefereIpv4 = false);
+		//with loopbackOnly only connections from the local machine are accepted
+		bool listen(uint16_t port, bool prefereIpv4 = false, bool loopbackOnly = false);
 		Ref<TcpSocket> accept();
 		bool disconnect();
 
@@ -31,6 +32,8 @@ namespace tri {
 		bool read(void* data, int &bytes);
 
 		int getHandle();
+		//smoothed round trip time in seconds as measured by the tcp stack, -1 if not available
+		double getRoundTripTime();
 	private:
 		Endpoint endpoint;
 		bool connected;
@@ -37,34 +37,59 @@ namespace tri {
 	public:
 		int maxParticels = 10000;
 
-		void createParticle(const Transform &t, const ParticleEffect& e, EntityId source) {
-			if (env->world->getComponentStorage<Particle>()->size() >= maxParticels) {
+		void createParticles(const Transform &t, const ParticleEffect& e, EntityId source, int count) {
+			if (auto* storage = env->world->getComponentStorage<Particle>()) {
+				count = std::min(count, maxParticels - storage->size());
+			}
+			if (count <= 0) {
 				return;
 			}
 
-			EntityId id = -1;
+			//the particles are created in bulk per prefab
+			std::vector<EntityId> ids;
+			ids.reserve(count);
 			if (e.particle.size() > 0) {
-				auto& prefab = e.particle[env->random->getInt(0, e.particle.size() - 1)];
-				if (prefab) {
-					id = prefab->createEntity();
+				std::vector<int> prefabCounts(e.particle.size());
+				for (int i = 0; i < count; i++) {
+					prefabCounts[env->random->getInt(0, e.particle.size() - 1)]++;
+				}
+				for (int i = 0; i < e.particle.size(); i++) {
+					if (prefabCounts[i] > 0 && e.particle[i]) {
+						auto roots = e.particle[i]->instantiate(env->world, prefabCounts[i]);
+						ids.insert(ids.end(), roots.begin(), roots.end());
+					}
 				}
 			}
-			if (id == -1) {
-				id = env->world->addEntity(Transform(), MeshComponent(), EntityInfo("Particle"));
+			int defaultCount = count - ids.size();
+			if (defaultCount > 0) {
+				ids.resize(count);
+				EntityId* defaultIds = ids.data() + ids.size() - defaultCount;
+				env->world->addEntities(defaultIds, defaultCount);
+				env->world->addComponents(defaultIds, defaultCount, Reflection::getClassId<Transform>());
+				env->world->addComponents(defaultIds, defaultCount, Reflection::getClassId<MeshComponent>());
+				EntityInfo info("Particle");
+				env->world->addComponents(defaultIds, defaultCount, Reflection::getClassId<EntityInfo>(), &info);
 			}
+			env->world->addComponents(ids.data(), ids.size(), Reflection::getClassId<Particle>());
 
+			glm::mat4 sourceMatrix = t.getMatrix();
+			for (EntityId id : ids) {
+				initParticle(id, sourceMatrix, e, source);
+			}
+		}
+
+		void initParticle(EntityId id, const glm::mat4 &sourceMatrix, const ParticleEffect& e, EntityId source) {
 			Transform* pt = &env->world->getOrAddComponentPending<Transform>(id);
 			if (e.parrentParticles) {
 				pt->parent = source;
 				pt->position = e.positionVariance * (env->random->getVec3() * 2.0f - 1.0f);
 			}
 			else {
-				Transform t2;
 				pt->position = e.positionVariance * (env->random->getVec3() * 2.0f - 1.0f);
-				pt->decompose(t.getMatrix() * pt->calculateLocalMatrix());
+				pt->decompose(sourceMatrix * pt->calculateLocalMatrix());
 			}
 					
-			Particle& p = env->world->addComponent<Particle>(id);
+			Particle& p = *env->world->getComponentPending<Particle>(id);
 			p.faceCamera = e.faceCamera;
 			p.spawnTime = env->time->inGameTime;
 			p.lifeTime = e.lifeTime + e.lifeTime * env->random->getFloat(-1, 1) * e.lifeTimeVariance;
@@ -73,7 +98,7 @@ namespace tri {
 					
 			p.velocity = e.velocity + (env->random->getVec3() * 2.0f - 1.0f) * e.velocityVariance;
 			if (!e.parrentParticles && e.inheritScale) {
-				p.velocity = t.getMatrix() * glm::vec4(p.velocity, 0);
+				p.velocity = sourceMatrix * glm::vec4(p.velocity, 0);
 			}
 
 			glm::vec3 size = e.size + (env->random->getVec3() * 2.0f - 1.0f) * e.sizeVariance;
@@ -94,9 +119,7 @@ namespace tri {
 		void trigger(ParticleEffect& e, EntityId source = -1) {
 			if (Transform* t = env->world->getComponent<Transform>(source)) {
 				if (e.particlesPerTrigger >= 0) {
-					for (int i = 0; i < e.particlesPerTrigger; i++) {
-						createParticle(*t, e, source);
-					}
+					createParticles(*t, e, source, e.particlesPerTrigger);
 				}
 			}
 		}
@@ -119,9 +142,7 @@ namespace tri {
 				if (e.active) {
 					if (e.effect && e.effect->particlesPerSecond > 0) {
 						int count = env->time->deltaTicks(1.0f / e.effect->particlesPerSecond);
-						for (int i = 0; i < count; i++) {
-							createParticle(t, *e.effect, id);
-						}
+						createParticles(t, *e.effect, id, count);
 					}
 				}
 			});
@@ -133,13 +154,14 @@ namespace tri {
 				}
 			});
 
+			glm::vec3 cameraPosition = cameraTransform ? cameraTransform->getWorldPosition() : glm::vec3(0);
 			env->world->each<const Particle, const Transform>([&](EntityId id, const Particle& p, Transform& t) {
 				t.position += p.velocity * env->time->deltaTime;
 
 				if (p.faceCamera && cameraTransform) {
 					//todo: use a faster formular
 					Transform t2;
-					glm::mat mat = glm::lookAt(t.getWorldPosition(), cameraTransform->getWorldPosition(), {0, 0, 1});
+					glm::mat mat = glm::lookAt(t.getWorldPosition(), cameraPosition, {0, 0, 1});
 					t2.decompose(glm::rotate(glm::inverse(mat), glm::radians(-90.0f), {1, 0, 0}));
 					t.rotation = t2.rotation;
 				}
@@ -6,6 +6,7 @@
 #include "engine/RuntimeMode.h"
 #include "entity/World.h"
 #include "engine/Time.h"
+#include "engine/SpatialIndex.h"
 
 #include <glm/detail/type_quat.hpp>
 #include <glm/gtx/euler_angles.hpp>
@@ -263,6 +264,22 @@ namespace tri {
 		impl = std::make_shared<Impl>();
 		impl->init();
 
+		if (env->spatialIndex) {
+			env->spatialIndex->addBoundsProvider<Collider>([](EntityId id, glm::vec3& min, glm::vec3& max) {
+				Collider* collider = env->world->getComponent<Collider>(id);
+				if (!collider) {
+					return false;
+				}
+				glm::vec3 extent = collider->scale * 0.5f;
+				if (collider->type == Collider::SPHERE) {
+					extent = glm::vec3(collider->scale.x * 0.5f);
+				}
+				min = collider->offset - extent;
+				max = collider->offset + extent;
+				return true;
+			});
+		}
+
 		entityRemoveListener = env->eventManager->onEntityRemove.addListener([&](World* world, EntityId id) {
 			if (world->hasComponents<RigidBody, Collider, Transform>(id)) {
 				RigidBody* rb = world->getComponent<RigidBody>(id);
@@ -311,6 +328,9 @@ namespace tri {
 	}
 
 	void Physics::shutdown() {
+		if (env->spatialIndex) {
+			env->spatialIndex->removeBoundsProvider<Collider>();
+		}
 		env->eventManager->onEntityRemove.removeListener(entityRemoveListener);
 		env->eventManager->onEntityDeactivated.removeListener(entityDeactivatedListener);
 		env->eventManager->onRuntimeModeChange.removeListener(modeChangeListener);
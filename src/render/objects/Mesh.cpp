@@ -3,10 +3,12 @@
 //
 
 #include "Mesh.h"
+#include "MeshCache.h"
+#include "ObjImporter.h"
+#include "MeshOptimizer.h"
+#include "VertexFormat.h"
 #include "core/core.h"
 #include <fstream>
-#include <map>
-#include <algorithm>
 
 namespace tri {
 
@@ -16,271 +18,237 @@ namespace tri {
         boundingMin = {-0.5, -0.5, -0.5};
         boundingMax = {+0.5, +0.5, +0.5};
         changeCounter = 0;
+        vertexLayout = {{FLOAT, 3}, {FLOAT, 3}, {FLOAT, 2}};
+        indexType = UINT32;
+    }
+
+    static int computeLayout(std::vector<Attribute> &layout) {
+        int stride = 0;
+        for(auto &a : layout){
+            a.offset = stride;
+            stride += a.getByteSize();
+        }
+        return stride;
     }
 
     bool Mesh::loadActivate() {
-        create(vertexData.data(), vertexData.size(), indexData.data(), indexData.size(), {{FLOAT, 3}, {FLOAT, 3}, {FLOAT, 2}});
+        //create discards the levels of detail of the previous data
+        std::vector<Lod> levels = lods;
+        create(vertexData.data(), vertexData.size(), indexData.data(), indexData.size() / internalEnumSize(indexType), indexType, vertexLayout);
+        lods = levels;
+
+        std::vector<Attribute> layout = vertexLayout;
+        computeLayout(layout);
+        for (int i = 0; i < lodIndexData.size() && i < lods.size(); i++) {
+            auto &indices = lodIndexData[i];
+            Ref<Mesh> mesh(true);
+            Ref<Buffer> indexBuffer(true);
+            indexBuffer->init(indices.data(), indices.size(), internalEnumSize(indexType), INDEX_BUFFER, false);
+            mesh->vertexArray.addIndexBuffer(indexBuffer, indexType);
+            mesh->vertexArray.addVertexBuffer(vertexBuffer, layout);
+            mesh->boundingMin = boundingMin;
+            mesh->boundingMax = boundingMax;
+            mesh->changeCounter++;
+            lods[i].mesh = mesh;
+        }
+        lodIndexData.clear();
+
+        //the data is on the gpu now
+        if (!MeshCache::keepData) {
+            vertexData = std::vector<uint8_t>();
+            indexData = std::vector<uint8_t>();
+        }
         return true;
     }
 
     void Mesh::create(float *vertices, int vertexCount, int *indices, int indexCount, std::vector<Attribute> layout, bool keepData) {
+        create(vertices, vertexCount * sizeof(vertices[0]), indices, indexCount, UINT32, layout, keepData);
+    }
+
+    void Mesh::create(const void *vertices, int vertexDataSize, const void *indices, int indexCount, Type indexType, std::vector<Attribute> layout, bool keepData) {
         vertexArray.clear();
+        lods.clear();
 
-        Ref<Buffer> vertexBuffer(true);
+        vertexBuffer = Ref<Buffer>(true);
         Ref<Buffer> indexBuffer(true);
 
-        int stride = 0;
-        for(auto &a : layout){
-            a.offset = stride;
-            stride += a.size * a.count;
-        }
+        int stride = computeLayout(layout);
+        int indexSize = internalEnumSize(indexType);
 
-        vertexBuffer->init(vertices, vertexCount * sizeof(vertices[0]), stride, VERTEX_BUFFER, false);
-        indexBuffer->init(indices, indexCount * sizeof(indices[0]), sizeof(indices[0]), INDEX_BUFFER, false);
+        vertexBuffer->init((void*)vertices, vertexDataSize, stride, VERTEX_BUFFER, false);
+        indexBuffer->init((void*)indices, indexCount * indexSize, indexSize, INDEX_BUFFER, false);
 
-        vertexArray.addIndexBuffer(indexBuffer, UINT32);
+        vertexArray.addIndexBuffer(indexBuffer, indexType);
         vertexArray.addVertexBuffer(vertexBuffer, layout);
 
         if (keepData) {
-            vertexData.clear();
-            indexData.clear();
-            vertexData.insert(vertexData.begin(), vertices, vertices + vertexCount);
-            indexData.insert(indexData.begin(), indices, indices + indexCount);
+            vertexLayout = layout;
+            this->indexType = indexType;
+            vertexData.assign((const uint8_t*)vertices, (const uint8_t*)vertices + vertexDataSize);
+            indexData.assign((const uint8_t*)indices, (const uint8_t*)indices + indexCount * indexSize);
         }
         changeCounter++;
     }
 
-    std::vector<std::string> split(const std::string &str, char delimiter = ' '){
-        std::vector<std::string> result;
-        result.push_back("");
-        for(char c : str){
-            if(c == delimiter){
-                if(result.back() != ""){
-                    result.push_back("");
-                }
-            }else{
-                result.back() += c;
-            }
+    std::vector<float> Mesh::getAttribute(int index) {
+        int stride = 0;
+        for (auto &a : vertexLayout) {
+            stride += a.getByteSize();
         }
-        if(result.back() == ""){
-            result.pop_back();
+        int vertexCount = stride > 0 ? vertexData.size() / stride : 0;
+        std::vector<float> values(vertexCount * 4);
+        if (VertexFormat::decompress(vertexData.data(), vertexCount, vertexLayout, index, values.data()) == 0) {
+            values.clear();
         }
-        return result;
+        return values;
     }
 
-    bool Mesh::load(const std::string &file) {
-        std::ifstream stream;
-        stream.open(file);
-
-        std::vector<float> vs;
-        std::vector<float> ns;
-        std::vector<float> ts;
-        bool faceWarning = false;
-
-        struct Index{
-            int v = -1;
-            int n = -1;
-            int t = -1;
-
-            bool operator<(const Index &i) const{
-                if(v != i.v){
-                    return v < i.v;
-                }
-                if(n != i.n){
-                    return n < i.n;
-                }
-                if(t != i.t){
-                    return t < i.t;
-                }
-                return false;
-            }
-        };
-        std::vector<Index> is;
+    std::vector<glm::vec3> Mesh::getPositions() {
+        std::vector<float> values = getAttribute(0);
+        std::vector<glm::vec3> positions(values.size() / 4);
+        for (int i = 0; i < positions.size(); i++) {
+            positions[i] = { values[i * 4 + 0], values[i * 4 + 1], values[i * 4 + 2] };
+        }
+        return positions;
+    }
 
-        if(stream.is_open()){
-            std::string line;
-            while(std::getline(stream, line)){
-                std::vector<std::string> parts = split(line, ' ');
-                if (parts.size() > 0) {
-                    if (parts[0] == "v") {
-                        for (int i = 0; i < 3; i++) {
-                            if (parts.size() > i + 1) {
-                                try {
-                                    vs.push_back(std::stof(parts[i + 1]));
-                                }
-                                catch (...) {}
-                            }
-                            else {
-                                vs.push_back(0);
-                            }
-                        }
-                    }
-                    else if (parts[0] == "vn") {
-                        for (int i = 0; i < 3; i++) {
-                            if (parts.size() > i + 1) {
-                                try {
-                                    ns.push_back(std::stof(parts[i + 1]));
-                                }
-                                catch (...) {}
-                            }
-                            else {
-                                ns.push_back(0);
-                            }
-                        }
-                    }
-                    else if (parts[0] == "vt") {
-                        for (int i = 0; i < 2; i++) {
-                            if (parts.size() > i + 1) {
-                                try {
-                                    ts.push_back(std::stof(parts[i + 1]));
-                                }
-                                catch (...) {}
-                            }
-                            else {
-                                ts.push_back(0);
-                            }
-                        }
-                    }
-                    else if (parts[0] == "f") {
-                        for (int i = 1; i < parts.size(); i++) {
-                            std::vector<std::string> parts2 = split(parts[i], '/');
+    std::vector<int> Mesh::getIndices() {
+        std::vector<int> indices(indexData.size() / internalEnumSize(indexType));
+        VertexFormat::decompressIndices(indexData.data(), indices.size(), indexType, indices.data());
+        return indices;
+    }
 
-                            is.push_back({});
-                            if (parts2.size() > 0) {
-                                try {
-                                    is.back().v = std::stof(parts2[0]) - 1;
-                                }
-                                catch (...) {}
-                            }
-                            if (parts2.size() > 1) {
-                                try {
-                                    is.back().t = std::stof(parts2[1]) - 1;
-                                }
-                                catch (...) {}
-                            }
-                            else {
-                                is.back().t = is.back().v;
-                            }
-                            if (parts2.size() > 2) {
-                                try {
-                                    is.back().n = std::stof(parts2[2]) - 1;
-                                }
-                                catch (...) {}
-                            }
-                            else {
-                                is.back().n = is.back().v;
-                            }
-                        }
-                        if(parts.size() - 1 >= 4){
-                            if(!faceWarning){
-                                env->console->warning("mesh %s: only triangle faces are supported", file.c_str());
-                                faceWarning = true;
-                            }
-                        }
-                    }
-                }
+    Mesh* Mesh::selectLod(float maxError) {
+        Mesh* mesh = this;
+        for (auto &lod : lods) {
+            if (lod.error > maxError) {
+                break;
             }
-
-            if(vs.size() == 0 && is.size() == 0){
-                return false;
+            if (lod.mesh) {
+                mesh = lod.mesh.get();
             }
+        }
+        return mesh;
+    }
 
-            std::map<Index, int> map;
-
-            indexData.clear();
-            vertexData.clear();
-
-            boundingMin = {0, 0, 0};
-            boundingMax = {0, 0, 0};
-
-            for(auto &i : is){
-                auto entry = map.find(i);
-                int index = 0;
-                if(entry == map.end()){
-                    index = map.size();
-                    map[i] = index;
-
-                    if(i.v != -1 && vs.size() > i.v * 3 + 2){
-
-                        float x = vs[i.v * 3 + 0];
-                        float y = vs[i.v * 3 + 1];
-                        float z = vs[i.v * 3 + 2];
-
-                        if(index == 0){
-                            boundingMin = {x, y, z};
-                            boundingMax = {x, y, z};
-                        }
-
-                        boundingMin.x = std::min(x, boundingMin.x);
-                        boundingMin.y = std::min(y, boundingMin.y);
-                        boundingMin.z = std::min(z, boundingMin.z);
-
-                        boundingMax.x = std::max(x, boundingMax.x);
-                        boundingMax.y = std::max(y, boundingMax.y);
-                        boundingMax.z = std::max(z, boundingMax.z);
+    bool Mesh::load(const std::string &file) {
+        if (MeshCache::enabled && MeshCache::load(this, file)) {
+            env->console->trace("loaded cooked mesh %s", file.c_str());
+            return true;
+        }
+        if (!loadSource(file, MeshCache::optimizeMeshes)) {
+            return false;
+        }
+        if (MeshCache::enabled && !MeshCache::save(this, file)) {
+            env->console->debug("failed to write cooked mesh for %s", file.c_str());
+        }
+        return true;
+    }
 
-                        vertexData.push_back(x);
-                        vertexData.push_back(y);
-                        vertexData.push_back(z);
-                    }else{
-                        vertexData.push_back(0);
-                        vertexData.push_back(0);
-                        vertexData.push_back(0);
-                    }
+    bool Mesh::loadSource(const std::string &file, bool optimizeMesh) {
+        TRI_PROFILE_FUNC();
+        ObjImporter importer;
+        if (!importer.load(file)) {
+            if (!std::filesystem::exists(file)) {
+                env->console->warning("mesh: file %s not found", file.c_str());
+            }
+            return false;
+        }
+        std::vector<Attribute> layout = {{FLOAT, 3}, {FLOAT, 3}, {FLOAT, 2}};
+        int stride = 3 + 3 + 2;
 
+        lods.clear();
+        std::vector<std::vector<int>> lodIndices;
+        if (optimizeMesh) {
+            optimize(importer.vertices, importer.indices, stride, lodIndices);
+        }
 
-                    if(i.n != -1 && ns.size() > i.n * 3 + 2){
-                        vertexData.push_back(ns[i.n * 3 + 0]);
-                        vertexData.push_back(ns[i.n * 3 + 1]);
-                        vertexData.push_back(ns[i.n * 3 + 2]);
-                    }else{
-                        vertexData.push_back(0);
-                        vertexData.push_back(0);
-                        vertexData.push_back(0);
-                    }
+        int vertexCount = importer.vertices.size() / stride;
+        if (MeshCache::compressMeshes) {
+            vertexLayout = VertexFormat::compress(importer.vertices.data(), vertexCount, layout, vertexData, MeshCache::quantizePositions);
+            indexType = VertexFormat::getIndexType(vertexCount);
+        }
+        else {
+            vertexData.assign((const uint8_t*)importer.vertices.data(), (const uint8_t*)(importer.vertices.data() + importer.vertices.size()));
+            vertexLayout = layout;
+            indexType = UINT32;
+        }
+        VertexFormat::compressIndices(importer.indices.data(), importer.indices.size(), indexType, indexData);
+        lodIndexData.resize(lodIndices.size());
+        for (int i = 0; i < lodIndices.size(); i++) {
+            VertexFormat::compressIndices(lodIndices[i].data(), lodIndices[i].size(), indexType, lodIndexData[i]);
+        }
 
-                    if(i.t != -1 && ts.size() > i.t * 2 + 1){
-                        vertexData.push_back(ts[i.t * 2 + 0]);
-                        vertexData.push_back(ts[i.t * 2 + 1]);
-                    }else{
-                        vertexData.push_back(0);
-                        vertexData.push_back(0);
-                    }
+        boundingMin = importer.boundingMin;
+        boundingMax = importer.boundingMax;
+        env->console->trace("loaded mesh %s", file.c_str());
+        return true;
+    }
 
-                }else{
-                    index = entry->second;
-                }
-                indexData.push_back(index);
+    void Mesh::optimize(std::vector<float> &vertices, std::vector<int> &indices, int stride, std::vector<std::vector<int>> &lodIndices) {
+        TRI_PROFILE_FUNC();
+        if (stride < 3 || indices.size() < 3) {
+            return;
+        }
+        indices.resize(indices.size() - indices.size() % 3);
+        int vertexCount = vertices.size() / stride;
+        int indexCount = indices.size();
+
+        MeshOptimizer::optimizeVertexCache(indices.data(), indexCount, vertexCount);
+        MeshOptimizer::optimizeOverdraw(indices.data(), indexCount, vertices.data(), vertexCount, stride);
+        vertexCount = MeshOptimizer::optimizeVertexFetch(vertices.data(), vertexCount, stride, indices.data(), indexCount);
+        vertices.resize(vertexCount * stride);
+
+        //every level is simplified from the previous one, the errors are accumulated as an upper bound
+        lods.clear();
+        lodIndices.clear();
+        std::vector<int> levelIndices = indices;
+        float error = 0;
+        for (int level = 1; level <= MeshCache::lodLevels; level++) {
+            int target = (indexCount >> level) / 3 * 3;
+            float levelError = 0;
+            int count = MeshOptimizer::simplify(levelIndices.data(), levelIndices.size(), vertices.data(), vertexCount, stride, target, MeshCache::lodMaxError, &levelError);
+            //stop when locked vertices or the error limit prevent a significant reduction
+            if (count == 0 || count > levelIndices.size() * 0.9) {
+                break;
             }
-
-            env->console->trace("loaded mesh %s", file.c_str());
-            return true;
-        }else{
-            env->console->warning("mesh: file %s not found", file.c_str());
+            levelIndices.resize(count);
+            MeshOptimizer::optimizeVertexCache(levelIndices.data(), count, vertexCount);
+            error += levelError;
+
+            Lod lod;
+            lod.error = error;
+            lods.push_back(lod);
+            lodIndices.push_back(levelIndices);
         }
-        return false;
     }
 
     bool Mesh::save(const std::string& file) {
-        auto& vs = getVertexData();
-        auto& is = getIndexData();
-
         //todo: check layout
-        int stride = (3 + 3 + 2);
-        int count = vs.size() / (3 + 3 + 2);
+        std::vector<float> positions = getAttribute(0);
+        std::vector<float> normals = getAttribute(1);
+        std::vector<float> uvs = getAttribute(2);
+        std::vector<int> is = getIndices();
+        int count = positions.size() / 4;
+        if (count == 0) {
+            if (vertexData.empty() && changeCounter > 0) {
+                env->console->warning("mesh: can not save %s, the vertex data was freed after uploading, enable meshKeepData to keep it", file.c_str());
+            }
+            return false;
+        }
 
         std::ofstream stream(file);
         if (stream.is_open()) {
             for (int i = 0; i < count; i++) {
-                float* v = (float*)vs.data() + stride * i;
+                float* v = positions.data() + i * 4;
                 stream << "v " << v[0] << " " << v[1] << " " << v[2] << "\n";
             }
-            for (int i = 0; i < count; i++) {
-                float* v = (float*)vs.data() + stride * i + 6;
+            for (int i = 0; i < uvs.size() / 4; i++) {
+                float* v = uvs.data() + i * 4;
                 stream << "vt " << v[0] << " " << v[1] << "\n";
             }
-            for (int i = 0; i < count; i++) {
-                float* v = (float*)vs.data() + stride * i + 3;
+            for (int i = 0; i < normals.size() / 4; i++) {
+                float* v = normals.data() + i * 4;
                 stream << "vn " << v[0] << " " << v[1] << " " << v[2] << "\n";
             }
             for (int i = 0; i < is.size() / 3; i++) {
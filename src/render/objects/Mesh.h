@@ -13,23 +13,57 @@ namespace tri {
 
     class Mesh : public Asset {
     public:
+        //reduced level of detail, the mesh shares the vertex buffer and has its own index buffer
+        class Lod {
+        public:
+            Ref<Mesh> mesh;
+            //geometric error relative to the extent of the mesh
+            float error = 0;
+        };
+
         Mesh();
 
         bool load(const std::string &file) override;
         bool loadActivate() override;
         bool save(const std::string& file) override;
         void create(float *vertices, int vertexCount, int *indices, int indexCount, std::vector<Attribute> layout = {{FLOAT, 3}, {FLOAT, 3}, {FLOAT, 2}}, bool keepData = false);
+        //creates the mesh from vertices in any layout, the size is in bytes and the index type is UINT16 or UINT32
+        void create(const void *vertices, int vertexDataSize, const void *indices, int indexCount, Type indexType, std::vector<Attribute> layout, bool keepData = false);
 
-        const std::vector<float>& getVertexData() { return vertexData; }
-        const std::vector<int>& getIndexData() { return indexData; }
+        //the data is only kept on the cpu if requested in create or with MeshCache::keepData
+        const std::vector<uint8_t>& getVertexData() { return vertexData; }
+        const std::vector<uint8_t>& getIndexData() { return indexData; }
+        const std::vector<Attribute>& getVertexLayout() { return vertexLayout; }
+        Type getIndexType() { return indexType; }
+        //decompressed copies of the cpu data, e.g. for collision shapes
+        std::vector<glm::vec3> getPositions();
+        std::vector<int> getIndices();
+        //levels of detail ordered from fine to coarse, not including this mesh
+        const std::vector<Lod>& getLods() { return lods; }
+        //returns the coarsest level of detail with an error of at most maxError
+        Mesh* selectLod(float maxError);
 
         VertexArray vertexArray;
         glm::vec3 boundingMin;
         glm::vec3 boundingMax;
         int changeCounter;
     private:
-        std::vector<float> vertexData;
-        std::vector<int> indexData;
+        friend class MeshCache;
+        std::vector<uint8_t> vertexData;
+        std::vector<uint8_t> indexData;
+        std::vector<Attribute> vertexLayout;
+        Type indexType;
+        Ref<Buffer> vertexBuffer;
+        std::vector<Lod> lods;
+        //index data of the levels of detail until the mesh is activated
+        std::vector<std::vector<uint8_t>> lodIndexData;
+
+        //parses the source file, optionally optimizes it and compresses it if enabled in the MeshCache
+        bool loadSource(const std::string &file, bool optimizeMesh = false);
+        //optimizes the vertex and index order and generates the index data of the levels of detail
+        void optimize(std::vector<float> &vertices, std::vector<int> &indices, int stride, std::vector<std::vector<int>> &lodIndices);
+        //decompressed values of an attribute with four components per vertex
+        std::vector<float> getAttribute(int index);
     };
 
 }
@@ -0,0 +1,387 @@
+//
+// Copyright (c) 2022 Julian Hinxlage. All rights reserved.
+//
+
+#include "MeshCache.h"
+#include "Mesh.h"
+#include "core/core.h"
+#include "core/ThreadManager.h"
+#include "core/util/MappedFile.h"
+#include "core/util/Clock.h"
+#include "engine/AssetManager.h"
+#include <fstream>
+#include <atomic>
+#include <cstring>
+#include <cstdlib>
+#include <cstddef>
+
+namespace tri {
+
+    TRI_SYSTEM(MeshCache);
+
+    bool MeshCache::enabled = true;
+    std::string MeshCache::directory = ".cache/meshes";
+    bool MeshCache::optimizeMeshes = true;
+    int MeshCache::lodLevels = 3;
+    float MeshCache::lodMaxError = 0.05f;
+    bool MeshCache::compressMeshes = true;
+    bool MeshCache::quantizePositions = false;
+    bool MeshCache::keepData = false;
+
+    //increment when the layout of the cooked file changes
+    static const uint32_t cookedMeshVersion = 3;
+
+    //the header is followed by the attributes, the levels of detail, the vertex data, the index data
+    //and the index data of the levels of detail
+    class CookedMeshHeader {
+    public:
+        char magic[4];
+        uint32_t version;
+        uint64_t sourceTime;
+        uint64_t sourceSize;
+        uint64_t sourceHash;
+        float boundingMin[3];
+        float boundingMax[3];
+        uint32_t attributeCount;
+        uint32_t indexSize;
+        uint64_t vertexDataSize;
+        uint64_t indexCount;
+        uint32_t lodCount;
+        //processing options the file was cooked with
+        uint32_t options;
+        uint64_t attributeOffset;
+        uint64_t lodOffset;
+        uint64_t vertexOffset;
+        uint64_t indexOffset;
+    };
+
+    class CookedAttribute {
+    public:
+        uint32_t type;
+        uint32_t count;
+        uint32_t normalized;
+    };
+
+    class CookedLod {
+    public:
+        uint64_t indexOffset;
+        uint64_t indexCount;
+        float error;
+        uint32_t reserved;
+    };
+
+    static uint64_t getSourceTime(const std::string& file) {
+        std::error_code error;
+        auto time = std::filesystem::last_write_time(file, error);
+        return error ? 0 : time.time_since_epoch().count();
+    }
+
+    static uint64_t getSourceSize(const std::string& file) {
+        std::error_code error;
+        auto size = std::filesystem::file_size(file, error);
+        return error ? 0 : size;
+    }
+
+    static bool getSourceHash(const std::string& file, uint64_t &hash) {
+        MappedFile source;
+        if (!source.open(file)) {
+            return false;
+        }
+        hash = hashName(std::string_view((const char*)source.getData(), source.getSize()));
+        return true;
+    }
+
+    enum CookedMeshOption {
+        COOKED_OPTIMIZED = 1 << 0,
+        COOKED_COMPRESSED = 1 << 1,
+        COOKED_QUANTIZED_POSITIONS = 1 << 2,
+    };
+
+    static uint32_t getCookOptions() {
+        uint32_t options = 0;
+        options |= MeshCache::optimizeMeshes ? COOKED_OPTIMIZED : 0;
+        options |= MeshCache::compressMeshes ? COOKED_COMPRESSED : 0;
+        options |= MeshCache::compressMeshes && MeshCache::quantizePositions ? COOKED_QUANTIZED_POSITIONS : 0;
+        return options;
+    }
+
+    static uint64_t alignOffset(uint64_t offset) {
+        return (offset + 15) & ~(uint64_t)15;
+    }
+
+    //only the timestamp of the header is rewritten, the rest of the cooked file stays the same
+    static void updateSourceTime(const std::string& cookedPath, uint64_t sourceTime) {
+        std::fstream stream(cookedPath, std::ios::in | std::ios::out | std::ios::binary);
+        if (stream.is_open()) {
+            stream.seekp(offsetof(CookedMeshHeader, sourceTime));
+            stream.write((const char*)&sourceTime, sizeof(sourceTime));
+        }
+    }
+
+    //checks the header against the source file, the content is only hashed when the timestamp changed
+    //if the content is the same, the new timestamp is written to the cooked file, so that the next check does not hash again
+    static bool isValid(const CookedMeshHeader& header, const std::string& sourceFile, const std::string& cookedPath) {
+        if (memcmp(header.magic, "TMSH", 4) != 0 || header.version != cookedMeshVersion) {
+            return false;
+        }
+        //changed settings require a new cook
+        if (header.options != getCookOptions()) {
+            return false;
+        }
+        if (header.sourceSize != getSourceSize(sourceFile)) {
+            return false;
+        }
+        uint64_t sourceTime = getSourceTime(sourceFile);
+        if (header.sourceTime != sourceTime) {
+            uint64_t hash = 0;
+            if (!getSourceHash(sourceFile, hash) || hash != header.sourceHash) {
+                return false;
+            }
+            updateSourceTime(cookedPath, sourceTime);
+        }
+        return true;
+    }
+
+    void MeshCache::init() {
+        env->console->addCVar("meshCacheEnabled", &enabled);
+        env->console->addCVar<std::string>("meshCacheDirectory", &directory);
+        env->console->addCVar("meshOptimization", &optimizeMeshes);
+        env->console->addCVar("meshLodLevels", &lodLevels);
+        env->console->addCVar("meshLodMaxError", &lodMaxError);
+        env->console->addCVar("meshCompression", &compressMeshes);
+        env->console->addCVar("meshQuantizePositions", &quantizePositions);
+        env->console->addCVar("meshKeepData", &keepData);
+        env->console->addCommand("cookMeshes", [this](auto& args) {
+            bool force = args.size() > 0 && args[0] == "force";
+            Clock clock;
+            int count = cookAll(force);
+            env->console->info("cooked %i meshes in %.2f s", count, clock.elapsed());
+        });
+        env->console->addCommand("benchmarkMeshImport", [](auto& args) {
+            if (args.size() < 1) {
+                env->console->warning("usage: benchmarkMeshImport <file> [iterations]");
+                return;
+            }
+            std::string file = env->assetManager->searchFile(args[0]);
+            int iterations = args.size() > 1 ? std::max(1, std::atoi(args[1].c_str())) : 3;
+            double megabytes = (double)getSourceSize(file) / 1024.0 / 1024.0;
+
+            if (!isUpToDate(file)) {
+                Mesh mesh;
+                if (mesh.loadSource(file, optimizeMeshes)) {
+                    save(&mesh, file);
+                }
+            }
+
+            double importTime = 0;
+            double cookedTime = 0;
+            bool cooked = true;
+            for (int i = 0; i < iterations; i++) {
+                Mesh mesh;
+                Clock clock;
+                if (!mesh.loadSource(file)) {
+                    env->console->warning("failed to import mesh %s", args[0].c_str());
+                    return;
+                }
+                importTime += clock.round();
+                cooked &= load(&mesh, file);
+                cookedTime += clock.elapsed();
+            }
+            importTime /= iterations;
+            cookedTime /= iterations;
+            env->console->info("import: %.1f ms (%.1f MB/s)", importTime * 1000.0, megabytes / importTime);
+            if (cooked) {
+                env->console->info("cooked: %.1f ms", cookedTime * 1000.0);
+            }
+        });
+    }
+
+    std::string MeshCache::getCookedPath(const std::string& sourceFile) {
+        std::string path = std::filesystem::absolute(sourceFile).lexically_normal().string();
+        char hash[17];
+        snprintf(hash, sizeof(hash), "%016llx", (unsigned long long)hashName(path));
+        return directory + "/" + std::filesystem::path(sourceFile).stem().string() + "_" + hash + ".tmesh";
+    }
+
+    bool MeshCache::load(Mesh* mesh, const std::string& sourceFile) {
+        TRI_PROFILE_FUNC();
+        std::string cookedPath = getCookedPath(sourceFile);
+        MappedFile cooked;
+        if (!cooked.open(cookedPath)) {
+            return false;
+        }
+        const uint8_t* data = cooked.getData();
+        uint64_t size = cooked.getSize();
+        if (size < sizeof(CookedMeshHeader)) {
+            return false;
+        }
+        CookedMeshHeader header;
+        memcpy(&header, data, sizeof(header));
+        if (!isValid(header, sourceFile, cookedPath)) {
+            return false;
+        }
+        if (header.indexSize != sizeof(uint16_t) && header.indexSize != sizeof(uint32_t)) {
+            return false;
+        }
+        if (header.attributeOffset + header.attributeCount * sizeof(CookedAttribute) > size
+            || header.vertexOffset + header.vertexDataSize > size
+            || header.indexOffset + header.indexCount * header.indexSize > size
+            || header.lodOffset + header.lodCount * sizeof(CookedLod) > size) {
+            return false;
+        }
+
+        std::vector<Attribute> layout;
+        for (int i = 0; i < header.attributeCount; i++) {
+            CookedAttribute attribute;
+            memcpy(&attribute, data + header.attributeOffset + i * sizeof(CookedAttribute), sizeof(attribute));
+            layout.push_back(Attribute((Type)attribute.type, attribute.count, attribute.normalized));
+        }
+
+        //the data is copied straight from the mapping in the compressed format
+        const uint8_t* vertices = data + header.vertexOffset;
+        const uint8_t* indices = data + header.indexOffset;
+        mesh->vertexData.assign(vertices, vertices + header.vertexDataSize);
+        mesh->indexData.assign(indices, indices + header.indexCount * header.indexSize);
+        mesh->indexType = header.indexSize == sizeof(uint16_t) ? UINT16 : UINT32;
+        mesh->lods.clear();
+        mesh->lodIndexData.clear();
+        for (int i = 0; i < header.lodCount; i++) {
+            CookedLod cookedLod;
+            memcpy(&cookedLod, data + header.lodOffset + i * sizeof(CookedLod), sizeof(cookedLod));
+            if (cookedLod.indexOffset + cookedLod.indexCount * header.indexSize > size) {
+                return false;
+            }
+            const uint8_t* lodIndices = data + cookedLod.indexOffset;
+            Mesh::Lod lod;
+            lod.error = cookedLod.error;
+            mesh->lods.push_back(lod);
+            mesh->lodIndexData.emplace_back(lodIndices, lodIndices + cookedLod.indexCount * header.indexSize);
+        }
+        mesh->vertexLayout = layout;
+        mesh->boundingMin = { header.boundingMin[0], header.boundingMin[1], header.boundingMin[2] };
+        mesh->boundingMax = { header.boundingMax[0], header.boundingMax[1], header.boundingMax[2] };
+        return true;
+    }
+
+    bool MeshCache::save(Mesh* mesh, const std::string& sourceFile) {
+        TRI_PROFILE_FUNC();
+        CookedMeshHeader header;
+        memcpy(header.magic, "TMSH", 4);
+        header.version = cookedMeshVersion;
+        header.sourceTime = getSourceTime(sourceFile);
+        header.sourceSize = getSourceSize(sourceFile);
+        header.sourceHash = 0;
+        if (!getSourceHash(sourceFile, header.sourceHash)) {
+            return false;
+        }
+        for (int i = 0; i < 3; i++) {
+            header.boundingMin[i] = mesh->boundingMin[i];
+            header.boundingMax[i] = mesh->boundingMax[i];
+        }
+        header.attributeCount = mesh->vertexLayout.size();
+        header.indexSize = internalEnumSize(mesh->indexType);
+        header.vertexDataSize = mesh->vertexData.size();
+        header.indexCount = mesh->indexData.size() / header.indexSize;
+        header.lodCount = mesh->lodIndexData.size();
+        header.options = getCookOptions();
+        header.attributeOffset = alignOffset(sizeof(CookedMeshHeader));
+        header.lodOffset = alignOffset(header.attributeOffset + header.attributeCount * sizeof(CookedAttribute));
+        header.vertexOffset = alignOffset(header.lodOffset + header.lodCount * sizeof(CookedLod));
+        header.indexOffset = alignOffset(header.vertexOffset + header.vertexDataSize);
+
+        std::vector<CookedLod> cookedLods(header.lodCount);
+        uint64_t offset = header.indexOffset + header.indexCount * header.indexSize;
+        for (int i = 0; i < header.lodCount; i++) {
+            cookedLods[i].indexOffset = alignOffset(offset);
+            cookedLods[i].indexCount = mesh->lodIndexData[i].size() / header.indexSize;
+            cookedLods[i].error = i < mesh->lods.size() ? mesh->lods[i].error : 0;
+            cookedLods[i].reserved = 0;
+            offset = cookedLods[i].indexOffset + cookedLods[i].indexCount * header.indexSize;
+        }
+
+        std::string path = getCookedPath(sourceFile);
+        std::error_code error;
+        std::filesystem::create_directories(std::filesystem::path(path).parent_path(), error);
+
+        //written to a temporary file first, so that a partially written file is never loaded
+        std::string tmpPath = path + ".tmp" + std::to_string(std::hash<std::thread::id>()(std::this_thread::get_id()));
+        {
+            std::ofstream stream(tmpPath, std::ios::binary);
+            if (!stream.is_open()) {
+                return false;
+            }
+            static const char padding[16] = {};
+            auto pad = [&](uint64_t offset) {
+                stream.write(padding, offset - (uint64_t)stream.tellp());
+            };
+            stream.write((const char*)&header, sizeof(header));
+            pad(header.attributeOffset);
+            for (auto& a : mesh->vertexLayout) {
+                CookedAttribute attribute = { (uint32_t)a.type, (uint32_t)a.count, (uint32_t)a.normalized };
+                stream.write((const char*)&attribute, sizeof(attribute));
+            }
+            pad(header.lodOffset);
+            stream.write((const char*)cookedLods.data(), cookedLods.size() * sizeof(CookedLod));
+            pad(header.vertexOffset);
+            stream.write((const char*)mesh->vertexData.data(), header.vertexDataSize);
+            pad(header.indexOffset);
+            stream.write((const char*)mesh->indexData.data(), header.indexCount * header.indexSize);
+            for (int i = 0; i < header.lodCount; i++) {
+                pad(cookedLods[i].indexOffset);
+                stream.write((const char*)mesh->lodIndexData[i].data(), cookedLods[i].indexCount * header.indexSize);
+            }
+            if (!stream.good()) {
+                stream.close();
+                std::filesystem::remove(tmpPath, error);
+                return false;
+            }
+        }
+        std::filesystem::rename(tmpPath, path, error);
+        if (error) {
+            std::filesystem::remove(tmpPath, error);
+            return false;
+        }
+        return true;
+    }
+
+    bool MeshCache::isUpToDate(const std::string& sourceFile) {
+        std::string cookedPath = getCookedPath(sourceFile);
+        MappedFile cooked;
+        if (!cooked.open(cookedPath) || cooked.getSize() < sizeof(CookedMeshHeader)) {
+            return false;
+        }
+        CookedMeshHeader header;
+        memcpy(&header, cooked.getData(), sizeof(header));
+        return isValid(header, sourceFile, cookedPath);
+    }
+
+    int MeshCache::cookAll(bool force) {
+        std::vector<std::string> files;
+        for (auto& dir : env->assetManager->getSearchDirectories()) {
+            std::error_code error;
+            for (auto& entry : std::filesystem::recursive_directory_iterator(dir, std::filesystem::directory_options::skip_permission_denied, error)) {
+                if (entry.is_regular_file() && entry.path().extension() == ".obj") {
+                    files.push_back(entry.path().string());
+                }
+            }
+        }
+
+        std::atomic_int count = 0;
+        env->threadManager->parallelFor(files.size(), 1, [&](int begin, int end) {
+            for (int i = begin; i < end; i++) {
+                if (!force && isUpToDate(files[i])) {
+                    continue;
+                }
+                Mesh mesh;
+                if (mesh.loadSource(files[i], optimizeMeshes) && save(&mesh, files[i])) {
+                    count++;
+                }
+                else {
+                    env->console->warning("failed to cook mesh %s", files[i].c_str());
+                }
+            }
+        });
+        return count;
+    }
+
+}
@@ -0,0 +1,42 @@
+//
+// Copyright (c) 2022 Julian Hinxlage. All rights reserved.
+//
+
+#pragma once
+
+#include "pch.h"
+#include "core/System.h"
+
+namespace tri {
+
+    class Mesh;
+
+    //cache of cooked meshes in a binary format, cooked files are memory mapped instead of parsing the source file
+    //a cooked file is valid as long as the size and the timestamp or the content hash of the source file match
+    class MeshCache : public System {
+    public:
+        static bool enabled;
+        static std::string directory;
+        //vertex cache, overdraw and vertex fetch optimization with generated levels of detail
+        static bool optimizeMeshes;
+        static int lodLevels;
+        //maximum error of a level of detail relative to the extent of the mesh
+        static float lodMaxError;
+        //compact vertex formats and 16 bit indices, see VertexFormat
+        static bool compressMeshes;
+        static bool quantizePositions;
+        //keeps the vertex and index data on the cpu after the upload, required for mesh colliders
+        static bool keepData;
+
+        void init() override;
+
+        static std::string getCookedPath(const std::string& sourceFile);
+        //returns false if the cooked file is missing, invalid or stale
+        static bool load(Mesh* mesh, const std::string& sourceFile);
+        static bool save(Mesh* mesh, const std::string& sourceFile);
+        static bool isUpToDate(const std::string& sourceFile);
+        //cooks all meshes in the asset directories, returns the number of cooked meshes
+        int cookAll(bool force = false);
+    };
+
+}
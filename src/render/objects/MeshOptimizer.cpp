@@ -0,0 +1,652 @@
+//
+// Copyright (c) 2022 Julian Hinxlage. All rights reserved.
+//
+
+#include "MeshOptimizer.h"
+#include <cmath>
+#include <cstring>
+
+namespace tri {
+
+    namespace {
+
+        class Vec3 {
+        public:
+            float x = 0;
+            float y = 0;
+            float z = 0;
+
+            Vec3() {}
+            Vec3(float x, float y, float z) : x(x), y(y), z(z) {}
+            Vec3(const float *v) : x(v[0]), y(v[1]), z(v[2]) {}
+            Vec3 operator+(const Vec3 &v) const { return Vec3(x + v.x, y + v.y, z + v.z); }
+            Vec3 operator-(const Vec3 &v) const { return Vec3(x - v.x, y - v.y, z - v.z); }
+            Vec3 operator*(float s) const { return Vec3(x * s, y * s, z * s); }
+        };
+
+        float dot(const Vec3 &a, const Vec3 &b) {
+            return a.x * b.x + a.y * b.y + a.z * b.z;
+        }
+
+        Vec3 cross(const Vec3 &a, const Vec3 &b) {
+            return Vec3(a.y * b.z - a.z * b.y, a.z * b.x - a.x * b.z, a.x * b.y - a.y * b.x);
+        }
+
+        float length(const Vec3 &v) {
+            return std::sqrt(dot(v, v));
+        }
+
+        //fifo cache, a vertex is in the cache if it was added within the last cacheSize misses
+        class CacheSimulation {
+        public:
+            std::vector<uint32_t> stamps;
+            uint32_t time;
+            int cacheSize;
+
+            CacheSimulation(int vertexCount, int cacheSize) : stamps(vertexCount, 0), time(cacheSize + 1), cacheSize(cacheSize) {}
+
+            //returns the number of misses
+            int add(const int *triangle) {
+                int misses = 0;
+                for (int i = 0; i < 3; i++) {
+                    int v = triangle[i];
+                    if (time - stamps[v] > cacheSize) {
+                        stamps[v] = time++;
+                        misses++;
+                    }
+                }
+                return misses;
+            }
+
+            void clear() {
+                time += cacheSize + 1;
+            }
+        };
+
+        //Forsyth scoring parameters
+        const int forsythCacheSize = 32;
+        const int forsythMaxValence = 32;
+
+        class ForsythScores {
+        public:
+            float cache[forsythCacheSize];
+            float valence[forsythMaxValence];
+
+            ForsythScores() {
+                for (int i = 0; i < forsythCacheSize; i++) {
+                    if (i < 3) {
+                        //the vertices of the last triangle get a fixed score, so that strips are not favored over fans
+                        cache[i] = 0.75f;
+                    }
+                    else {
+                        cache[i] = std::pow(1.0f - (float)(i - 3) / (forsythCacheSize - 3), 1.5f);
+                    }
+                }
+                valence[0] = 0;
+                for (int i = 1; i < forsythMaxValence; i++) {
+                    valence[i] = 2.0f * std::pow((float)i, -0.5f);
+                }
+            }
+
+            float get(int cachePosition, int remaining) const {
+                if (remaining == 0) {
+                    return -1;
+                }
+                float score = cachePosition >= 0 ? cache[cachePosition] : 0;
+                return score + valence[std::min(remaining, forsythMaxValence - 1)];
+            }
+        };
+
+        //symmetric 4x4 error quadric of planes, weighted by the area of the triangles
+        class Quadric {
+        public:
+            double a2 = 0, b2 = 0, c2 = 0, d2 = 0;
+            double ab = 0, ac = 0, ad = 0;
+            double bc = 0, bd = 0, cd = 0;
+            double weight = 0;
+
+            void addPlane(const Vec3 &n, float d, float w) {
+                a2 += n.x * n.x * w;
+                b2 += n.y * n.y * w;
+                c2 += n.z * n.z * w;
+                d2 += d * d * w;
+                ab += n.x * n.y * w;
+                ac += n.x * n.z * w;
+                ad += n.x * d * w;
+                bc += n.y * n.z * w;
+                bd += n.y * d * w;
+                cd += n.z * d * w;
+                weight += w;
+            }
+
+            void add(const Quadric &q) {
+                a2 += q.a2;
+                b2 += q.b2;
+                c2 += q.c2;
+                d2 += q.d2;
+                ab += q.ab;
+                ac += q.ac;
+                ad += q.ad;
+                bc += q.bc;
+                bd += q.bd;
+                cd += q.cd;
+                weight += q.weight;
+            }
+
+            //squared distance to the planes, averaged by the weight
+            double error(const Vec3 &p) const {
+                double e = a2 * p.x * p.x + b2 * p.y * p.y + c2 * p.z * p.z
+                    + 2 * (ab * p.x * p.y + ac * p.x * p.z + bc * p.y * p.z)
+                    + 2 * (ad * p.x + bd * p.y + cd * p.z) + d2;
+                return std::fabs(e) / (weight > 0 ? weight : 1);
+            }
+
+            static Quadric sum(const Quadric &a, const Quadric &b) {
+                Quadric q = a;
+                q.add(b);
+                return q;
+            }
+        };
+
+        //maps every vertex to the first vertex with the same position
+        std::vector<int> generatePositionRemap(const float *vertices, int vertexCount, int stride) {
+            std::vector<int> remap(vertexCount);
+            uint32_t capacity = 16;
+            while (capacity < vertexCount * 2) {
+                capacity *= 2;
+            }
+            std::vector<int> table(capacity, -1);
+            uint32_t mask = capacity - 1;
+            for (int v = 0; v < vertexCount; v++) {
+                const float *p = vertices + v * stride;
+                uint32_t bits[3];
+                memcpy(bits, p, sizeof(bits));
+                uint32_t hash = (bits[0] * 73856093u) ^ (bits[1] * 19349663u) ^ (bits[2] * 83492791u);
+                for (uint32_t i = hash & mask;; i = (i + 1) & mask) {
+                    if (table[i] == -1) {
+                        table[i] = v;
+                        remap[v] = v;
+                        break;
+                    }
+                    if (memcmp(vertices + table[i] * stride, p, sizeof(float) * 3) == 0) {
+                        remap[v] = table[i];
+                        break;
+                    }
+                }
+            }
+            return remap;
+        }
+
+    }
+
+    void MeshOptimizer::optimizeVertexCache(int *indices, int indexCount, int vertexCount) {
+        int triangleCount = indexCount / 3;
+        if (triangleCount == 0) {
+            return;
+        }
+        static const ForsythScores scores;
+
+        //triangles of every vertex, emitted triangles are removed by swapping them to the end of the range
+        std::vector<int> offsets(vertexCount + 1, 0);
+        std::vector<int> remaining(vertexCount, 0);
+        for (int i = 0; i < triangleCount * 3; i++) {
+            remaining[indices[i]]++;
+        }
+        for (int v = 0; v < vertexCount; v++) {
+            offsets[v + 1] = offsets[v] + remaining[v];
+        }
+        std::vector<int> adjacency(offsets[vertexCount]);
+        {
+            std::vector<int> fill(offsets.begin(), offsets.end() - 1);
+            for (int i = 0; i < triangleCount * 3; i++) {
+                adjacency[fill[indices[i]]++] = i / 3;
+            }
+        }
+
+        std::vector<int> cachePosition(vertexCount, -1);
+        std::vector<float> vertexScore(vertexCount);
+        for (int v = 0; v < vertexCount; v++) {
+            vertexScore[v] = scores.get(-1, remaining[v]);
+        }
+        std::vector<float> triangleScore(triangleCount);
+        int best = 0;
+        for (int t = 0; t < triangleCount; t++) {
+            triangleScore[t] = vertexScore[indices[t * 3 + 0]] + vertexScore[indices[t * 3 + 1]] + vertexScore[indices[t * 3 + 2]];
+            if (triangleScore[t] > triangleScore[best]) {
+                best = t;
+            }
+        }
+
+        std::vector<uint8_t> emitted(triangleCount, 0);
+        std::vector<int> output;
+        output.reserve(triangleCount * 3);
+        int cache[forsythCacheSize + 3];
+        int cacheCount = 0;
+        int cursor = 0;
+
+        for (int n = 0; n < triangleCount; n++) {
+            if (best == -1) {
+                //dead end, continue with the next triangle in the input order
+                while (emitted[cursor]) {
+                    cursor++;
+                }
+                best = cursor;
+            }
+            int t = best;
+            emitted[t] = 1;
+            const int *triangle = indices + t * 3;
+            output.insert(output.end(), triangle, triangle + 3);
+
+            int newCache[forsythCacheSize + 3];
+            int newCount = 0;
+            for (int k = 0; k < 3; k++) {
+                int v = triangle[k];
+                int *begin = adjacency.data() + offsets[v];
+                for (int i = 0; i < remaining[v]; i++) {
+                    if (begin[i] == t) {
+                        std::swap(begin[i], begin[remaining[v] - 1]);
+                        remaining[v]--;
+                        break;
+                    }
+                }
+                if (std::find(newCache, newCache + newCount, v) == newCache + newCount) {
+                    newCache[newCount++] = v;
+                }
+            }
+            for (int i = 0; i < cacheCount; i++) {
+                int v = cache[i];
+                if (v != triangle[0] && v != triangle[1] && v != triangle[2]) {
+                    newCache[newCount++] = v;
+                }
+            }
+
+            for (int i = 0; i < newCount; i++) {
+                int v = newCache[i];
+                cachePosition[v] = i < forsythCacheSize ? i : -1;
+                float score = scores.get(cachePosition[v], remaining[v]);
+                float delta = score - vertexScore[v];
+                vertexScore[v] = score;
+                for (int j = 0; j < remaining[v]; j++) {
+                    triangleScore[adjacency[offsets[v] + j]] += delta;
+                }
+            }
+
+            cacheCount = std::min(newCount, forsythCacheSize);
+            best = -1;
+            float bestScore = -1;
+            for (int i = 0; i < cacheCount; i++) {
+                int v = newCache[i];
+                cache[i] = v;
+                for (int j = 0; j < remaining[v]; j++) {
+                    int candidate = adjacency[offsets[v] + j];
+                    if (triangleScore[candidate] > bestScore) {
+                        bestScore = triangleScore[candidate];
+                        best = candidate;
+                    }
+                }
+            }
+        }
+
+        memcpy(indices, output.data(), output.size() * sizeof(int));
+    }
+
+    void MeshOptimizer::optimizeOverdraw(int *indices, int indexCount, const float *vertices, int vertexCount, int stride, float threshold) {
+        int triangleCount = indexCount / 3;
+        if (triangleCount == 0) {
+            return;
+        }
+        const int cacheSize = 16;
+
+        //hard boundaries where all vertices of a triangle miss the cache, these usually start a new patch of the mesh
+        std::vector<int> clusters;
+        {
+            CacheSimulation cache(vertexCount, cacheSize);
+            for (int t = 0; t < triangleCount; t++) {
+                if (cache.add(indices + t * 3) == 3) {
+                    clusters.push_back(t);
+                }
+            }
+        }
+        if (clusters.empty() || clusters[0] != 0) {
+            clusters.insert(clusters.begin(), 0);
+        }
+
+        //soft boundaries split hard clusters further while the cache efficiency of the parts stays within the threshold
+        std::vector<int> splitClusters;
+        {
+            CacheSimulation cache(vertexCount, cacheSize);
+            for (int c = 0; c < clusters.size(); c++) {
+                int begin = clusters[c];
+                int end = c + 1 < clusters.size() ? clusters[c + 1] : triangleCount;
+
+                cache.clear();
+                int misses = 0;
+                for (int t = begin; t < end; t++) {
+                    misses += cache.add(indices + t * 3);
+                }
+                float clusterThreshold = threshold * (float)misses / (end - begin);
+
+                splitClusters.push_back(begin);
+                cache.clear();
+                misses = 0;
+                int start = begin;
+                for (int t = begin; t < end; t++) {
+                    misses += cache.add(indices + t * 3);
+                    if (t + 1 < end && (float)misses / (t - start + 1) <= clusterThreshold) {
+                        splitClusters.push_back(t + 1);
+                        cache.clear();
+                        misses = 0;
+                        start = t + 1;
+                    }
+                }
+            }
+        }
+        clusters.swap(splitClusters);
+
+        Vec3 meshCentroid;
+        for (int i = 0; i < triangleCount * 3; i++) {
+            meshCentroid = meshCentroid + Vec3(vertices + indices[i] * stride);
+        }
+        meshCentroid = meshCentroid * (1.0f / (triangleCount * 3));
+
+        //clusters facing away from the center of the mesh are drawn first
+        std::vector<float> keys(clusters.size());
+        for (int c = 0; c < clusters.size(); c++) {
+            int begin = clusters[c];
+            int end = c + 1 < clusters.size() ? clusters[c + 1] : triangleCount;
+            Vec3 centroid;
+            Vec3 normal;
+            float area = 0;
+            for (int t = begin; t < end; t++) {
+                Vec3 p0(vertices + indices[t * 3 + 0] * stride);
+                Vec3 p1(vertices + indices[t * 3 + 1] * stride);
+                Vec3 p2(vertices + indices[t * 3 + 2] * stride);
+                Vec3 n = cross(p1 - p0, p2 - p0);
+                float a = length(n);
+                centroid = centroid + (p0 + p1 + p2) * (a / 3.0f);
+                normal = normal + n;
+                area += a;
+            }
+            centroid = area > 0 ? centroid * (1.0f / area) : Vec3(vertices + indices[begin * 3] * stride);
+            float normalLength = length(normal);
+            if (normalLength > 0) {
+                normal = normal * (1.0f / normalLength);
+            }
+            keys[c] = dot(centroid - meshCentroid, normal);
+        }
+
+        std::vector<int> order(clusters.size());
+        for (int i = 0; i < order.size(); i++) {
+            order[i] = i;
+        }
+        std::stable_sort(order.begin(), order.end(), [&](int a, int b) {
+            return keys[a] > keys[b];
+        });
+
+        std::vector<int> output;
+        output.reserve(triangleCount * 3);
+        for (int c : order) {
+            int begin = clusters[c];
+            int end = c + 1 < clusters.size() ? clusters[c + 1] : triangleCount;
+            output.insert(output.end(), indices + begin * 3, indices + end * 3);
+        }
+        memcpy(indices, output.data(), output.size() * sizeof(int));
+    }
+
+    int MeshOptimizer::optimizeVertexFetch(float *vertices, int vertexCount, int stride, int *indices, int indexCount) {
+        std::vector<int> remap(vertexCount, -1);
+        int next = 0;
+        for (int i = 0; i < indexCount; i++) {
+            int &v = indices[i];
+            if (remap[v] == -1) {
+                remap[v] = next++;
+            }
+            v = remap[v];
+        }
+        std::vector<float> copy(vertices, vertices + vertexCount * stride);
+        for (int v = 0; v < vertexCount; v++) {
+            if (remap[v] != -1) {
+                memcpy(vertices + remap[v] * stride, copy.data() + v * stride, stride * sizeof(float));
+            }
+        }
+        return next;
+    }
+
+    int MeshOptimizer::simplify(int *indices, int indexCount, const float *vertices, int vertexCount, int stride,
+        int targetIndexCount, float targetError, float *resultError) {
+        if (resultError) {
+            *resultError = 0;
+        }
+        indexCount -= indexCount % 3;
+        if (indexCount <= targetIndexCount || vertexCount == 0) {
+            return indexCount;
+        }
+
+        //positions are scaled to the unit cube, so that the errors are relative to the extent of the mesh
+        Vec3 min(vertices);
+        Vec3 max(vertices);
+        for (int v = 1; v < vertexCount; v++) {
+            Vec3 p(vertices + v * stride);
+            min = Vec3(std::min(min.x, p.x), std::min(min.y, p.y), std::min(min.z, p.z));
+            max = Vec3(std::max(max.x, p.x), std::max(max.y, p.y), std::max(max.z, p.z));
+        }
+        float extent = std::max(max.x - min.x, std::max(max.y - min.y, max.z - min.z));
+        float scale = extent > 0 ? 1.0f / extent : 1.0f;
+        std::vector<Vec3> positions(vertexCount);
+        for (int v = 0; v < vertexCount; v++) {
+            positions[v] = (Vec3(vertices + v * stride) - min) * scale;
+        }
+
+        //vertices with the same position are handled as one, only the first of them is used as key
+        std::vector<int> remap = generatePositionRemap(vertices, vertexCount, stride);
+
+        //vertices on attribute seams and on borders are locked
+        std::vector<uint8_t> locked(vertexCount, 0);
+        {
+            std::vector<int> wedges(vertexCount, 0);
+            for (int v = 0; v < vertexCount; v++) {
+                wedges[remap[v]]++;
+            }
+            std::vector<uint64_t> edges;
+            edges.reserve(indexCount);
+            for (int i = 0; i < indexCount; i += 3) {
+                for (int k = 0; k < 3; k++) {
+                    uint32_t a = remap[indices[i + k]];
+                    uint32_t b = remap[indices[i + (k + 1) % 3]];
+                    edges.push_back(((uint64_t)a << 32) | b);
+                }
+            }
+            std::sort(edges.begin(), edges.end());
+            for (uint64_t edge : edges) {
+                uint32_t a = edge >> 32;
+                uint32_t b = (uint32_t)edge;
+                if (a == b) {
+                    continue;
+                }
+                uint64_t opposite = ((uint64_t)b << 32) | a;
+                if (!std::binary_search(edges.begin(), edges.end(), opposite)) {
+                    locked[a] = 1;
+                    locked[b] = 1;
+                }
+            }
+            for (int v = 0; v < vertexCount; v++) {
+                if (wedges[remap[v]] > 1) {
+                    locked[remap[v]] = 1;
+                }
+            }
+        }
+
+        std::vector<Quadric> quadrics(vertexCount);
+        for (int i = 0; i < indexCount; i += 3) {
+            int a = remap[indices[i + 0]];
+            int b = remap[indices[i + 1]];
+            int c = remap[indices[i + 2]];
+            Vec3 n = cross(positions[b] - positions[a], positions[c] - positions[a]);
+            float area = length(n);
+            if (area == 0) {
+                continue;
+            }
+            n = n * (1.0f / area);
+            float d = -dot(n, positions[a]);
+            quadrics[a].addPlane(n, d, area * 0.5f);
+            quadrics[b].addPlane(n, d, area * 0.5f);
+            quadrics[c].addPlane(n, d, area * 0.5f);
+        }
+
+        class Collapse {
+        public:
+            int from;
+            int to;
+            float cost;
+        };
+        std::vector<Collapse> collapses;
+        std::vector<int> collapseRemap(vertexCount);
+        for (int v = 0; v < vertexCount; v++) {
+            collapseRemap[v] = v;
+        }
+        std::vector<uint8_t> touched(vertexCount);
+        std::vector<int> offsets(vertexCount + 1);
+        std::vector<int> adjacency;
+        float targetCost = targetError * targetError;
+        double maxCost = 0;
+
+        while (indexCount > targetIndexCount) {
+            //triangles around every position
+            std::fill(offsets.begin(), offsets.end(), 0);
+            for (int i = 0; i < indexCount; i++) {
+                offsets[remap[indices[i]] + 1]++;
+            }
+            for (int v = 0; v < vertexCount; v++) {
+                offsets[v + 1] += offsets[v];
+            }
+            adjacency.resize(indexCount);
+            {
+                std::vector<int> fill(offsets.begin(), offsets.end() - 1);
+                for (int i = 0; i < indexCount; i++) {
+                    adjacency[fill[remap[indices[i]]]++] = i / 3;
+                }
+            }
+
+            //half edge collapses onto the other vertex of the edge
+            collapses.clear();
+            for (int i = 0; i < indexCount; i += 3) {
+                for (int k = 0; k < 3; k++) {
+                    int v0 = indices[i + k];
+                    int v1 = indices[i + (k + 1) % 3];
+                    int p0 = remap[v0];
+                    int p1 = remap[v1];
+                    //every interior edge is visited from both triangles, border edges are locked anyway
+                    if (p0 >= p1) {
+                        continue;
+                    }
+                    Quadric q = Quadric::sum(quadrics[p0], quadrics[p1]);
+                    if (!locked[p0]) {
+                        collapses.push_back({ v0, v1, (float)q.error(positions[p1]) });
+                    }
+                    if (!locked[p1]) {
+                        collapses.push_back({ v1, v0, (float)q.error(positions[p0]) });
+                    }
+                }
+            }
+            std::sort(collapses.begin(), collapses.end(), [](const Collapse &a, const Collapse &b) {
+                return a.cost < b.cost;
+            });
+
+            //collapses of one pass do not share triangles, so that the flip checks stay valid
+            std::fill(touched.begin(), touched.end(), 0);
+            int triangleGoal = (indexCount - targetIndexCount) / 3;
+            int removed = 0;
+            int collapseCount = 0;
+            for (auto &collapse : collapses) {
+                if (collapse.cost > targetCost || removed >= triangleGoal) {
+                    break;
+                }
+                int p0 = remap[collapse.from];
+                int p1 = remap[collapse.to];
+                if (touched[p0] || touched[p1]) {
+                    continue;
+                }
+
+                bool valid = true;
+                int removedTriangles = 0;
+                for (int j = offsets[p0]; j < offsets[p0 + 1] && valid; j++) {
+                    int t = adjacency[j];
+                    int a = remap[indices[t * 3 + 0]];
+                    int b = remap[indices[t * 3 + 1]];
+                    int c = remap[indices[t * 3 + 2]];
+                    if (touched[a] || touched[b] || touched[c]) {
+                        valid = false;
+                        break;
+                    }
+                    if (a == p1 || b == p1 || c == p1) {
+                        removedTriangles++;
+                        continue;
+                    }
+                    Vec3 n0 = cross(positions[b] - positions[a], positions[c] - positions[a]);
+                    Vec3 pa = a == p0 ? positions[p1] : positions[a];
+                    Vec3 pb = b == p0 ? positions[p1] : positions[b];
+                    Vec3 pc = c == p0 ? positions[p1] : positions[c];
+                    Vec3 n1 = cross(pb - pa, pc - pa);
+                    if (dot(n0, n1) <= 0.01f * length(n0) * length(n1)) {
+                        valid = false;
+                    }
+                }
+                if (!valid) {
+                    continue;
+                }
+
+                for (int j = offsets[p0]; j < offsets[p0 + 1]; j++) {
+                    int t = adjacency[j];
+                    touched[remap[indices[t * 3 + 0]]] = 1;
+                    touched[remap[indices[t * 3 + 1]]] = 1;
+                    touched[remap[indices[t * 3 + 2]]] = 1;
+                }
+                collapseRemap[collapse.from] = collapse.to;
+                quadrics[p1].add(quadrics[p0]);
+                maxCost = std::max(maxCost, (double)collapse.cost);
+                removed += removedTriangles;
+                collapseCount++;
+            }
+            if (collapseCount == 0) {
+                break;
+            }
+
+            int write = 0;
+            for (int i = 0; i < indexCount; i += 3) {
+                int a = collapseRemap[indices[i + 0]];
+                int b = collapseRemap[indices[i + 1]];
+                int c = collapseRemap[indices[i + 2]];
+                if (remap[a] == remap[b] || remap[b] == remap[c] || remap[a] == remap[c]) {
+                    continue;
+                }
+                indices[write + 0] = a;
+                indices[write + 1] = b;
+                indices[write + 2] = c;
+                write += 3;
+            }
+            indexCount = write;
+            for (int v = 0; v < vertexCount; v++) {
+                collapseRemap[v] = v;
+            }
+        }
+
+        if (resultError) {
+            *resultError = (float)std::sqrt(maxCost);
+        }
+        return indexCount;
+    }
+
+    float MeshOptimizer::calculateACMR(const int *indices, int indexCount, int vertexCount, int cacheSize) {
+        int triangleCount = indexCount / 3;
+        if (triangleCount == 0) {
+            return 0;
+        }
+        CacheSimulation cache(vertexCount, cacheSize);
+        int misses = 0;
+        for (int t = 0; t < triangleCount; t++) {
+            misses += cache.add(indices + t * 3);
+        }
+        return (float)misses / triangleCount;
+    }
+
+}
@@ -0,0 +1,35 @@
+//
+// Copyright (c) 2022 Julian Hinxlage. All rights reserved.
+//
+
+#pragma once
+
+#include "pch.h"
+
+namespace tri {
+
+    //offline processing of indexed triangle meshes, used when meshes are cooked
+    //vertices are arrays of floats with the position as the first three floats
+    class MeshOptimizer {
+    public:
+        //reorders the triangles for the post transform vertex cache (Tom Forsyth, linear speed vertex cache optimisation)
+        static void optimizeVertexCache(int *indices, int indexCount, int vertexCount);
+
+        //reorders clusters of triangles so that triangles facing outwards are drawn first, the vertex cache efficiency
+        //is kept within threshold times the efficiency of the current order, the indices should be vertex cache optimized
+        static void optimizeOverdraw(int *indices, int indexCount, const float *vertices, int vertexCount, int stride, float threshold = 1.05f);
+
+        //reorders the vertices in the order of their first use and removes unused vertices, returns the new vertex count
+        static int optimizeVertexFetch(float *vertices, int vertexCount, int stride, int *indices, int indexCount);
+
+        //quadric error edge collapse simplification, vertices on borders and attribute seams are kept
+        //stops at the target index count or when the error would exceed targetError
+        //the errors are relative to the extent of the mesh, returns the new index count
+        static int simplify(int *indices, int indexCount, const float *vertices, int vertexCount, int stride,
+            int targetIndexCount, float targetError, float *resultError = nullptr);
+
+        //average number of vertex shader invocations per triangle for a fifo cache
+        static float calculateACMR(const int *indices, int indexCount, int vertexCount, int cacheSize = 16);
+    };
+
+}
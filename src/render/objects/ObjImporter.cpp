@@ -0,0 +1,375 @@
+//
+// Copyright (c) 2022 Julian Hinxlage. All rights reserved.
+//
+
+#include "ObjImporter.h"
+#include "core/core.h"
+#include "core/util/MappedFile.h"
+#include <charconv>
+#include <cstring>
+#include <climits>
+#include <algorithm>
+
+namespace tri {
+
+    //bytes per chunk, chunks are extended to the next line break
+    static const uint64_t chunkSize = 1 << 20;
+    //index of a missing uv or normal, the position index is used instead
+    static const int samePositionIndex = INT_MIN;
+
+    static const char *skipSpaces(const char *ptr, const char *end) {
+        while (ptr < end && (*ptr == ' ' || *ptr == '\t')) {
+            ptr++;
+        }
+        return ptr;
+    }
+
+    static const char *skipToken(const char *ptr, const char *end) {
+        while (ptr < end && *ptr != ' ' && *ptr != '\t') {
+            ptr++;
+        }
+        return ptr;
+    }
+
+    //missing or invalid values are read as zero
+    static const char *parseFloat(const char *ptr, const char *end, float &value) {
+        ptr = skipSpaces(ptr, end);
+        if (ptr < end && *ptr == '+') {
+            ptr++;
+        }
+        auto result = std::from_chars(ptr, end, value);
+        if (result.ec != std::errc()) {
+            value = 0;
+            return skipToken(ptr, end);
+        }
+        return result.ptr;
+    }
+
+    static const char *parseInt(const char *ptr, const char *end, int &value) {
+        if (ptr < end && *ptr == '+') {
+            ptr++;
+        }
+        auto result = std::from_chars(ptr, end, value);
+        if (result.ec != std::errc()) {
+            value = 0;
+            return ptr;
+        }
+        return result.ptr;
+    }
+
+    //open addressing map from the indices of a corner to the index of the vertex
+    class CornerMap {
+    public:
+        class Slot {
+        public:
+            int v;
+            int t;
+            int n;
+            int index = -1;
+        };
+        std::vector<Slot> slots;
+        int count = 0;
+
+        explicit CornerMap(int expectedCount) {
+            uint32_t capacity = 16;
+            while (capacity < expectedCount * 2) {
+                capacity *= 2;
+            }
+            slots.resize(capacity);
+        }
+
+        //returns the existing index or inserts the new index
+        int insert(int v, int t, int n, int index) {
+            if ((count + 1) * 4 > slots.size() * 3) {
+                grow();
+            }
+            uint32_t mask = slots.size() - 1;
+            for (uint32_t i = hash(v, t, n) & mask;; i = (i + 1) & mask) {
+                Slot &slot = slots[i];
+                if (slot.index == -1) {
+                    slot = { v, t, n, index };
+                    count++;
+                    return index;
+                }
+                if (slot.v == v && slot.t == t && slot.n == n) {
+                    return slot.index;
+                }
+            }
+        }
+
+    private:
+        static uint32_t hash(int v, int t, int n) {
+            uint64_t h = (uint32_t)v * 0x9E3779B97F4A7C15ull;
+            h ^= (uint32_t)t * 0xC2B2AE3D27D4EB4Full;
+            h ^= (uint32_t)n * 0x165667B19E3779F9ull;
+            return (uint32_t)(h ^ (h >> 32));
+        }
+
+        void grow() {
+            std::vector<Slot> old;
+            old.swap(slots);
+            slots.resize(old.size() * 2);
+            uint32_t mask = slots.size() - 1;
+            for (auto &slot : old) {
+                if (slot.index != -1) {
+                    for (uint32_t i = hash(slot.v, slot.t, slot.n) & mask;; i = (i + 1) & mask) {
+                        if (slots[i].index == -1) {
+                            slots[i] = slot;
+                            break;
+                        }
+                    }
+                }
+            }
+        }
+    };
+
+    bool ObjImporter::load(const std::string &file) {
+        MappedFile mapping;
+        if (!mapping.open(file)) {
+            return false;
+        }
+        return parse((const char*)mapping.getData(), mapping.getSize());
+    }
+
+    bool ObjImporter::parse(const char *data, uint64_t size) {
+        vertices.clear();
+        indices.clear();
+        boundingMin = {0, 0, 0};
+        boundingMax = {0, 0, 0};
+        if (!data || size == 0) {
+            return false;
+        }
+
+        std::vector<Chunk> chunks;
+        const char *end = data + size;
+        for (const char *ptr = data; ptr < end;) {
+            const char *chunkEnd = ptr + std::min(chunkSize, (uint64_t)(end - ptr));
+            if (chunkEnd < end) {
+                const char *lineEnd = (const char*)memchr(chunkEnd, '\n', end - chunkEnd);
+                chunkEnd = lineEnd ? lineEnd + 1 : end;
+            }
+            chunks.emplace_back();
+            chunks.back().begin = ptr;
+            chunks.back().end = chunkEnd;
+            ptr = chunkEnd;
+        }
+
+        env->threadManager->parallelFor(chunks.size(), 1, [&](int begin, int end) {
+            for (int i = begin; i < end; i++) {
+                parseChunk(chunks[i]);
+            }
+        });
+
+        //negative indices are resolved with the element counts of the previous chunks
+        int positionCount = 0;
+        int normalCount = 0;
+        int uvCount = 0;
+        int cornerCount = 0;
+        bool hasPositions = false;
+        for (auto &chunk : chunks) {
+            for (int component : chunk.relativeCorners) {
+                Corner &corner = chunk.corners[component / 3];
+                if (component % 3 == 0) {
+                    corner.v += positionCount;
+                }
+                else if (component % 3 == 1) {
+                    corner.t += uvCount;
+                }
+                else {
+                    corner.n += normalCount;
+                }
+            }
+            if (!chunk.positions.empty()) {
+                if (!hasPositions) {
+                    boundingMin = chunk.boundingMin;
+                    boundingMax = chunk.boundingMax;
+                    hasPositions = true;
+                }
+                boundingMin = glm::min(boundingMin, chunk.boundingMin);
+                boundingMax = glm::max(boundingMax, chunk.boundingMax);
+            }
+            positionCount += chunk.positions.size() / 3;
+            normalCount += chunk.normals.size() / 3;
+            uvCount += chunk.uvs.size() / 2;
+            cornerCount += chunk.corners.size();
+        }
+        if (positionCount == 0 && cornerCount == 0) {
+            return false;
+        }
+
+        std::vector<float> positions;
+        std::vector<float> normals;
+        std::vector<float> uvs;
+        positions.reserve(positionCount * 3);
+        normals.reserve(normalCount * 3);
+        uvs.reserve(uvCount * 2);
+        for (auto &chunk : chunks) {
+            positions.insert(positions.end(), chunk.positions.begin(), chunk.positions.end());
+            normals.insert(normals.end(), chunk.normals.begin(), chunk.normals.end());
+            uvs.insert(uvs.end(), chunk.uvs.begin(), chunk.uvs.end());
+            chunk.positions = std::vector<float>();
+            chunk.normals = std::vector<float>();
+            chunk.uvs = std::vector<float>();
+        }
+
+        //vertices are numbered in the order of their first use
+        CornerMap map(positionCount);
+        indices.reserve(cornerCount);
+        vertices.reserve(positionCount * 8);
+        int vertexCount = 0;
+        for (auto &chunk : chunks) {
+            for (auto &corner : chunk.corners) {
+                if (corner.t == samePositionIndex) {
+                    corner.t = corner.v;
+                }
+                if (corner.n == samePositionIndex) {
+                    corner.n = corner.v;
+                }
+                int index = map.insert(corner.v, corner.t, corner.n, vertexCount);
+                if (index == vertexCount) {
+                    vertexCount++;
+                    float vertex[8] = {};
+                    if (corner.v >= 0 && corner.v < positionCount) {
+                        memcpy(vertex, &positions[corner.v * 3], sizeof(float) * 3);
+                    }
+                    if (corner.n >= 0 && corner.n < normalCount) {
+                        memcpy(vertex + 3, &normals[corner.n * 3], sizeof(float) * 3);
+                    }
+                    if (corner.t >= 0 && corner.t < uvCount) {
+                        memcpy(vertex + 6, &uvs[corner.t * 2], sizeof(float) * 2);
+                    }
+                    vertices.insert(vertices.end(), vertex, vertex + 8);
+                }
+                indices.push_back(index);
+            }
+        }
+        return true;
+    }
+
+    void ObjImporter::parseChunk(Chunk &chunk) {
+        //rough estimates to avoid most reallocations
+        uint64_t bytes = chunk.end - chunk.begin;
+        chunk.positions.reserve(bytes / 32 * 3);
+        chunk.corners.reserve(bytes / 16);
+
+        std::vector<Corner> face;
+        std::vector<uint8_t> faceRelative;
+        bool hasPositions = false;
+
+        const char *ptr = chunk.begin;
+        while (ptr < chunk.end) {
+            const char *lineEnd = (const char*)memchr(ptr, '\n', chunk.end - ptr);
+            if (!lineEnd) {
+                lineEnd = chunk.end;
+            }
+            const char *next = lineEnd + (lineEnd < chunk.end ? 1 : 0);
+            if (lineEnd > ptr && lineEnd[-1] == '\r') {
+                lineEnd--;
+            }
+            ptr = skipSpaces(ptr, lineEnd);
+
+            if (lineEnd - ptr >= 2 && ptr[0] == 'v' && (ptr[1] == ' ' || ptr[1] == '\t')) {
+                float v[3];
+                const char *p = ptr + 1;
+                for (int i = 0; i < 3; i++) {
+                    p = parseFloat(p, lineEnd, v[i]);
+                }
+                chunk.positions.insert(chunk.positions.end(), v, v + 3);
+                glm::vec3 position(v[0], v[1], v[2]);
+                if (!hasPositions) {
+                    chunk.boundingMin = position;
+                    chunk.boundingMax = position;
+                    hasPositions = true;
+                }
+                chunk.boundingMin = glm::min(chunk.boundingMin, position);
+                chunk.boundingMax = glm::max(chunk.boundingMax, position);
+            }
+            else if (lineEnd - ptr >= 3 && ptr[0] == 'v' && ptr[1] == 'n' && (ptr[2] == ' ' || ptr[2] == '\t')) {
+                float n[3];
+                const char *p = ptr + 2;
+                for (int i = 0; i < 3; i++) {
+                    p = parseFloat(p, lineEnd, n[i]);
+                }
+                chunk.normals.insert(chunk.normals.end(), n, n + 3);
+            }
+            else if (lineEnd - ptr >= 3 && ptr[0] == 'v' && ptr[1] == 't' && (ptr[2] == ' ' || ptr[2] == '\t')) {
+                float t[2];
+                const char *p = ptr + 2;
+                for (int i = 0; i < 2; i++) {
+                    p = parseFloat(p, lineEnd, t[i]);
+                }
+                chunk.uvs.insert(chunk.uvs.end(), t, t + 2);
+            }
+            else if (lineEnd - ptr >= 2 && ptr[0] == 'f' && (ptr[1] == ' ' || ptr[1] == '\t')) {
+                face.clear();
+                faceRelative.clear();
+                //a trailing comment ends the face
+                const char *faceEnd = std::find(ptr, lineEnd, '#');
+                const char *p = skipSpaces(ptr + 1, faceEnd);
+                while (p < faceEnd) {
+                    //v, v/t, v//n or v/t/n, indices start at one and negative indices are relative to the end
+                    int values[3] = {0, 0, 0};
+                    p = parseInt(p, faceEnd, values[0]);
+                    for (int i = 1; i < 3 && p < faceEnd && *p == '/'; i++) {
+                        p++;
+                        if (p < faceEnd && *p != '/') {
+                            p = parseInt(p, faceEnd, values[i]);
+                        }
+                    }
+                    p = skipSpaces(skipToken(p, faceEnd), faceEnd);
+
+                    int counts[3] = {
+                        (int)chunk.positions.size() / 3,
+                        (int)chunk.uvs.size() / 2,
+                        (int)chunk.normals.size() / 3,
+                    };
+                    int resolved[3];
+                    uint8_t relative = 0;
+                    for (int i = 0; i < 3; i++) {
+                        if (values[i] > 0) {
+                            resolved[i] = values[i] - 1;
+                        }
+                        else if (values[i] < 0) {
+                            resolved[i] = counts[i] + values[i];
+                            relative |= 1 << i;
+                        }
+                        else {
+                            resolved[i] = -1;
+                        }
+                    }
+                    //missing uv and normal indices use the position index
+                    for (int i = 1; i < 3; i++) {
+                        if (values[i] == 0) {
+                            resolved[i] = samePositionIndex;
+                        }
+                    }
+                    face.push_back({ resolved[0], resolved[1], resolved[2] });
+                    faceRelative.push_back(relative);
+                }
+
+                //triangulate as fan
+                for (int i = 2; i < face.size(); i++) {
+                    int triangle[3] = { 0, i - 1, i };
+                    for (int corner : triangle) {
+                        uint8_t relative = faceRelative[corner];
+                        if (relative) {
+                            int base = chunk.corners.size() * 3;
+                            if (relative & 1) {
+                                chunk.relativeCorners.push_back(base + 0);
+                            }
+                            if (relative & 2) {
+                                chunk.relativeCorners.push_back(base + 1);
+                            }
+                            if (relative & 4) {
+                                chunk.relativeCorners.push_back(base + 2);
+                            }
+                        }
+                        chunk.corners.push_back(face[corner]);
+                    }
+                }
+            }
+            ptr = next;
+        }
+    }
+
+}
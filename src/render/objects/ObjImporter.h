@@ -0,0 +1,50 @@
+//
+// Copyright (c) 2022 Julian Hinxlage. All rights reserved.
+//
+
+#pragma once
+
+#include "pch.h"
+#include <glm/glm.hpp>
+
+namespace tri {
+
+    //wavefront obj importer, the file is memory mapped and split into ranges of lines that are parsed in parallel
+    //faces with more than three corners are triangulated as fans
+    //the vertices are interleaved as position, normal and uv with equal corners deduplicated
+    class ObjImporter {
+    public:
+        std::vector<float> vertices;
+        std::vector<int> indices;
+        glm::vec3 boundingMin;
+        glm::vec3 boundingMax;
+
+        bool load(const std::string &file);
+        bool parse(const char *data, uint64_t size);
+
+    private:
+        class Corner {
+        public:
+            int v;
+            int t;
+            int n;
+        };
+
+        class Chunk {
+        public:
+            const char *begin;
+            const char *end;
+            std::vector<float> positions;
+            std::vector<float> normals;
+            std::vector<float> uvs;
+            std::vector<Corner> corners;
+            //components of corners with negative indices, these are relative to the start of the chunk until the offsets are known
+            std::vector<int> relativeCorners;
+            glm::vec3 boundingMin;
+            glm::vec3 boundingMax;
+        };
+
+        void parseChunk(Chunk &chunk);
+    };
+
+}
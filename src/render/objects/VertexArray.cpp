@@ -17,6 +17,13 @@ namespace tri {
         size = internalEnumSize(type);
     }
 
+    int Attribute::getByteSize() const {
+        if (type == INT_2_10_10_10_REV) {
+            return size;
+        }
+        return size * count;
+    }
+
     VertexArray::VertexArray() {
         id = 0;
         nextAttribute = 0;
@@ -79,7 +86,7 @@ namespace tri {
         int stride = 0;
         for(auto &a : layout){
             a.offset = stride;
-            stride += a.size * a.count;
+            stride += a.getByteSize();
         }
 
         for(auto &a : layout){
@@ -20,6 +20,8 @@ namespace tri {
         int offset;
 
         Attribute(Type type = FLOAT, int count = 1, bool normalized = false);
+        //size of all components in bytes, packed types store all components in one element
+        int getByteSize() const;
     };
 
     class VertexArray {
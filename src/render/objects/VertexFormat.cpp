@@ -0,0 +1,278 @@
+//
+// Copyright (c) 2022 Julian Hinxlage. All rights reserved.
+//
+
+#include "VertexFormat.h"
+#include <cmath>
+#include <cstring>
+#include <limits>
+
+namespace tri {
+
+    //half floats have a precision of at least 1/1024 for texture coordinates in this range
+    static const float maxHalfTexCoord = 2.0f;
+
+    uint16_t VertexFormat::toHalf(float value) {
+        uint32_t bits;
+        memcpy(&bits, &value, sizeof(bits));
+        uint32_t sign = (bits >> 16) & 0x8000;
+        int floatExponent = (bits >> 23) & 0xff;
+        int exponent = floatExponent - 127 + 15;
+        uint32_t mantissa = bits & 0x7fffff;
+
+        if (floatExponent == 0xff) {
+            //infinity and nan
+            return sign | 0x7c00 | (mantissa ? 0x200 : 0);
+        }
+        if (exponent >= 31) {
+            return sign | 0x7c00;
+        }
+        if (exponent <= 0) {
+            //denormalized
+            if (exponent < -10) {
+                return sign;
+            }
+            mantissa |= 0x800000;
+            int shift = 14 - exponent;
+            uint32_t half = mantissa >> shift;
+            if ((mantissa >> (shift - 1)) & 1) {
+                half++;
+            }
+            return sign | half;
+        }
+        //rounding may carry into the exponent, which is still the correct result
+        uint32_t half = sign | (exponent << 10) | (mantissa >> 13);
+        if (mantissa & 0x1000) {
+            half++;
+        }
+        return half;
+    }
+
+    float VertexFormat::fromHalf(uint16_t value) {
+        uint32_t sign = (uint32_t)(value & 0x8000) << 16;
+        int exponent = (value >> 10) & 0x1f;
+        uint32_t mantissa = value & 0x3ff;
+        if (exponent == 0) {
+            float result = std::ldexp((float)mantissa, -24);
+            return sign ? -result : result;
+        }
+        uint32_t bits;
+        if (exponent == 31) {
+            bits = sign | 0x7f800000 | (mantissa << 13);
+        }
+        else {
+            bits = sign | ((exponent + 112) << 23) | (mantissa << 13);
+        }
+        float result;
+        memcpy(&result, &bits, sizeof(result));
+        return result;
+    }
+
+    uint32_t VertexFormat::packNormal(const float *normal) {
+        uint32_t result = 0;
+        for (int i = 0; i < 3; i++) {
+            float value = std::min(std::max(normal[i], -1.0f), 1.0f);
+            int component = (int)std::lround(value * 511.0f);
+            result |= ((uint32_t)component & 0x3ff) << (i * 10);
+        }
+        return result;
+    }
+
+    std::vector<Attribute> VertexFormat::compress(const float *vertices, int vertexCount, const std::vector<Attribute> &layout,
+        std::vector<uint8_t> &output, bool quantizePositions) {
+        int stride = 0;
+        bool floats = true;
+        for (auto &a : layout) {
+            floats &= a.type == FLOAT;
+            stride += a.count;
+        }
+        if (!floats || stride == 0) {
+            output.resize(vertexCount * stride * sizeof(float));
+            memcpy(output.data(), vertices, output.size());
+            return layout;
+        }
+
+        //range of every attribute to decide if half floats are precise enough
+        std::vector<float> maxAbs(layout.size(), 0);
+        float minPosition[3] = { 0, 0, 0 };
+        float maxPosition[3] = { 0, 0, 0 };
+        for (int v = 0; v < vertexCount; v++) {
+            const float *vertex = vertices + v * stride;
+            int offset = 0;
+            for (int i = 0; i < layout.size(); i++) {
+                for (int c = 0; c < layout[i].count; c++) {
+                    maxAbs[i] = std::max(maxAbs[i], std::fabs(vertex[offset + c]));
+                }
+                offset += layout[i].count;
+            }
+            for (int c = 0; c < 3 && c < layout[0].count; c++) {
+                minPosition[c] = v == 0 ? vertex[c] : std::min(minPosition[c], vertex[c]);
+                maxPosition[c] = v == 0 ? vertex[c] : std::max(maxPosition[c], vertex[c]);
+            }
+        }
+        float extent = std::max(maxPosition[0] - minPosition[0], std::max(maxPosition[1] - minPosition[1], maxPosition[2] - minPosition[2]));
+
+        std::vector<Attribute> result;
+        for (int i = 0; i < layout.size(); i++) {
+            const Attribute &a = layout[i];
+            if (i == 0 && a.count == 3) {
+                //the error of a half float is at most maxAbs / 1024, this is acceptable if the mesh is around its origin
+                if (quantizePositions && extent > 0 && maxAbs[i] <= extent && maxAbs[i] < 65504.0f) {
+                    result.push_back(Attribute(HALF_FLOAT, 4));
+                }
+                else {
+                    result.push_back(a);
+                }
+            }
+            else if (a.count == 3) {
+                result.push_back(Attribute(INT_2_10_10_10_REV, 4, true));
+            }
+            else if (a.count == 2 && maxAbs[i] <= maxHalfTexCoord) {
+                result.push_back(Attribute(HALF_FLOAT, 2));
+            }
+            else {
+                result.push_back(a);
+            }
+        }
+
+        int byteStride = 0;
+        for (auto &a : result) {
+            a.offset = byteStride;
+            byteStride += a.getByteSize();
+        }
+        output.resize(vertexCount * byteStride);
+        for (int v = 0; v < vertexCount; v++) {
+            const float *vertex = vertices + v * stride;
+            uint8_t *target = output.data() + v * byteStride;
+            for (int i = 0; i < result.size(); i++) {
+                const Attribute &a = result[i];
+                uint8_t *element = target + a.offset;
+                if (a.type == INT_2_10_10_10_REV) {
+                    uint32_t packed = packNormal(vertex);
+                    memcpy(element, &packed, sizeof(packed));
+                }
+                else if (a.type == HALF_FLOAT) {
+                    for (int c = 0; c < a.count; c++) {
+                        uint16_t half = toHalf(c < layout[i].count ? vertex[c] : 1.0f);
+                        memcpy(element + c * sizeof(half), &half, sizeof(half));
+                    }
+                }
+                else {
+                    memcpy(element, vertex, a.count * sizeof(float));
+                }
+                vertex += layout[i].count;
+            }
+        }
+        return result;
+    }
+
+    Type VertexFormat::getIndexType(int vertexCount) {
+        return vertexCount <= 65536 ? UINT16 : UINT32;
+    }
+
+    void VertexFormat::compressIndices(const int *indices, int indexCount, Type type, std::vector<uint8_t> &output) {
+        if (type == UINT16) {
+            output.resize(indexCount * sizeof(uint16_t));
+            uint16_t *target = (uint16_t*)output.data();
+            for (int i = 0; i < indexCount; i++) {
+                target[i] = (uint16_t)indices[i];
+            }
+        }
+        else {
+            output.resize(indexCount * sizeof(int));
+            memcpy(output.data(), indices, output.size());
+        }
+    }
+
+    void VertexFormat::decompressIndices(const uint8_t *indices, int indexCount, Type type, int *output) {
+        if (type == UINT16) {
+            for (int i = 0; i < indexCount; i++) {
+                uint16_t index;
+                memcpy(&index, indices + i * sizeof(index), sizeof(index));
+                output[i] = index;
+            }
+        }
+        else {
+            memcpy(output, indices, indexCount * sizeof(int));
+        }
+    }
+
+    template<typename T>
+    static float readComponent(const uint8_t *data, int component, bool normalized) {
+        T value;
+        memcpy(&value, data + component * sizeof(T), sizeof(T));
+        if (normalized) {
+            return std::max((float)value / (float)std::numeric_limits<T>::max(), -1.0f);
+        }
+        return (float)value;
+    }
+
+    int VertexFormat::decompress(const uint8_t *vertices, int vertexCount, const std::vector<Attribute> &layout, int attributeIndex, float *output) {
+        if (attributeIndex < 0 || attributeIndex >= layout.size()) {
+            return 0;
+        }
+        int stride = 0;
+        int offset = 0;
+        for (int i = 0; i < layout.size(); i++) {
+            if (i == attributeIndex) {
+                offset = stride;
+            }
+            stride += layout[i].getByteSize();
+        }
+
+        const Attribute &a = layout[attributeIndex];
+        int count = a.type == INT_2_10_10_10_REV ? 4 : std::min(a.count, 4);
+        for (int v = 0; v < vertexCount; v++) {
+            const uint8_t *element = vertices + v * stride + offset;
+            float *target = output + v * 4;
+            for (int c = 0; c < 4; c++) {
+                target[c] = 0;
+            }
+            if (a.type == INT_2_10_10_10_REV) {
+                uint32_t packed;
+                memcpy(&packed, element, sizeof(packed));
+                for (int c = 0; c < 3; c++) {
+                    //sign extension of the 10 bit components
+                    int value = (int)(packed << (22 - c * 10)) >> 22;
+                    target[c] = a.normalized ? std::max((float)value / 511.0f, -1.0f) : (float)value;
+                }
+                int w = (int)packed >> 30;
+                target[3] = a.normalized ? std::max((float)w, -1.0f) : (float)w;
+                continue;
+            }
+            for (int c = 0; c < count; c++) {
+                switch (a.type) {
+                    case INT8:
+                        target[c] = readComponent<int8_t>(element, c, a.normalized);
+                        break;
+                    case INT16:
+                        target[c] = readComponent<int16_t>(element, c, a.normalized);
+                        break;
+                    case INT32:
+                        target[c] = readComponent<int32_t>(element, c, a.normalized);
+                        break;
+                    case UINT8:
+                        target[c] = readComponent<uint8_t>(element, c, a.normalized);
+                        break;
+                    case UINT16:
+                        target[c] = readComponent<uint16_t>(element, c, a.normalized);
+                        break;
+                    case UINT32:
+                        target[c] = readComponent<uint32_t>(element, c, a.normalized);
+                        break;
+                    case HALF_FLOAT: {
+                        uint16_t half;
+                        memcpy(&half, element + c * sizeof(half), sizeof(half));
+                        target[c] = fromHalf(half);
+                        break;
+                    }
+                    default:
+                        memcpy(&target[c], element + c * sizeof(float), sizeof(float));
+                        break;
+                }
+            }
+        }
+        return count;
+    }
+
+}
@@ -0,0 +1,36 @@
+//
+// Copyright (c) 2022 Julian Hinxlage. All rights reserved.
+//
+
+#pragma once
+
+#include "pch.h"
+#include "VertexArray.h"
+
+namespace tri {
+
+    //conversion between float vertices and compact vertex and index formats
+    class VertexFormat {
+    public:
+        static uint16_t toHalf(float value);
+        static float fromHalf(uint16_t value);
+        //signed normalized 10:10:10:2, w is zero
+        static uint32_t packNormal(const float *normal);
+
+        //compresses float vertices, the first attribute is the position, other three component attributes are normals
+        //and two component attributes are texture coordinates, returns the layout of the compressed vertices
+        //normals are packed as 10:10:10:2, texture coordinates are stored as half floats if they are within the precise range
+        //positions are only stored as half floats with quantizePositions and if the error stays small relative to the bounds
+        static std::vector<Attribute> compress(const float *vertices, int vertexCount, const std::vector<Attribute> &layout,
+            std::vector<uint8_t> &output, bool quantizePositions);
+
+        //UINT16 if all vertices can be indexed with 16 bits, UINT32 otherwise
+        static Type getIndexType(int vertexCount);
+        static void compressIndices(const int *indices, int indexCount, Type type, std::vector<uint8_t> &output);
+        static void decompressIndices(const uint8_t *indices, int indexCount, Type type, int *output);
+
+        //writes four floats per vertex for the attribute, missing components are zero, returns the number of components
+        static int decompress(const uint8_t *vertices, int vertexCount, const std::vector<Attribute> &layout, int attributeIndex, float *output);
+    };
+
+}
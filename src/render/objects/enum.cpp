@@ -23,6 +23,10 @@ namespace tri {
                 return GL_UNSIGNED_INT;
             case FLOAT:
                 return GL_FLOAT;
+            case HALF_FLOAT:
+                return GL_HALF_FLOAT;
+            case INT_2_10_10_10_REV:
+                return GL_INT_2_10_10_10_REV;
             default:
                 return GL_NONE;
         }
@@ -148,6 +152,10 @@ namespace tri {
                 return 4;
             case FLOAT:
                 return 4;
+            case HALF_FLOAT:
+                return 2;
+            case INT_2_10_10_10_REV:
+                return 4;
             default:
                 return 0;
         }
@@ -16,6 +16,9 @@ namespace tri {
         UINT16,
         UINT32,
         FLOAT,
+        HALF_FLOAT,
+        //signed 10 bit x, y, z and 2 bit w packed into 32 bits
+        INT_2_10_10_10_REV,
     };
 
     enum Primitive{
@@ -5,6 +5,7 @@
 #include "RenderBatch.h"
 #include "ShaderStructs.h"
 #include "engine/AssetManager.h"
+#include "core/FrameAllocator.h"
 
 namespace tri {
 
@@ -121,7 +122,8 @@ namespace tri {
 		dc->shaderState = Ref<ShaderState>::make();
 
 		dc->shaderState = shaderState;
-		std::vector<int> textureSlots;
+		FrameVector<int> textureSlots(env->frameAllocator->allocator<int>());
+		textureSlots.reserve(textures.elements.size());
 		for (int i = 0; i < textures.elements.size(); i++) {
 			textureSlots.push_back(i);
 		}
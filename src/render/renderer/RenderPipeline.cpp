@@ -139,8 +139,71 @@ namespace tri {
 		env->renderPipeline->addStep((Ref<RenderPipeline::Step>)step, pass, fixed);
 	}
 
+	//recycles the memory of non fixed draw call steps, which are created and destroyed every frame
+	//unlike the frame arena, the memory stays valid for as long as a step is referenced
+	template<typename T>
+	class StepPoolAllocator {
+	public:
+		typedef T value_type;
+
+		StepPoolAllocator() {}
+		template<typename U>
+		StepPoolAllocator(const StepPoolAllocator<U>&) {}
+
+		T* allocate(size_t count) {
+			if (count == 1) {
+				Pool& pool = getPool();
+				std::unique_lock<std::mutex> lock(pool.mutex);
+				if (!pool.blocks.empty()) {
+					void* block = pool.blocks.back();
+					pool.blocks.pop_back();
+					return (T*)block;
+				}
+			}
+			return (T*)::operator new(count * sizeof(T));
+		}
+
+		void deallocate(T* ptr, size_t count) {
+			if (count == 1) {
+				Pool& pool = getPool();
+				std::unique_lock<std::mutex> lock(pool.mutex);
+				if (pool.blocks.size() < maxPoolSize) {
+					pool.blocks.push_back(ptr);
+					return;
+				}
+			}
+			::operator delete(ptr);
+		}
+
+		template<typename U>
+		bool operator==(const StepPoolAllocator<U>&) const { return true; }
+		template<typename U>
+		bool operator!=(const StepPoolAllocator<U>&) const { return false; }
+
+	private:
+		static const size_t maxPoolSize = 4096;
+
+		class Pool {
+		public:
+			std::mutex mutex;
+			std::vector<void*> blocks;
+		};
+
+		static Pool& getPool() {
+			//never destroyed, steps may be released during static destruction
+			static Pool* pool = new Pool();
+			return *pool;
+		}
+	};
+
 	Ref<RenderPipeline::StepDrawCall> RenderPipeline::addDrawCallStep(RenderPass pass, bool fixed) {
-		Ref<RenderPipeline::StepDrawCall> step(true);
+		Ref<RenderPipeline::StepDrawCall> step;
+		if (fixed) {
+			step = Ref<RenderPipeline::StepDrawCall>::make();
+		}
+		else {
+			step = std::allocate_shared<RenderPipeline::StepDrawCall>(StepPoolAllocator<RenderPipeline::StepDrawCall>());
+		}
 		env->renderPipeline->addStep((Ref<RenderPipeline::Step>)step, pass, fixed);
 		return step;
 	}
@@ -13,6 +13,8 @@ namespace tri {
         env->console->addCVar("enablePointLights", &enablePointLights);
         env->console->addCVar("enableSpotLights", &enableSpotLights);
         env->console->addCVar("enableFrustumCulling", &enableFrustumCulling);
+        env->console->addCVar("enableLod", &enableLod);
+        env->console->addCVar("lodErrorThreshold", &lodErrorThreshold);
         env->console->addCVar("enableShadows", &enableShadows);
 
         env->console->addCVar("enableBloom", &enableBloom);
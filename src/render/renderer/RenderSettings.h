@@ -16,6 +16,9 @@ namespace tri {
         bool enablePointLights = true;
         bool enableSpotLights = true;
         bool enableFrustumCulling = true;
+        bool enableLod = true;
+        //allowed geometric error of a level of detail relative to the distance to the camera
+        float lodErrorThreshold = 0.002f;
 
         bool enableShadows = true;
         int shadowMapResolution = 2048;
@@ -16,6 +16,7 @@
 #include "MeshFactory.h"
 #include "engine/Random.h"
 #include "engine/EntityUtil.h"
+#include "engine/SpatialIndex.h"
 #include <GL/glew.h>
 #include <tracy/TracyOpenGL.hpp>
 #include <glm/ext/matrix_transform.hpp>
@@ -249,15 +250,19 @@ namespace tri {
         }
     }
 
-    void Renderer::submit(const glm::mat4& transform, Mesh* mesh, Material* material, Color color, EntityId id) {
+    void Renderer::submit(const glm::mat4& transform, Mesh* mesh, Material* material, Color color, EntityId id, bool cull) {
         if (!mesh) {
             mesh = quadMesh.get();
         }
 
-        if (env->renderSettings->enableFrustumCulling && !frustum.inFrustum(transform, mesh)) {
+        if (cull && env->renderSettings->enableFrustumCulling && !frustum.inFrustum(transform, mesh)) {
             return;
         }
 
+        if (env->renderSettings->enableLod && !mesh->getLods().empty()) {
+            mesh = selectLod(transform, mesh);
+        }
+
         if (!material) {
             material = defaultMaterial.get();
         }
@@ -289,6 +294,19 @@ namespace tri {
         }
     }
 
+    Mesh* Renderer::selectLod(const glm::mat4& transform, Mesh* mesh) {
+        //the error of a level is relative to the extent of the mesh, the allowed error grows with the distance to the camera
+        glm::vec3 extent = mesh->boundingMax - mesh->boundingMin;
+        glm::vec3 scale = { glm::length(transform[0]), glm::length(transform[1]), glm::length(transform[2]) };
+        float size = glm::max(extent.x * scale.x, glm::max(extent.y * scale.y, extent.z * scale.z));
+        if (size <= 0) {
+            return mesh;
+        }
+        glm::vec3 center = glm::vec3(transform * glm::vec4((mesh->boundingMin + mesh->boundingMax) * 0.5f, 1.0f));
+        float distance = glm::max(glm::length(center - eyePosition) - size * 0.5f, 0.0f);
+        return mesh->selectLod(env->renderSettings->lodErrorThreshold * distance / size);
+    }
+
     Ref<FrameBuffer> &Renderer::getGBuffer() {
         return gBuffer;
     }
@@ -343,11 +361,46 @@ namespace tri {
 
     void Renderer::submitMeshes() {
         TRI_PROFILE_FUNC();
+        bool indexed = queryVisibleEntities(frustum.viewProjectionMatrix);
         env->world->each<const Transform, const MeshComponent>([&](EntityId id, const Transform& t, const MeshComponent& m) {
+            if (indexed && isIndexed(id, t, m.mesh.get())) {
+                if (id < visibleEntities.size() && visibleEntities[id]) {
+                    submit(t.getMatrix(), m.mesh.get(), m.material.get(), m.color, id, false);
+                }
+                return;
+            }
             submit(t.getMatrix(), m.mesh.get(), m.material.get(), m.color, id);
         });
     }
 
+    bool Renderer::queryVisibleEntities(const glm::mat4& viewProjection) {
+        SpatialIndex* index = env->spatialIndex;
+        if (!index || !index->enabled || index->size() == 0 || !env->renderSettings->enableFrustumCulling) {
+            return false;
+        }
+        std::fill(visibleEntities.begin(), visibleEntities.end(), 0);
+        index->queryFrustum(viewProjection, [&](EntityId id) {
+            if (visibleEntities.size() <= id) {
+                visibleEntities.resize(id + 1, 0);
+            }
+            visibleEntities[id] = 1;
+        });
+        return true;
+    }
+
+    bool Renderer::isIndexed(EntityId id, const Transform& transform, const Mesh* mesh) {
+        //the index is updated after the tick, transforms that changed this frame are tested one by one
+        if (!env->spatialIndex->contains(id) || transform.hasChanged()) {
+            return false;
+        }
+        //a swapped or reloaded mesh has different bounds than the index, it is tested one by one until the index caught up
+        if (!env->spatialIndex->isMeshCurrent(id, mesh)) {
+            env->spatialIndex->markChanged(id);
+            return false;
+        }
+        return true;
+    }
+
     void Renderer::submitBatches(Camera &c) {
         TRI_PROFILE_FUNC();
         env->renderPipeline->addCommandStep(RenderPipeline::Command::DEPTH_ON, RenderPipeline::GEOMETRY);
@@ -1127,13 +1180,19 @@ namespace tri {
                         shadowEnvBuffer->setData(&shadowEnvData, sizeof(shadowEnvData));
                     });
 
+                    bool indexed = queryVisibleEntities(viewProjection);
                     env->world->each<const Transform, const MeshComponent>([&](EntityId id, const Transform& t, const MeshComponent& m) {
                         Mesh* mesh = m.mesh.get();
                         if (!mesh) {
                             mesh = quadMesh.get();
                         }
 
-                        if (env->renderSettings->enableFrustumCulling && !frustum.inFrustum(t.getMatrix(), mesh)) {
+                        if (indexed && isIndexed(id, t, m.mesh.get())) {
+                            if (id >= visibleEntities.size() || !visibleEntities[id]) {
+                                return;
+                            }
+                        }
+                        else if (env->renderSettings->enableFrustumCulling && !frustum.inFrustum(t.getMatrix(), mesh)) {
                             return;
                         }
 
@@ -72,6 +72,8 @@ namespace tri {
 		Ref<FrameBuffer> postProcessingBuffer;
 
 		ViewFrustum frustum;
+		//result of the last spatial index query by entity id
+		std::vector<uint8_t> visibleEntities;
 
 		std::vector<glm::vec3> ssaoSamples;
 		Ref<Texture> ssaoNoise;
@@ -108,8 +110,12 @@ namespace tri {
 		bool updateFrameBuffer(Ref<FrameBuffer>& frameBuffer, const std::vector<FrameBufferAttachmentSpec> &spec, glm::vec2 size);
 		void prepareTransparencyBuffer();
 		bool prepareLightBatches();
-		void submit(const glm::mat4& transform, Mesh* mesh, Material* material, Color color = color::white, EntityId id = -1);
+		void submit(const glm::mat4& transform, Mesh* mesh, Material* material, Color color = color::white, EntityId id = -1, bool cull = true);
 		void submitMeshes();
+		Mesh* selectLod(const glm::mat4& transform, Mesh* mesh);
+		//culls the entities of the spatial index, returns false if it is not available
+		bool queryVisibleEntities(const glm::mat4& viewProjection);
+		bool isIndexed(EntityId id, const Transform& transform, const Mesh* mesh);
 		void submitBatches(Camera& c);
 		void submitLights(const Camera &camera);
 		bool submitLight(FrameBuffer* lightBuffer, FrameBuffer* gBuffer, const AmbientLight& light, const Transform& transform, const Camera& camera);